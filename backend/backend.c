@@ -5,11 +5,15 @@
 #include <zigen-client-protocol.h>
 #include <zigen-opengl-client-protocol.h>
 #include <zigen-shell-client-protocol.h>
+#include <zmonitors-probe.h>
 #include <zmonitors-util.h>
 
 #include "ray.h"
 #include "zmonitors-backend.h"
 
+ZMS_PROBE_DEFINE(backend_dispatch);
+ZMS_PROBE_DEFINE(backend_flush);
+
 static void
 seat_capabilities(void* data, struct zgn_seat* seat, uint32_t capability)
 {
@@ -169,17 +173,38 @@ zms_backend_get_fd(struct zms_backend* backend)
 ZMS_EXPORT int
 zms_backend_dispatch(struct zms_backend* backend)
 {
-  return wl_display_dispatch(backend->display);
+  int count;
+
+  zms_trace_begin("backend_dispatch");
+  count = wl_display_dispatch(backend->display);
+  zms_trace_end("backend_dispatch");
+  ZMS_PROBE2(backend_dispatch, count, 1);
+
+  return count;
 }
 
 ZMS_EXPORT int
 zms_backend_flush(struct zms_backend* backend)
 {
-  return wl_display_flush(backend->display);
+  int size;
+
+  zms_trace_begin("backend_flush");
+  size = wl_display_flush(backend->display);
+  zms_trace_end("backend_flush");
+  ZMS_PROBE1(backend_flush, size);
+
+  return size;
 }
 
 ZMS_EXPORT int
 zms_backend_dispatch_pending(struct zms_backend* backend)
 {
-  return wl_display_dispatch_pending(backend->display);
+  int count;
+
+  zms_trace_begin("backend_dispatch");
+  count = wl_display_dispatch_pending(backend->display);
+  zms_trace_end("backend_dispatch");
+  ZMS_PROBE2(backend_dispatch, count, 0);
+
+  return count;
 }
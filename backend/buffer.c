@@ -19,13 +19,12 @@ static const struct wl_buffer_listener buffer_listener = {
 };
 
 static struct zms_buffer *
-zms_buffer_create_by_opened_fd(struct zms_backend *backend, int fd,
-    int32_t width, int32_t height, int32_t stride)
+zms_buffer_create_by_opened_fd_region(struct zms_backend *backend, int fd,
+    size_t size, int32_t offset, int32_t width, int32_t height, int32_t stride)
 {
   struct zms_buffer *buffer;
   struct wl_buffer *proxy;
   struct wl_shm_pool *pool;
-  size_t size = stride * height;
 
   buffer = zalloc(sizeof *buffer);
   if (buffer == NULL) goto err;
@@ -34,7 +33,7 @@ zms_buffer_create_by_opened_fd(struct zms_backend *backend, int fd,
   if (pool == NULL) goto err_pool;
 
   proxy = wl_shm_pool_create_buffer(
-      pool, 0, width, height, stride, WL_SHM_FORMAT_ARGB8888);
+      pool, offset, width, height, stride, WL_SHM_FORMAT_ARGB8888);
   if (proxy == NULL) goto err_proxy;
   wl_buffer_add_listener(proxy, &buffer_listener, buffer);
 
@@ -57,6 +56,14 @@ err:
   return NULL;
 }
 
+static struct zms_buffer *
+zms_buffer_create_by_opened_fd(struct zms_backend *backend, int fd,
+    int32_t width, int32_t height, int32_t stride)
+{
+  return zms_buffer_create_by_opened_fd_region(
+      backend, fd, stride * height, 0, width, height, stride);
+}
+
 ZMS_EXPORT struct zms_buffer *
 zms_buffer_create(struct zms_backend *backend, size_t size)
 {
@@ -81,6 +88,36 @@ zms_buffer_create_for_texture_by_fd(
   return zms_buffer_create_by_opened_fd(backend, dup_fd, width, height, stride);
 }
 
+ZMS_EXPORT struct zms_buffer *
+zms_buffer_create_for_texture_by_pool(struct wl_shm_pool *pool, int32_t offset,
+    int32_t width, int32_t height, int32_t stride)
+{
+  struct zms_buffer *buffer;
+  struct wl_buffer *proxy;
+
+  buffer = zalloc(sizeof *buffer);
+  if (buffer == NULL) goto err;
+
+  proxy = wl_shm_pool_create_buffer(
+      pool, offset, width, height, stride, WL_SHM_FORMAT_ARGB8888);
+  if (proxy == NULL) goto err_proxy;
+  wl_buffer_add_listener(proxy, &buffer_listener, buffer);
+
+  buffer->proxy = proxy;
+  buffer->pool = NULL;
+  buffer->size = stride * height;
+  buffer->fd = -1;
+  buffer->writable = true;
+
+  return buffer;
+
+err_proxy:
+  free(buffer);
+
+err:
+  return NULL;
+}
+
 ZMS_EXPORT struct zms_buffer *
 zms_buffer_create_for_texture(
     struct zms_backend *backend, int32_t width, int32_t height)
@@ -100,7 +137,7 @@ ZMS_EXPORT void
 zms_buffer_destroy(struct zms_buffer *buffer)
 {
   wl_buffer_destroy(buffer->proxy);
-  wl_shm_pool_destroy(buffer->pool);
-  close(buffer->fd);
+  if (buffer->pool) wl_shm_pool_destroy(buffer->pool);
+  if (buffer->fd >= 0) close(buffer->fd);
   free(buffer);
 }
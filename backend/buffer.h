@@ -8,9 +8,9 @@
 
 struct zms_buffer {
   struct wl_buffer *proxy;
-  struct wl_shm_pool *pool;
+  struct wl_shm_pool *pool; /* nullable; null if owned by someone else */
   size_t size;
-  int fd;
+  int fd;  // -1 if the pool is owned by someone else
   bool writable;
 };
 
@@ -19,6 +19,12 @@ struct zms_buffer *zms_buffer_create(struct zms_backend *backend, size_t size);
 struct zms_buffer *zms_buffer_create_for_texture_by_fd(
     struct zms_backend *backend, int fd, int32_t width, int32_t height);
 
+/* The buffer covers a part of the memory of the pool; its pool and fd are
+ * left unset, since the pool is owned by the caller. */
+struct zms_buffer *zms_buffer_create_for_texture_by_pool(
+    struct wl_shm_pool *pool, int32_t offset, int32_t width, int32_t height,
+    int32_t stride);
+
 struct zms_buffer *zms_buffer_create_for_texture(
     struct zms_backend *backend, int32_t width, int32_t height);
 
@@ -1,17 +1,21 @@
 #include "frame-callback.h"
 
 #include <zigen-client-protocol.h>
+#include <zmonitors-probe.h>
 #include <zmonitors-util.h>
 
 #include "virtual-object.h"
 #include "zmonitors-backend.h"
 
+ZMS_PROBE_DEFINE(backend_frame_done);
+
 static void
 frame_callback_done(
     void* data, struct wl_callback* callback, uint32_t callback_data)
 {
   Z_UNUSED(callback);
   struct zms_frame_callback* frame_callback = data;
+  ZMS_PROBE1(backend_frame_done, callback_data);
   frame_callback->priv->user_func(
       frame_callback->priv->user_data, callback_data);
   zms_frame_callback_destroy(frame_callback);
@@ -0,0 +1,155 @@
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "headless.h"
+
+ZMS_EXPORT struct zms_backend*
+zms_backend_create(
+    void* user_data, const struct zms_backend_interface* interface)
+{
+  struct zms_backend* backend;
+
+  backend = zalloc(sizeof *backend);
+  if (backend == NULL) {
+    zms_log("failed to allocate memory\n");
+    goto err;
+  }
+
+  backend->user_data = user_data;
+  backend->interface = interface;
+  backend->timer_fd = -1;
+  backend->dump_dir = NULL;
+  backend->frame_count = 0;
+  backend->texture_count = 0;
+  wl_list_init(&backend->cuboid_window_list);
+  wl_list_init(&backend->frame_callback_list);
+  wl_list_init(&backend->busy_texture_list);
+
+  return backend;
+
+err:
+  return NULL;
+}
+
+ZMS_EXPORT void
+zms_backend_destroy(struct zms_backend* backend)
+{
+  if (backend->timer_fd >= 0) close(backend->timer_fd);
+  free(backend->dump_dir);
+  free(backend);
+}
+
+ZMS_EXPORT bool
+zms_backend_connect(struct zms_backend* backend, const char* socket)
+{
+  Z_UNUSED(socket);
+  const char* refresh_env = getenv(ZMS_HEADLESS_REFRESH_ENV);
+  const char* dump_dir_env = getenv(ZMS_HEADLESS_DUMP_DIR_ENV);
+  long refresh = ZMS_HEADLESS_DEFAULT_REFRESH;
+  struct itimerspec interval;
+  int timer_fd;
+
+  if (refresh_env) {
+    char* end;
+    refresh = strtol(refresh_env, &end, 10);
+    if (*end != '\0' || refresh < 1 || refresh > 1000) {
+      zms_log("invalid %s: %s\n", ZMS_HEADLESS_REFRESH_ENV, refresh_env);
+      goto err;
+    }
+  }
+
+  timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+  if (timer_fd < 0) {
+    zms_log("failed to create a timer: %s\n", strerror(errno));
+    goto err;
+  }
+
+  // a whole second at 1 Hz is out of range for tv_nsec
+  interval.it_interval.tv_sec = 1 / refresh;
+  interval.it_interval.tv_nsec = 1000000000 / refresh % 1000000000;
+  interval.it_value = interval.it_interval;
+  if (timerfd_settime(timer_fd, 0, &interval, NULL) < 0) {
+    zms_log("failed to start a timer: %s\n", strerror(errno));
+    goto err_settime;
+  }
+
+  if (dump_dir_env && dump_dir_env[0] != '\0') {
+    backend->dump_dir = strdup(dump_dir_env);
+    if (backend->dump_dir == NULL) goto err_settime;
+  }
+
+  backend->timer_fd = timer_fd;
+
+  zms_log("headless backend: %ld Hz%s%s\n", refresh,
+      backend->dump_dir ? ", dumping textures to " : "",
+      backend->dump_dir ? backend->dump_dir : "");
+
+  return true;
+
+err_settime:
+  close(timer_fd);
+
+err:
+  return false;
+}
+
+ZMS_EXPORT int
+zms_backend_get_fd(struct zms_backend* backend)
+{
+  return backend->timer_fd;
+}
+
+static uint32_t
+zms_headless_get_time(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  return now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+/* What zigen does in a frame, in the order a client observes it */
+static void
+zms_headless_frame(struct zms_backend* backend)
+{
+  backend->frame_count++;
+  zms_headless_texture_release_all(backend);
+  zms_headless_cuboid_window_configure_all(backend);
+  zms_headless_frame_callback_done_all(backend, zms_headless_get_time());
+}
+
+ZMS_EXPORT int
+zms_backend_dispatch(struct zms_backend* backend)
+{
+  uint64_t expirations;
+
+  if (read(backend->timer_fd, &expirations, sizeof expirations) < 0) {
+    if (errno == EAGAIN) return 0;
+    zms_log("failed to read a timer: %s\n", strerror(errno));
+    return -1;
+  }
+
+  // frames missed while the main loop was busy are skipped
+  zms_headless_frame(backend);
+
+  return 1;
+}
+
+ZMS_EXPORT int
+zms_backend_flush(struct zms_backend* backend)
+{
+  Z_UNUSED(backend);
+  return 0;
+}
+
+ZMS_EXPORT int
+zms_backend_dispatch_pending(struct zms_backend* backend)
+{
+  Z_UNUSED(backend);
+  return 0;
+}
@@ -0,0 +1,120 @@
+#include "headless.h"
+
+static struct zms_virtual_object*
+zms_virtual_object_create(struct zms_backend* backend)
+{
+  struct zms_virtual_object* virtual_object;
+
+  virtual_object = zalloc(sizeof *virtual_object);
+  if (virtual_object == NULL) return NULL;
+
+  virtual_object->backend = backend;
+  zms_signal_init(&virtual_object->destroy_signal);
+
+  return virtual_object;
+}
+
+static void
+zms_virtual_object_destroy(struct zms_virtual_object* virtual_object)
+{
+  zms_signal_emit(&virtual_object->destroy_signal, NULL);
+  free(virtual_object);
+}
+
+ZMS_EXPORT struct zms_cuboid_window*
+zms_cuboid_window_create(void* user_data,
+    const struct zms_cuboid_window_interface* interface,
+    struct zms_backend* backend, vec3 half_size, versor quaternion)
+{
+  struct zms_cuboid_window* cuboid_window;
+  struct zms_cuboid_window_private* priv;
+  struct zms_virtual_object* virtual_object;
+
+  cuboid_window = zalloc(sizeof *cuboid_window);
+  if (cuboid_window == NULL) goto err;
+
+  priv = zalloc(sizeof *priv);
+  if (priv == NULL) goto err_priv;
+
+  virtual_object = zms_virtual_object_create(backend);
+  if (virtual_object == NULL) goto err_virtual_object;
+
+  priv->pub = cuboid_window;
+  priv->user_data = user_data;
+  priv->interface = interface;
+  glm_vec3_copy(half_size, priv->half_size);
+  glm_quat_copy(quaternion, priv->quaternion);
+  // the size is granted as requested on the next frame
+  priv->configure_pending = true;
+  wl_list_insert(&backend->cuboid_window_list, &priv->link);
+
+  cuboid_window->priv = priv;
+  cuboid_window->backend = backend;
+  cuboid_window->virtual_object = virtual_object;
+
+  glm_vec3_zero(cuboid_window->half_size);
+  glm_quat_identity(cuboid_window->quaternion);
+
+  cuboid_window->configured = NULL;
+
+  return cuboid_window;
+
+err_virtual_object:
+  free(priv);
+
+err_priv:
+  free(cuboid_window);
+
+err:
+  return NULL;
+}
+
+ZMS_EXPORT void
+zms_cuboid_window_destroy(struct zms_cuboid_window* cuboid_window)
+{
+  wl_list_remove(&cuboid_window->priv->link);
+  zms_virtual_object_destroy(cuboid_window->virtual_object);
+  free(cuboid_window->priv);
+  free(cuboid_window);
+}
+
+ZMS_EXPORT void
+zms_cuboid_window_commit(struct zms_cuboid_window* cuboid_window)
+{
+  Z_UNUSED(cuboid_window);
+}
+
+ZMS_EXPORT void
+zms_cuboid_window_move(struct zms_cuboid_window* cuboid_window, uint32_t serial)
+{
+  // nowhere to move to without a seat
+  Z_UNUSED(cuboid_window);
+  Z_UNUSED(serial);
+}
+
+ZMS_EXPORT void
+zms_cuboid_window_rotate(
+    struct zms_cuboid_window* cuboid_window, versor quaternion)
+{
+  glm_quat_copy(quaternion, cuboid_window->priv->quaternion);
+  cuboid_window->priv->configure_pending = true;
+}
+
+ZMS_EXPORT void
+zms_headless_cuboid_window_configure_all(struct zms_backend* backend)
+{
+  struct zms_cuboid_window_private *priv, *tmp;
+
+  wl_list_for_each_safe(priv, tmp, &backend->cuboid_window_list, link)
+  {
+    struct zms_cuboid_window* cuboid_window = priv->pub;
+    if (priv->configure_pending == false) continue;
+
+    priv->configure_pending = false;
+    glm_vec3_copy(priv->half_size, cuboid_window->half_size);
+    glm_quat_copy(priv->quaternion, cuboid_window->quaternion);
+
+    if (cuboid_window->configured)
+      cuboid_window->configured(priv->user_data, cuboid_window);
+  }
+}
@@ -0,0 +1,79 @@
+#include "headless.h"
+
+static void
+virtual_object_destroy_handler(struct zms_listener* listener, void* data)
+{
+  Z_UNUSED(data);
+  struct zms_frame_callback_private* frame_callback_priv;
+
+  frame_callback_priv = wl_container_of(
+      listener, frame_callback_priv, virtual_object_destroy_listener);
+
+  zms_frame_callback_destroy(frame_callback_priv->pub);
+}
+
+ZMS_EXPORT struct zms_frame_callback*
+zms_frame_callback_create(struct zms_virtual_object* virtual_object, void* data,
+    zms_frame_callback_func_t callback_func)
+{
+  struct zms_frame_callback* frame_callback;
+  struct zms_frame_callback_private* priv;
+  struct zms_backend* backend = virtual_object->backend;
+
+  frame_callback = zalloc(sizeof *frame_callback);
+  if (frame_callback == NULL) goto err;
+
+  priv = zalloc(sizeof *priv);
+  if (priv == NULL) goto err_priv;
+
+  priv->pub = frame_callback;
+  priv->user_data = data;
+  priv->user_func = callback_func;
+  priv->backend = backend;
+  priv->virtual_object_destroy_listener.notify = virtual_object_destroy_handler;
+  zms_signal_add(
+      &virtual_object->destroy_signal, &priv->virtual_object_destroy_listener);
+  wl_list_insert(backend->frame_callback_list.prev, &priv->link);
+  frame_callback->priv = priv;
+  wl_list_init(&frame_callback->link);
+
+  return frame_callback;
+
+err_priv:
+  free(frame_callback);
+
+err:
+  return NULL;
+}
+
+ZMS_EXPORT void
+zms_frame_callback_destroy(struct zms_frame_callback* frame_callback)
+{
+  wl_list_remove(&frame_callback->link);
+  wl_list_remove(&frame_callback->priv->virtual_object_destroy_listener.link);
+  wl_list_remove(&frame_callback->priv->link);
+  free(frame_callback->priv);
+  free(frame_callback);
+}
+
+ZMS_EXPORT void
+zms_headless_frame_callback_done_all(
+    struct zms_backend* backend, uint32_t time)
+{
+  struct zms_frame_callback_private* priv;
+  struct wl_list done_list;
+
+  // callbacks requested from the handlers are done on the next frame
+  wl_list_init(&done_list);
+  wl_list_insert_list(&done_list, &backend->frame_callback_list);
+  wl_list_init(&backend->frame_callback_list);
+
+  // a handler may destroy other callbacks in the list
+  while (!wl_list_empty(&done_list)) {
+    priv = wl_container_of(done_list.next, priv, link);
+    wl_list_remove(&priv->link);
+    wl_list_init(&priv->link);
+    priv->user_func(priv->user_data, time);
+    zms_frame_callback_destroy(priv->pub);
+  }
+}
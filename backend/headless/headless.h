@@ -0,0 +1,100 @@
+#ifndef ZMONITORS_BACKEND_HEADLESS_HEADLESS_H
+#define ZMONITORS_BACKEND_HEADLESS_HEADLESS_H
+
+#include <zmonitors-backend.h>
+#include <zmonitors-util.h>
+
+/* An implementation of zmonitors-backend.h that needs no zigen compositor.
+ * Frame callbacks are fired by a timer, and textures are plain memfd
+ * buffers which are released on the frame after they were updated. */
+
+// environment variables read by zms_backend_connect
+#define ZMS_HEADLESS_REFRESH_ENV "ZMONITORS_HEADLESS_REFRESH"    // in Hz
+#define ZMS_HEADLESS_DUMP_DIR_ENV "ZMONITORS_HEADLESS_DUMP_DIR"  // nullable
+
+#define ZMS_HEADLESS_DEFAULT_REFRESH 60
+
+struct zms_backend {
+  void* user_data;
+  const struct zms_backend_interface* interface; /* nonnull */
+
+  int timer_fd;    // -1 until connected
+  char* dump_dir;  // updated textures are written here as PPM; nullable
+  uint32_t frame_count;
+  uint32_t texture_count;
+
+  struct wl_list cuboid_window_list;   // -> zms_cuboid_window_private.link
+  struct wl_list frame_callback_list;  // -> zms_frame_callback_private.link
+  struct wl_list busy_texture_list;    // -> zms_opengl_texture.link
+};
+
+struct zms_virtual_object {
+  struct zms_backend* backend;
+  struct zms_signal destroy_signal;
+};
+
+struct zms_cuboid_window_private {
+  struct zms_cuboid_window* pub;
+  void* user_data;
+  const struct zms_cuboid_window_interface* interface;
+
+  vec3 half_size;
+  versor quaternion;
+  bool configure_pending;
+
+  struct wl_list link;
+};
+
+struct zms_frame_callback_private {
+  struct zms_frame_callback* pub;
+  void* user_data;
+  zms_frame_callback_func_t user_func;
+  struct zms_backend* backend;
+  struct zms_listener virtual_object_destroy_listener;
+
+  struct wl_list link;
+};
+
+struct zms_opengl_shader_program {
+  struct zms_backend* backend;
+};
+
+struct zms_opengl_vertex_buffer {
+  int fd;
+  size_t size;
+};
+
+struct zms_opengl_texture_pool {
+  struct zms_backend* backend;
+  int fd;
+  size_t fd_size;
+};
+
+struct zms_opengl_texture {
+  struct zms_backend* backend;
+  uint32_t id;  // unique in the backend, for dumped file names
+
+  int fd;
+  size_t fd_size;
+  int32_t offset;
+  uint32_t stride;
+  struct zms_screen_size size;
+
+  // updated and not released yet
+  bool busy;
+  struct wl_list link;
+};
+
+struct zms_opengl_component_private {
+  struct zms_opengl_texture* texture; /* nullable */
+};
+
+/* Called on every frame of the backend */
+void zms_headless_cuboid_window_configure_all(struct zms_backend* backend);
+
+void zms_headless_frame_callback_done_all(
+    struct zms_backend* backend, uint32_t time);
+
+void zms_headless_texture_release_all(struct zms_backend* backend);
+
+#endif  //  ZMONITORS_BACKEND_HEADLESS_HEADLESS_H
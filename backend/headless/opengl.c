@@ -0,0 +1,386 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "headless.h"
+
+/* opengl shader */
+
+ZMS_EXPORT struct zms_opengl_shader_program*
+zms_opengl_shader_program_create(struct zms_backend* backend,
+    const char* vertex_shader, size_t vertex_shader_size,
+    const char* fragment_shader, size_t fragment_shader_size)
+{
+  Z_UNUSED(vertex_shader);
+  Z_UNUSED(vertex_shader_size);
+  Z_UNUSED(fragment_shader);
+  Z_UNUSED(fragment_shader_size);
+  struct zms_opengl_shader_program* program;
+
+  program = zalloc(sizeof *program);
+  if (program == NULL) return NULL;
+
+  program->backend = backend;
+
+  return program;
+}
+
+ZMS_EXPORT void
+zms_opengl_shader_program_destroy(struct zms_opengl_shader_program* program)
+{
+  free(program);
+}
+
+ZMS_EXPORT void
+zms_opengl_shader_program_set_uniform_variable_mat4(
+    struct zms_opengl_shader_program* program, const char* location, mat4 mat)
+{
+  Z_UNUSED(program);
+  Z_UNUSED(location);
+  Z_UNUSED(mat);
+}
+
+ZMS_EXPORT void
+zms_opengl_shader_program_set_uniform_variable_vec3(
+    struct zms_opengl_shader_program* program, const char* location, vec3 vec)
+{
+  Z_UNUSED(program);
+  Z_UNUSED(location);
+  Z_UNUSED(vec);
+}
+
+/* opengl vertex buffer */
+
+ZMS_EXPORT struct zms_opengl_vertex_buffer*
+zms_opengl_vertex_buffer_create(struct zms_backend* backend, size_t size)
+{
+  Z_UNUSED(backend);
+  struct zms_opengl_vertex_buffer* vertex_buffer;
+  int fd;
+
+  vertex_buffer = zalloc(sizeof *vertex_buffer);
+  if (vertex_buffer == NULL) goto err;
+
+  fd = zms_util_create_shared_fd(size, "zmonitors-headless-buffer");
+  if (fd < 0) goto err_fd;
+
+  vertex_buffer->fd = fd;
+  vertex_buffer->size = size;
+
+  return vertex_buffer;
+
+err_fd:
+  free(vertex_buffer);
+
+err:
+  return NULL;
+}
+
+ZMS_EXPORT void
+zms_opengl_vertex_buffer_destroy(struct zms_opengl_vertex_buffer* vertex_buffer)
+{
+  close(vertex_buffer->fd);
+  free(vertex_buffer);
+}
+
+ZMS_EXPORT int
+zms_opengl_vertex_buffer_get_fd(struct zms_opengl_vertex_buffer* vertex_buffer)
+{
+  return vertex_buffer->fd;
+}
+
+/* opengl texture pool */
+
+ZMS_EXPORT struct zms_opengl_texture_pool*
+zms_opengl_texture_pool_create(
+    struct zms_backend* backend, int fd, size_t fd_size)
+{
+  struct zms_opengl_texture_pool* pool;
+
+  pool = zalloc(sizeof *pool);
+  if (pool == NULL) goto err;
+
+  pool->fd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+  if (pool->fd < 0) goto err_fd;
+
+  pool->backend = backend;
+  pool->fd_size = fd_size;
+
+  return pool;
+
+err_fd:
+  free(pool);
+
+err:
+  return NULL;
+}
+
+ZMS_EXPORT void
+zms_opengl_texture_pool_destroy(struct zms_opengl_texture_pool* pool)
+{
+  close(pool->fd);
+  free(pool);
+}
+
+/* opengl texture */
+
+/* Takes the ownership of fd */
+static struct zms_opengl_texture*
+zms_opengl_texture_create_by_opened_fd_region(struct zms_backend* backend,
+    int fd, size_t fd_size, int32_t offset, uint32_t stride,
+    struct zms_screen_size size)
+{
+  struct zms_opengl_texture* texture;
+
+  texture = zalloc(sizeof *texture);
+  if (texture == NULL) {
+    close(fd);
+    return NULL;
+  }
+
+  texture->backend = backend;
+  texture->id = backend->texture_count++;
+  texture->fd = fd;
+  texture->fd_size = fd_size;
+  texture->offset = offset;
+  texture->stride = stride;
+  texture->size = size;
+  texture->busy = false;
+  wl_list_init(&texture->link);
+
+  return texture;
+}
+
+ZMS_EXPORT struct zms_opengl_texture*
+zms_opengl_texture_create_by_fd(
+    struct zms_backend* backend, int fd, struct zms_screen_size size)
+{
+  uint32_t stride = size.width * sizeof(struct zms_bgra);
+  size_t fd_size = stride * size.height;
+  int texture_fd;
+
+  if (fd < 0) {
+    texture_fd =
+        zms_util_create_shared_fd(fd_size, "zmonitors-headless-buffer");
+  } else {
+    texture_fd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+  }
+  if (texture_fd < 0) return NULL;
+
+  return zms_opengl_texture_create_by_opened_fd_region(
+      backend, texture_fd, fd_size, 0, stride, size);
+}
+
+ZMS_EXPORT struct zms_opengl_texture*
+zms_opengl_texture_create_by_pool(struct zms_opengl_texture_pool* pool,
+    int32_t offset, uint32_t stride, struct zms_screen_size size)
+{
+  int texture_fd;
+
+  // a texture may outlive the pool
+  texture_fd = fcntl(pool->fd, F_DUPFD_CLOEXEC, 0);
+  if (texture_fd < 0) return NULL;
+
+  return zms_opengl_texture_create_by_opened_fd_region(
+      pool->backend, texture_fd, pool->fd_size, offset, stride, size);
+}
+
+ZMS_EXPORT void
+zms_opengl_texture_destroy(struct zms_opengl_texture* texture)
+{
+  wl_list_remove(&texture->link);
+  close(texture->fd);
+  free(texture);
+}
+
+ZMS_EXPORT int
+zms_opengl_texture_get_fd(struct zms_opengl_texture* texture)
+{
+  return texture->fd;
+}
+
+ZMS_EXPORT bool
+zms_opengl_texture_is_busy(struct zms_opengl_texture* texture)
+{
+  return texture->busy;
+}
+
+/* Write the texture as a binary PPM named after the frame and the texture */
+static void
+zms_opengl_texture_dump(struct zms_opengl_texture* texture)
+{
+  struct zms_backend* backend = texture->backend;
+  struct zms_screen_size size = texture->size;
+  size_t row_size = sizeof(struct zms_bgra) * size.width;
+  struct zms_bgra* row;
+  uint8_t* rgb;
+  char path[PATH_MAX];
+  FILE* file;
+
+  snprintf(path, sizeof path, "%s/%08u-%u.ppm", backend->dump_dir,
+      backend->frame_count, texture->id);
+
+  row = malloc(row_size);
+  rgb = malloc(3 * size.width);
+  if (row == NULL || rgb == NULL) {
+    zms_log("failed to allocate memory\n");
+    goto out;
+  }
+
+  file = fopen(path, "w");
+  if (file == NULL) {
+    zms_log("failed to open %s: %s\n", path, strerror(errno));
+    goto out;
+  }
+
+  fprintf(file, "P6\n%d %d\n255\n", size.width, size.height);
+  for (int32_t y = 0; y < size.height; y++) {
+    off_t offset = texture->offset + (off_t)texture->stride * y;
+    if (pread(texture->fd, row, row_size, offset) != (ssize_t)row_size) {
+      zms_log("failed to read a texture\n");
+      break;
+    }
+    for (int32_t x = 0; x < size.width; x++) {
+      rgb[x * 3 + 0] = row[x].r;
+      rgb[x * 3 + 1] = row[x].g;
+      rgb[x * 3 + 2] = row[x].b;
+    }
+    fwrite(rgb, 3, size.width, file);
+  }
+
+  fclose(file);
+
+out:
+  free(rgb);
+  free(row);
+}
+
+static void
+zms_opengl_texture_buffer_updated(struct zms_opengl_texture* texture)
+{
+  if (texture->busy == false)
+    wl_list_insert(&texture->backend->busy_texture_list, &texture->link);
+  texture->busy = true;
+
+  if (texture->backend->dump_dir) zms_opengl_texture_dump(texture);
+}
+
+ZMS_EXPORT void
+zms_headless_texture_release_all(struct zms_backend* backend)
+{
+  struct zms_opengl_texture *texture, *tmp;
+
+  wl_list_for_each_safe(texture, tmp, &backend->busy_texture_list, link)
+  {
+    texture->busy = false;
+    wl_list_remove(&texture->link);
+    wl_list_init(&texture->link);
+  }
+}
+
+/* opengl component */
+
+ZMS_EXPORT struct zms_opengl_component*
+zms_opengl_component_create(struct zms_virtual_object* virtual_object)
+{
+  Z_UNUSED(virtual_object);
+  struct zms_opengl_component* component;
+  struct zms_opengl_component_private* priv;
+
+  component = zalloc(sizeof *component);
+  if (component == NULL) goto err;
+
+  priv = zalloc(sizeof *priv);
+  if (priv == NULL) goto err_priv;
+
+  priv->texture = NULL;
+  component->priv = priv;
+
+  return component;
+
+err_priv:
+  free(component);
+
+err:
+  return NULL;
+}
+
+ZMS_EXPORT void
+zms_opengl_component_destroy(struct zms_opengl_component* component)
+{
+  free(component->priv);
+  free(component);
+}
+
+ZMS_EXPORT void
+zms_opengl_component_attach_vertex_buffer(
+    struct zms_opengl_component* component,
+    struct zms_opengl_vertex_buffer* vertex_buffer)
+{
+  Z_UNUSED(component);
+  Z_UNUSED(vertex_buffer);
+}
+
+ZMS_EXPORT void
+zms_opengl_component_attach_shader_program(
+    struct zms_opengl_component* component,
+    struct zms_opengl_shader_program* shader)
+{
+  Z_UNUSED(component);
+  Z_UNUSED(shader);
+}
+
+ZMS_EXPORT void
+zms_opengl_component_attach_texture(
+    struct zms_opengl_component* component, struct zms_opengl_texture* texture)
+{
+  component->priv->texture = texture;
+}
+
+ZMS_EXPORT void
+zms_opengl_component_texture_updated(struct zms_opengl_component* component)
+{
+  if (component->priv->texture == NULL) return;
+  zms_opengl_texture_buffer_updated(component->priv->texture);
+}
+
+ZMS_EXPORT void
+zms_opengl_component_set_min(
+    struct zms_opengl_component* component, uint32_t min)
+{
+  Z_UNUSED(component);
+  Z_UNUSED(min);
+}
+
+ZMS_EXPORT void
+zms_opengl_component_set_count(
+    struct zms_opengl_component* component, uint32_t count)
+{
+  Z_UNUSED(component);
+  Z_UNUSED(count);
+}
+
+ZMS_EXPORT void
+zms_opengl_component_set_topology(
+    struct zms_opengl_component* component, uint32_t topology)
+{
+  Z_UNUSED(component);
+  Z_UNUSED(topology);
+}
+
+ZMS_EXPORT void
+zms_opengl_component_add_vertex_attribute(
+    struct zms_opengl_component* component, uint32_t index, uint32_t size,
+    uint32_t type, uint32_t normalized, uint32_t stride, uint32_t pointer)
+{
+  Z_UNUSED(component);
+  Z_UNUSED(index);
+  Z_UNUSED(size);
+  Z_UNUSED(type);
+  Z_UNUSED(normalized);
+  Z_UNUSED(stride);
+  Z_UNUSED(pointer);
+}
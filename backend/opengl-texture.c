@@ -44,6 +44,73 @@ err:
   return NULL;
 }
 
+ZMS_EXPORT struct zms_opengl_texture_pool*
+zms_opengl_texture_pool_create(
+    struct zms_backend* backend, int fd, size_t fd_size)
+{
+  struct zms_opengl_texture_pool* pool;
+
+  pool = zalloc(sizeof *pool);
+  if (pool == NULL) goto err;
+
+  // the fd is duplicated into the request
+  pool->proxy = wl_shm_create_pool(backend->shm, fd, fd_size);
+  if (pool->proxy == NULL) goto err_proxy;
+
+  pool->backend = backend;
+
+  return pool;
+
+err_proxy:
+  free(pool);
+
+err:
+  return NULL;
+}
+
+ZMS_EXPORT void
+zms_opengl_texture_pool_destroy(struct zms_opengl_texture_pool* pool)
+{
+  // zigen keeps the memory while buffers of the pool are alive
+  wl_shm_pool_destroy(pool->proxy);
+  free(pool);
+}
+
+ZMS_EXPORT struct zms_opengl_texture*
+zms_opengl_texture_create_by_pool(struct zms_opengl_texture_pool* pool,
+    int32_t offset, uint32_t stride, struct zms_screen_size size)
+{
+  struct zms_opengl_texture* texture;
+  struct zgn_opengl_texture* proxy;
+  struct zms_buffer* buffer;
+
+  texture = zalloc(sizeof *texture);
+  if (texture == NULL) goto err;
+
+  proxy = zgn_opengl_create_texture(pool->backend->opengl);
+  if (proxy == NULL) goto err_proxy;
+
+  buffer = zms_buffer_create_for_texture_by_pool(
+      pool->proxy, offset, size.width, size.height, stride);
+  if (buffer == NULL) goto err_buffer;
+
+  zgn_opengl_texture_attach_2d(proxy, buffer->proxy);
+
+  texture->proxy = proxy;
+  texture->buffer = buffer;
+
+  return texture;
+
+err_buffer:
+  zgn_opengl_texture_destroy(proxy);
+
+err_proxy:
+  free(texture);
+
+err:
+  return NULL;
+}
+
 ZMS_EXPORT void
 zms_opengl_texture_destroy(struct zms_opengl_texture* texture)
 {
@@ -56,6 +123,14 @@ ZMS_EXPORT void
 zms_opengl_texture_buffer_updated(struct zms_opengl_texture* texture)
 {
   zgn_opengl_texture_attach_2d(texture->proxy, texture->buffer->proxy);
+  // zigen reads the memory until it releases the buffer
+  texture->buffer->writable = false;
+}
+
+ZMS_EXPORT bool
+zms_opengl_texture_is_busy(struct zms_opengl_texture* texture)
+{
+  return texture->buffer->writable == false;
 }
 
 ZMS_EXPORT int
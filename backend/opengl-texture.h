@@ -3,6 +3,11 @@
 
 #include <zigen-opengl-client-protocol.h>
 
+struct zms_opengl_texture_pool {
+  struct zms_backend *backend;
+  struct wl_shm_pool *proxy;
+};
+
 struct zms_opengl_texture {
   struct zgn_opengl_texture *proxy;
   struct zms_buffer *buffer;
@@ -1,10 +1,13 @@
 #include "ray.h"
 
+#include <zmonitors-probe.h>
 #include <zmonitors-util.h>
 
 #include "backend.h"
 #include "virtual-object.h"
 
+ZMS_PROBE_DEFINE(ray_motion);
+
 static void
 zms_ray_focus_virtual_object_destroy_handler(
     struct zms_listener* listener, void* data)
@@ -69,6 +72,8 @@ zms_ray_protocol_motion(void* data, struct zgn_ray* zgn_ray, uint32_t time,
   struct zms_ray* ray = data;
   vec3 origin_vec, direction_vec;
 
+  ZMS_PROBE2(ray_motion, time, ray->focus_virtual_object != NULL);
+
   if (ray->focus_virtual_object == NULL) return;
 
   glm_vec3_from_wl_array(origin_vec, origin);
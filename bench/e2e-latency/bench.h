@@ -0,0 +1,105 @@
+#ifndef ZMONITORS_BENCH_E2E_LATENCY_BENCH_H
+#define ZMONITORS_BENCH_E2E_LATENCY_BENCH_H
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <wayland-client.h>
+#include <xdg-shell-client-protocol.h>
+#include <zmonitors-util.h>
+
+/* Measures how long a wl_surface.commit takes to reach zigen as a texture.
+ *
+ * zmonitors is run against zigen-mock, which prints a line for each texture
+ * attach and virtual object commit it receives. Synthetic xdg_toplevel
+ * clients commit at fixed rates from this process. A commit is matched to
+ * the first texture attach the mock receives after it, as zmonitors uploads
+ * every commit it has dispatched on its next repaint. */
+
+#define ZMS_BENCH_CLIENT_BUFFER_COUNT 3
+
+enum zms_bench_damage {
+  ZMS_BENCH_DAMAGE_FULL,  // the whole window
+  ZMS_BENCH_DAMAGE_BOX,   // a 64x64 box moving diagonally
+  ZMS_BENCH_DAMAGE_ROW,   // a 16 pixel tall band moving down
+};
+
+struct zms_bench_window_spec {
+  int32_t width, height;
+  enum zms_bench_damage damage;
+  uint32_t rate;  // commits per second
+};
+
+struct zms_bench_buffer {
+  struct wl_buffer* proxy;
+  uint32_t* data;
+  bool busy;  // until released by zmonitors
+};
+
+struct zms_bench_client {
+  struct zms_bench* bench;
+  struct zms_bench_window_spec spec;
+
+  struct wl_display* display;
+  struct wl_registry* registry;
+  struct wl_compositor* compositor;
+  struct wl_shm* shm;
+  struct xdg_wm_base* wm_base;
+  struct wl_surface* surface;
+  struct xdg_surface* xdg_surface;
+  struct xdg_toplevel* toplevel;
+  bool configured;
+
+  int pool_fd;
+  size_t pool_size;
+  struct zms_bench_buffer buffers[ZMS_BENCH_CLIENT_BUFFER_COUNT];
+
+  int timer_fd;
+  uint32_t seq;
+};
+
+struct zms_bench_stats {
+  uint64_t commits;
+  uint64_t dropped_commits;  // no buffer was released in time
+  uint64_t damage_bytes;     // written by the clients
+  uint64_t frames;           // virtual object commits by zmonitors
+  uint64_t texture_bytes;    // attached by zmonitors
+};
+
+struct zms_bench {
+  // the measurement runs from measure_begin to measure_end, CLOCK_MONOTONIC
+  uint64_t measure_begin;
+  uint64_t measure_end;
+
+  struct wl_array commit_times;  // uint64_t, of the measured commits
+  struct wl_array attach_times;  // uint64_t, every texture attach
+  struct zms_bench_stats stats;  // within the measurement
+};
+
+uint64_t zms_bench_get_time(void);
+
+struct zms_bench_client* zms_bench_client_create(
+    struct zms_bench* bench, struct zms_bench_window_spec* spec, int index);
+
+void zms_bench_client_destroy(struct zms_bench_client* client);
+
+/* Start committing at the rate of the spec */
+bool zms_bench_client_start(struct zms_bench_client* client);
+
+/* Call when the timer fd is readable */
+void zms_bench_client_commit(struct zms_bench_client* client);
+
+/* Spawn path with argv, NULL-terminated. stdout of the child is piped to
+ * *stdout_fd if it is not NULL, and discarded if quiet is true.
+ * @return pid or -1 */
+pid_t zms_bench_spawn(
+    char* const argv[], int* stdout_fd /* nullable */, bool quiet);
+
+/* Wait for a file to appear in $XDG_RUNTIME_DIR, as a socket does */
+bool zms_bench_wait_for_socket(const char* name, pid_t pid, int timeout_msec);
+
+/* User and system time used by the process so far, in nanoseconds */
+uint64_t zms_bench_get_cpu_time(pid_t pid);
+
+void zms_bench_terminate(pid_t pid);
+
+#endif  //  ZMONITORS_BENCH_E2E_LATENCY_BENCH_H
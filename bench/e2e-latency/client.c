@@ -0,0 +1,316 @@
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include "bench.h"
+
+#define BOX_SIZE 64
+#define ROW_HEIGHT 16
+
+static void
+zms_bench_buffer_release(void* data, struct wl_buffer* wl_buffer)
+{
+  Z_UNUSED(wl_buffer);
+  struct zms_bench_buffer* buffer = data;
+
+  buffer->busy = false;
+}
+
+static const struct wl_buffer_listener buffer_listener = {
+    .release = zms_bench_buffer_release,
+};
+
+static void
+zms_bench_wm_base_ping(void* data, struct xdg_wm_base* wm_base, uint32_t serial)
+{
+  Z_UNUSED(data);
+  xdg_wm_base_pong(wm_base, serial);
+}
+
+static const struct xdg_wm_base_listener wm_base_listener = {
+    .ping = zms_bench_wm_base_ping,
+};
+
+static void
+zms_bench_xdg_surface_configure(
+    void* data, struct xdg_surface* xdg_surface, uint32_t serial)
+{
+  struct zms_bench_client* client = data;
+
+  xdg_surface_ack_configure(xdg_surface, serial);
+  client->configured = true;
+}
+
+static const struct xdg_surface_listener xdg_surface_listener = {
+    .configure = zms_bench_xdg_surface_configure,
+};
+
+static void
+zms_bench_toplevel_configure(void* data, struct xdg_toplevel* toplevel,
+    int32_t width, int32_t height, struct wl_array* states)
+{
+  Z_UNUSED(data);
+  Z_UNUSED(toplevel);
+  Z_UNUSED(width);
+  Z_UNUSED(height);
+  Z_UNUSED(states);
+  // the window keeps the size of its spec
+}
+
+static void
+zms_bench_toplevel_close(void* data, struct xdg_toplevel* toplevel)
+{
+  Z_UNUSED(data);
+  Z_UNUSED(toplevel);
+}
+
+static const struct xdg_toplevel_listener toplevel_listener = {
+    .configure = zms_bench_toplevel_configure,
+    .close = zms_bench_toplevel_close,
+};
+
+static void
+zms_bench_registry_global(void* data, struct wl_registry* registry,
+    uint32_t name, const char* interface, uint32_t version)
+{
+  Z_UNUSED(version);
+  struct zms_bench_client* client = data;
+
+  if (strcmp(interface, "wl_compositor") == 0) {
+    client->compositor =
+        wl_registry_bind(registry, name, &wl_compositor_interface, 4);
+  } else if (strcmp(interface, "wl_shm") == 0) {
+    client->shm = wl_registry_bind(registry, name, &wl_shm_interface, 1);
+  } else if (strcmp(interface, "xdg_wm_base") == 0) {
+    client->wm_base =
+        wl_registry_bind(registry, name, &xdg_wm_base_interface, 1);
+    xdg_wm_base_add_listener(client->wm_base, &wm_base_listener, client);
+  }
+}
+
+static void
+zms_bench_registry_global_remove(
+    void* data, struct wl_registry* registry, uint32_t name)
+{
+  Z_UNUSED(data);
+  Z_UNUSED(registry);
+  Z_UNUSED(name);
+}
+
+static const struct wl_registry_listener registry_listener = {
+    .global = zms_bench_registry_global,
+    .global_remove = zms_bench_registry_global_remove,
+};
+
+static bool
+zms_bench_client_create_buffers(struct zms_bench_client* client)
+{
+  int32_t stride = client->spec.width * sizeof(uint32_t);
+  size_t buffer_size = (size_t)stride * client->spec.height;
+  struct wl_shm_pool* pool;
+  void* data;
+
+  client->pool_size = buffer_size * ZMS_BENCH_CLIENT_BUFFER_COUNT;
+  client->pool_fd =
+      zms_util_create_shared_fd(client->pool_size, "zmonitors-bench-client");
+  if (client->pool_fd < 0) return false;
+
+  data = mmap(NULL, client->pool_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+      client->pool_fd, 0);
+  if (data == MAP_FAILED) {
+    close(client->pool_fd);
+    return false;
+  }
+
+  pool = wl_shm_create_pool(client->shm, client->pool_fd, client->pool_size);
+
+  for (int i = 0; i < ZMS_BENCH_CLIENT_BUFFER_COUNT; i++) {
+    struct zms_bench_buffer* buffer = &client->buffers[i];
+    buffer->proxy = wl_shm_pool_create_buffer(pool, buffer_size * i,
+        client->spec.width, client->spec.height, stride,
+        WL_SHM_FORMAT_XRGB8888);
+    buffer->data = (uint32_t*)((char*)data + buffer_size * i);
+    buffer->busy = false;
+    wl_buffer_add_listener(buffer->proxy, &buffer_listener, buffer);
+  }
+
+  wl_shm_pool_destroy(pool);
+
+  return true;
+}
+
+ZMS_EXPORT struct zms_bench_client*
+zms_bench_client_create(
+    struct zms_bench* bench, struct zms_bench_window_spec* spec, int index)
+{
+  struct zms_bench_client* client;
+  char title[32];
+
+  client = zalloc(sizeof *client);
+  if (client == NULL) goto err;
+
+  client->bench = bench;
+  client->spec = *spec;
+  client->timer_fd = -1;
+
+  client->display = wl_display_connect(NULL);
+  if (client->display == NULL) {
+    zms_log("failed to connect to zmonitors\n");
+    goto err_display;
+  }
+
+  client->registry = wl_display_get_registry(client->display);
+  wl_registry_add_listener(client->registry, &registry_listener, client);
+  wl_display_roundtrip(client->display);
+
+  if (!client->compositor || !client->shm || !client->wm_base) {
+    zms_log("zmonitors lacks required globals\n");
+    goto err_globals;
+  }
+
+  if (zms_bench_client_create_buffers(client) == false) {
+    zms_log("failed to create buffers\n");
+    goto err_globals;
+  }
+
+  snprintf(title, sizeof title, "bench-%d", index);
+  client->surface = wl_compositor_create_surface(client->compositor);
+  client->xdg_surface =
+      xdg_wm_base_get_xdg_surface(client->wm_base, client->surface);
+  xdg_surface_add_listener(client->xdg_surface, &xdg_surface_listener, client);
+  client->toplevel = xdg_surface_get_toplevel(client->xdg_surface);
+  xdg_toplevel_add_listener(client->toplevel, &toplevel_listener, client);
+  xdg_toplevel_set_title(client->toplevel, title);
+  wl_surface_commit(client->surface);
+
+  while (client->configured == false) {
+    if (wl_display_dispatch(client->display) == -1) {
+      zms_log("disconnected before configured\n");
+      goto err_globals;
+    }
+  }
+
+  return client;
+
+err_globals:
+  wl_display_disconnect(client->display);
+
+err_display:
+  free(client);
+
+err:
+  return NULL;
+}
+
+ZMS_EXPORT void
+zms_bench_client_destroy(struct zms_bench_client* client)
+{
+  if (client->timer_fd >= 0) close(client->timer_fd);
+  munmap(client->buffers[0].data, client->pool_size);
+  close(client->pool_fd);
+  wl_display_disconnect(client->display);
+  free(client);
+}
+
+ZMS_EXPORT bool
+zms_bench_client_start(struct zms_bench_client* client)
+{
+  struct itimerspec interval;
+  long nsec = 1000000000L / client->spec.rate;
+
+  client->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+  if (client->timer_fd == -1) return false;
+
+  interval.it_interval.tv_sec = nsec / 1000000000L;
+  interval.it_interval.tv_nsec = nsec % 1000000000L;
+  interval.it_value = interval.it_interval;
+
+  return timerfd_settime(client->timer_fd, 0, &interval, NULL) == 0;
+}
+
+static void
+zms_bench_client_get_damage(struct zms_bench_client* client, int32_t* x,
+    int32_t* y, int32_t* width, int32_t* height)
+{
+  int32_t window_width = client->spec.width;
+  int32_t window_height = client->spec.height;
+  int32_t box_width = MIN(BOX_SIZE, window_width);
+  int32_t box_height = MIN(BOX_SIZE, window_height);
+  int32_t row_height = MIN(ROW_HEIGHT, window_height);
+
+  // deterministic, so that every run damages the same pixels
+  switch (client->spec.damage) {
+    case ZMS_BENCH_DAMAGE_FULL:
+      *x = *y = 0;
+      *width = window_width;
+      *height = window_height;
+      break;
+
+    case ZMS_BENCH_DAMAGE_BOX:
+      *x = (client->seq * 8) % (window_width - box_width + 1);
+      *y = (client->seq * 8) % (window_height - box_height + 1);
+      *width = box_width;
+      *height = box_height;
+      break;
+
+    case ZMS_BENCH_DAMAGE_ROW:
+      *x = 0;
+      *y = (client->seq * row_height) % (window_height - row_height + 1);
+      *width = window_width;
+      *height = row_height;
+      break;
+  }
+}
+
+ZMS_EXPORT void
+zms_bench_client_commit(struct zms_bench_client* client)
+{
+  struct zms_bench* bench = client->bench;
+  struct zms_bench_buffer* buffer = NULL;
+  uint64_t expirations, now, *commit_time;
+  int32_t x, y, width, height;
+  uint32_t color;
+
+  if (read(client->timer_fd, &expirations, sizeof expirations) !=
+      sizeof expirations)
+    return;
+
+  for (int i = 0; i < ZMS_BENCH_CLIENT_BUFFER_COUNT; i++) {
+    if (client->buffers[i].busy) continue;
+    buffer = &client->buffers[i];
+    break;
+  }
+
+  now = zms_bench_get_time();
+
+  if (buffer == NULL) {
+    if (bench->measure_begin <= now && now < bench->measure_end)
+      bench->stats.dropped_commits++;
+    return;
+  }
+
+  client->seq++;
+  zms_bench_client_get_damage(client, &x, &y, &width, &height);
+  color = 0xff000000 | ((client->seq * 0x010203) & 0x00ffffff);
+  for (int32_t row = y; row < y + height; row++) {
+    uint32_t* line = buffer->data + row * client->spec.width;
+    for (int32_t column = x; column < x + width; column++) line[column] = color;
+  }
+
+  wl_surface_attach(client->surface, buffer->proxy, 0, 0);
+  wl_surface_damage_buffer(client->surface, x, y, width, height);
+  buffer->busy = true;
+
+  now = zms_bench_get_time();
+  wl_surface_commit(client->surface);
+  wl_display_flush(client->display);
+
+  if (now < bench->measure_begin || bench->measure_end <= now) return;
+
+  commit_time = wl_array_add(&bench->commit_times, sizeof *commit_time);
+  if (commit_time) *commit_time = now;
+  bench->stats.commits++;
+  bench->stats.damage_bytes += (uint64_t)width * height * sizeof(uint32_t);
+}
@@ -0,0 +1,505 @@
+#include <errno.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench.h"
+
+#define MOCK_SOCKET "zigen-bench"
+#define ZMONITORS_SOCKET "wayland-0"  // the first one in a new runtime dir
+#define SOCKET_TIMEOUT_MSEC 5000
+// attaches for the last measured commits arrive within this
+#define DRAIN_MSEC 500
+#define POLL_TIMEOUT_MSEC 10
+
+struct options {
+  char* zmonitors_path;
+  char* zigen_mock_path;
+  struct zms_bench_window_spec default_spec;
+  int window_count;
+  struct wl_array extra_specs;  // struct zms_bench_window_spec
+  uint32_t refresh;
+  uint32_t warmup_sec;
+  uint32_t duration_sec;
+  bool json;
+  bool verbose;
+  char** zmonitors_args;  // after "--"
+  int zmonitors_arg_count;
+};
+
+struct mock_reader {
+  int fd;
+  char line[256];
+  size_t line_length;
+};
+
+static void
+print_usage(const char* program)
+{
+  fprintf(stderr,
+      "usage: %s --zmonitors=PATH --zigen-mock=PATH [options] [-- ARGS]\n"
+      "\n"
+      "Run zmonitors ARGS against zigen-mock with synthetic clients, and\n"
+      "report how long a commit takes to reach zigen as a texture.\n"
+      "\n"
+      "  -n, --windows=N            N identical windows (default: 4)\n"
+      "  -s, --size=WxH             their size (default: 640x480)\n"
+      "  -d, --damage=PATTERN       full, box or row (default: box)\n"
+      "  -r, --rate=HZ              their commit rate (default: 60)\n"
+      "  -w, --window=WxH,PAT,HZ    add a window; may be repeated\n"
+      "  -R, --refresh=HZ           zigen-mock frame rate (default: 60)\n"
+      "  -W, --warmup=SEC           not measured (default: 1)\n"
+      "  -D, --duration=SEC         measured (default: 5)\n"
+      "  -j, --json                 print the report as JSON\n"
+      "  -v, --verbose              show output of zmonitors\n"
+      "  -h, --help                 show this help\n",
+      program);
+}
+
+static bool
+parse_damage(const char* name, enum zms_bench_damage* damage)
+{
+  if (strcmp(name, "full") == 0)
+    *damage = ZMS_BENCH_DAMAGE_FULL;
+  else if (strcmp(name, "box") == 0)
+    *damage = ZMS_BENCH_DAMAGE_BOX;
+  else if (strcmp(name, "row") == 0)
+    *damage = ZMS_BENCH_DAMAGE_ROW;
+  else
+    return false;
+
+  return true;
+}
+
+static bool
+parse_window_spec(const char* text, struct zms_bench_window_spec* spec)
+{
+  char damage[16];
+
+  if (sscanf(text, "%dx%d,%15[a-z],%u", &spec->width, &spec->height, damage,
+          &spec->rate) != 4)
+    return false;
+
+  return spec->width > 0 && spec->height > 0 && spec->rate > 0 &&
+         parse_damage(damage, &spec->damage);
+}
+
+static bool
+parse_options(int argc, char* argv[], struct options* options)
+{
+  static const struct option long_options[] = {
+      {"zmonitors", required_argument, NULL, 'Z'},
+      {"zigen-mock", required_argument, NULL, 'M'},
+      {"windows", required_argument, NULL, 'n'},
+      {"size", required_argument, NULL, 's'},
+      {"damage", required_argument, NULL, 'd'},
+      {"rate", required_argument, NULL, 'r'},
+      {"window", required_argument, NULL, 'w'},
+      {"refresh", required_argument, NULL, 'R'},
+      {"warmup", required_argument, NULL, 'W'},
+      {"duration", required_argument, NULL, 'D'},
+      {"json", no_argument, NULL, 'j'},
+      {"verbose", no_argument, NULL, 'v'},
+      {"help", no_argument, NULL, 'h'},
+      {NULL, 0, NULL, 0},
+  };
+  struct zms_bench_window_spec* spec;
+  int opt;
+
+  while ((opt = getopt_long(argc, argv, "Z:M:n:s:d:r:w:R:W:D:jvh",
+              long_options, NULL)) != -1) {
+    switch (opt) {
+      case 'Z':
+        options->zmonitors_path = optarg;
+        break;
+
+      case 'M':
+        options->zigen_mock_path = optarg;
+        break;
+
+      case 'n':
+        if (sscanf(optarg, "%d", &options->window_count) != 1 ||
+            options->window_count < 0)
+          goto invalid;
+        break;
+
+      case 's':
+        if (sscanf(optarg, "%dx%d", &options->default_spec.width,
+                &options->default_spec.height) != 2 ||
+            options->default_spec.width < 1 ||
+            options->default_spec.height < 1)
+          goto invalid;
+        break;
+
+      case 'd':
+        if (parse_damage(optarg, &options->default_spec.damage) == false)
+          goto invalid;
+        break;
+
+      case 'r':
+        if (sscanf(optarg, "%u", &options->default_spec.rate) != 1 ||
+            options->default_spec.rate < 1)
+          goto invalid;
+        break;
+
+      case 'w':
+        spec = wl_array_add(&options->extra_specs, sizeof *spec);
+        if (spec == NULL || parse_window_spec(optarg, spec) == false)
+          goto invalid;
+        break;
+
+      case 'R':
+        if (sscanf(optarg, "%u", &options->refresh) != 1 ||
+            options->refresh < 1)
+          goto invalid;
+        break;
+
+      case 'W':
+        if (sscanf(optarg, "%u", &options->warmup_sec) != 1) goto invalid;
+        break;
+
+      case 'D':
+        if (sscanf(optarg, "%u", &options->duration_sec) != 1 ||
+            options->duration_sec < 1)
+          goto invalid;
+        break;
+
+      case 'j':
+        options->json = true;
+        break;
+
+      case 'v':
+        options->verbose = true;
+        break;
+
+      case 'h':
+      default:
+        print_usage(argv[0]);
+        return false;
+    }
+  }
+
+  if (!options->zmonitors_path || !options->zigen_mock_path) {
+    print_usage(argv[0]);
+    return false;
+  }
+
+  options->zmonitors_args = argv + optind;
+  options->zmonitors_arg_count = argc - optind;
+
+  return true;
+
+invalid:
+  zms_log("invalid argument: %s\n", optarg);
+  return false;
+}
+
+static void
+handle_mock_line(struct zms_bench* bench, char* line)
+{
+  char event[16];
+  uint64_t time, value, *attach_time;
+
+  if (sscanf(line, "%15s %" SCNu64 " %" SCNu64, event, &time, &value) != 3)
+    return;
+
+  if (strcmp(event, "attach") == 0) {
+    attach_time = wl_array_add(&bench->attach_times, sizeof *attach_time);
+    if (attach_time) *attach_time = time;
+    if (bench->measure_begin <= time && time < bench->measure_end)
+      bench->stats.texture_bytes += value;
+  } else if (strcmp(event, "commit") == 0) {
+    if (bench->measure_begin <= time && time < bench->measure_end)
+      bench->stats.frames++;
+  }
+}
+
+/* @return false on EOF */
+static bool
+read_mock_output(struct mock_reader* reader, struct zms_bench* bench)
+{
+  char* newline;
+  ssize_t size;
+
+  size = read(reader->fd, reader->line + reader->line_length,
+      sizeof reader->line - reader->line_length - 1);
+  if (size == -1 && errno == EINTR) return true;
+  if (size <= 0) return false;
+
+  reader->line_length += size;
+  reader->line[reader->line_length] = '\0';
+
+  while ((newline = strchr(reader->line, '\n'))) {
+    *newline = '\0';
+    handle_mock_line(bench, reader->line);
+    reader->line_length -= newline + 1 - reader->line;
+    memmove(reader->line, newline + 1, reader->line_length + 1);
+  }
+
+  // lines are short; a full buffer means garbage
+  if (reader->line_length == sizeof reader->line - 1) reader->line_length = 0;
+
+  return true;
+}
+
+static int
+compare_u64(const void* a, const void* b)
+{
+  uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+
+  return (x > y) - (x < y);
+}
+
+static double
+percentile_msec(uint64_t* sorted, size_t count, double p)
+{
+  size_t rank;
+
+  if (count == 0) return 0;
+
+  // nearest rank
+  rank = (size_t)(p / 100 * count + 0.999999);
+  if (rank < 1) rank = 1;
+  if (rank > count) rank = count;
+
+  return sorted[rank - 1] / 1e6;
+}
+
+static void
+report(struct zms_bench* bench, struct options* options, int window_count,
+    uint64_t cpu_time)
+{
+  uint64_t* commits = bench->commit_times.data;
+  uint64_t* attaches = bench->attach_times.data;
+  size_t commit_count = bench->commit_times.size / sizeof *commits;
+  size_t attach_count = bench->attach_times.size / sizeof *attaches;
+  size_t latency_count = 0, unmatched = 0, a = 0;
+  uint64_t *latencies, sum = 0;
+  struct zms_bench_stats* stats = &bench->stats;
+  double frames = stats->frames ? stats->frames : 1;
+  double p50, p90, p99, max, mean;
+
+  latencies = calloc(commit_count ? commit_count : 1, sizeof *latencies);
+  if (latencies == NULL) return;
+
+  // both are in time order, as they were read from a single stream each
+  for (size_t c = 0; c < commit_count; c++) {
+    while (a < attach_count && attaches[a] <= commits[c]) a++;
+    if (a == attach_count) {
+      unmatched++;
+      continue;
+    }
+    latencies[latency_count] = attaches[a] - commits[c];
+    sum += latencies[latency_count];
+    latency_count++;
+  }
+
+  qsort(latencies, latency_count, sizeof *latencies, compare_u64);
+
+  p50 = percentile_msec(latencies, latency_count, 50);
+  p90 = percentile_msec(latencies, latency_count, 90);
+  p99 = percentile_msec(latencies, latency_count, 99);
+  max = latency_count ? latencies[latency_count - 1] / 1e6 : 0;
+  mean = latency_count ? sum / 1e6 / latency_count : 0;
+
+  if (options->json) {
+    printf(
+        "{\"windows\": %d, \"duration_sec\": %u, \"frames\": %" PRIu64
+        ", \"commits\": %" PRIu64 ", \"dropped_commits\": %" PRIu64
+        ", \"unmatched_commits\": %zu, \"latency_ms\": {\"p50\": %.3f, "
+        "\"p90\": %.3f, \"p99\": %.3f, \"max\": %.3f, \"mean\": %.3f}, "
+        "\"cpu_ms_per_frame\": %.3f, \"texture_bytes_per_frame\": %.0f, "
+        "\"damage_bytes_per_frame\": %.0f}\n",
+        window_count, options->duration_sec, stats->frames, stats->commits,
+        stats->dropped_commits, unmatched, p50, p90, p99, max, mean,
+        cpu_time / 1e6 / frames, stats->texture_bytes / frames,
+        stats->damage_bytes / frames);
+  } else {
+    printf("windows:                 %d\n", window_count);
+    printf("duration:                %u s\n", options->duration_sec);
+    printf("frames:                  %" PRIu64 "\n", stats->frames);
+    printf("commits:                 %" PRIu64
+           " (dropped %" PRIu64 ", unmatched %zu)\n",
+        stats->commits, stats->dropped_commits, unmatched);
+    printf("latency:                 p50 %.3f ms, p90 %.3f ms, p99 %.3f ms, "
+           "max %.3f ms, mean %.3f ms\n",
+        p50, p90, p99, max, mean);
+    printf("cpu per frame:           %.3f ms\n", cpu_time / 1e6 / frames);
+    printf("texture bytes per frame: %.0f\n", stats->texture_bytes / frames);
+    printf("damage bytes per frame:  %.0f\n", stats->damage_bytes / frames);
+  }
+
+  free(latencies);
+}
+
+static void
+remove_runtime_dir(const char* runtime_dir)
+{
+  const char* names[] = {MOCK_SOCKET, MOCK_SOCKET ".lock", ZMONITORS_SOCKET,
+      ZMONITORS_SOCKET ".lock"};
+  char path[256];
+
+  // normally removed by the servers on exit
+  for (size_t i = 0; i < sizeof names / sizeof names[0]; i++) {
+    snprintf(path, sizeof path, "%s/%s", runtime_dir, names[i]);
+    unlink(path);
+  }
+
+  rmdir(runtime_dir);
+}
+
+int
+main(int argc, char* argv[])
+{
+  struct options options = {0};
+  struct zms_bench bench = {0};
+  struct mock_reader reader = {.fd = -1};
+  struct zms_bench_window_spec* spec;
+  struct zms_bench_client** clients = NULL;
+  struct pollfd* fds = NULL;
+  char runtime_dir[] = "/tmp/zmonitors-bench-XXXXXX";
+  char mock_socket_arg[] = "--socket=" MOCK_SOCKET;
+  char refresh_arg[32], zigen_socket_arg[] = "--zigen-socket=" MOCK_SOCKET;
+  char* mock_argv[] = {NULL, mock_socket_arg, refresh_arg, "--trace", NULL};
+  char** zmonitors_argv = NULL;
+  pid_t mock_pid = -1, zmonitors_pid = -1;
+  uint64_t cpu_begin = 0, cpu_time = 0, drain_end, now;
+  bool cpu_begin_taken = false, cpu_time_taken = false;
+  int window_count = 0, exit_code = EXIT_FAILURE;
+
+  options.default_spec.width = 640;
+  options.default_spec.height = 480;
+  options.default_spec.damage = ZMS_BENCH_DAMAGE_BOX;
+  options.default_spec.rate = 60;
+  options.window_count = 4;
+  options.refresh = 60;
+  options.warmup_sec = 1;
+  options.duration_sec = 5;
+  wl_array_init(&options.extra_specs);
+  wl_array_init(&bench.commit_times);
+  wl_array_init(&bench.attach_times);
+
+  if (parse_options(argc, argv, &options) == false) goto out;
+
+  if (mkdtemp(runtime_dir) == NULL) {
+    zms_log("failed to create a runtime dir\n");
+    goto out;
+  }
+  // a private runtime dir makes the socket names predictable
+  setenv("XDG_RUNTIME_DIR", runtime_dir, 1);
+  unsetenv("WAYLAND_DISPLAY");
+
+  mock_argv[0] = options.zigen_mock_path;
+  snprintf(refresh_arg, sizeof refresh_arg, "--refresh=%u", options.refresh);
+  mock_pid = zms_bench_spawn(mock_argv, &reader.fd, !options.verbose);
+  if (mock_pid == -1) goto out_runtime_dir;
+  if (!zms_bench_wait_for_socket(MOCK_SOCKET, mock_pid, SOCKET_TIMEOUT_MSEC))
+    goto out_processes;
+
+  zmonitors_argv = calloc(options.zmonitors_arg_count + 3, sizeof(char*));
+  if (zmonitors_argv == NULL) goto out_processes;
+  zmonitors_argv[0] = options.zmonitors_path;
+  zmonitors_argv[1] = zigen_socket_arg;
+  for (int i = 0; i < options.zmonitors_arg_count; i++)
+    zmonitors_argv[i + 2] = options.zmonitors_args[i];
+  zmonitors_pid = zms_bench_spawn(zmonitors_argv, NULL, !options.verbose);
+  if (zmonitors_pid == -1) goto out_processes;
+  if (!zms_bench_wait_for_socket(
+          ZMONITORS_SOCKET, zmonitors_pid, SOCKET_TIMEOUT_MSEC))
+    goto out_processes;
+
+  // nothing is measured until the clients are set up
+  bench.measure_begin = bench.measure_end = UINT64_MAX;
+
+  window_count = options.window_count + options.extra_specs.size / sizeof *spec;
+  clients = calloc(window_count ? window_count : 1, sizeof *clients);
+  fds = calloc(window_count * 2 + 1, sizeof *fds);
+  if (clients == NULL || fds == NULL) goto out_clients;
+
+  for (int i = 0; i < window_count; i++) {
+    spec = i < options.window_count
+               ? &options.default_spec
+               : (struct zms_bench_window_spec*)options.extra_specs.data +
+                     (i - options.window_count);
+    clients[i] = zms_bench_client_create(&bench, spec, i);
+    if (clients[i] == NULL) goto out_clients;
+  }
+
+  for (int i = 0; i < window_count; i++) {
+    if (zms_bench_client_start(clients[i]) == false) goto out_clients;
+    fds[i * 2].fd = wl_display_get_fd(clients[i]->display);
+    fds[i * 2 + 1].fd = clients[i]->timer_fd;
+  }
+  fds[window_count * 2].fd = reader.fd;
+  for (int i = 0; i < window_count * 2 + 1; i++) fds[i].events = POLLIN;
+
+  now = zms_bench_get_time();
+  bench.measure_begin = now + options.warmup_sec * 1000000000ull;
+  bench.measure_end =
+      bench.measure_begin + options.duration_sec * 1000000000ull;
+  drain_end = bench.measure_end + DRAIN_MSEC * 1000000ull;
+
+  while ((now = zms_bench_get_time()) < drain_end) {
+    if (cpu_begin_taken == false && now >= bench.measure_begin) {
+      cpu_begin = zms_bench_get_cpu_time(zmonitors_pid);
+      cpu_begin_taken = true;
+    }
+    if (cpu_time_taken == false && now >= bench.measure_end) {
+      cpu_time = zms_bench_get_cpu_time(zmonitors_pid) - cpu_begin;
+      cpu_time_taken = true;
+    }
+
+    for (int i = 0; i < window_count; i++)
+      wl_display_flush(clients[i]->display);
+
+    if (poll(fds, window_count * 2 + 1, POLL_TIMEOUT_MSEC) == -1) {
+      if (errno == EINTR) continue;
+      zms_log("failed to poll\n");
+      goto out_clients;
+    }
+
+    for (int i = 0; i < window_count; i++) {
+      if (fds[i * 2].revents & POLLIN &&
+          wl_display_dispatch(clients[i]->display) == -1) {
+        zms_log("client %d was disconnected\n", i);
+        goto out_clients;
+      }
+      // clients stop committing while the last attaches are drained
+      if (fds[i * 2 + 1].revents & POLLIN && now < bench.measure_end)
+        zms_bench_client_commit(clients[i]);
+    }
+
+    if (fds[window_count * 2].revents & (POLLIN | POLLHUP) &&
+        read_mock_output(&reader, &bench) == false) {
+      zms_log("zigen-mock exited\n");
+      goto out_clients;
+    }
+  }
+
+  report(&bench, &options, window_count, cpu_time);
+  exit_code = EXIT_SUCCESS;
+
+out_clients:
+  for (int i = 0; clients && i < window_count; i++)
+    if (clients[i]) zms_bench_client_destroy(clients[i]);
+  free(clients);
+  free(fds);
+
+out_processes:
+  zms_bench_terminate(zmonitors_pid);
+  zms_bench_terminate(mock_pid);
+  if (reader.fd >= 0) close(reader.fd);
+  free(zmonitors_argv);
+
+out_runtime_dir:
+  remove_runtime_dir(runtime_dir);
+
+out:
+  wl_array_release(&options.extra_specs);
+  wl_array_release(&bench.commit_times);
+  wl_array_release(&bench.attach_times);
+  return exit_code;
+}
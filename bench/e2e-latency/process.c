@@ -0,0 +1,138 @@
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "bench.h"
+
+#define SOCKET_POLL_INTERVAL_MSEC 10
+#define TERMINATE_TIMEOUT_MSEC 3000
+
+ZMS_EXPORT uint64_t
+zms_bench_get_time(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+ZMS_EXPORT pid_t
+zms_bench_spawn(char* const argv[], int* stdout_fd, bool quiet)
+{
+  int pipe_fds[2] = {-1, -1};
+  int null_fd;
+  pid_t pid;
+
+  if (stdout_fd && pipe2(pipe_fds, O_CLOEXEC) == -1) {
+    zms_log("failed to create a pipe\n");
+    return -1;
+  }
+
+  pid = fork();
+  if (pid == -1) {
+    zms_log("failed to fork\n");
+    if (stdout_fd) {
+      close(pipe_fds[0]);
+      close(pipe_fds[1]);
+    }
+    return -1;
+  }
+
+  if (pid == 0) {
+    null_fd = open("/dev/null", O_RDWR);
+    // keep stdin open but silent so that commands are never read
+    dup2(null_fd, STDIN_FILENO);
+    if (stdout_fd)
+      dup2(pipe_fds[1], STDOUT_FILENO);
+    else if (quiet)
+      dup2(null_fd, STDOUT_FILENO);
+    if (quiet) dup2(null_fd, STDERR_FILENO);
+    execv(argv[0], argv);
+    fprintf(stderr, "failed to execute %s\n", argv[0]);
+    _exit(EXIT_FAILURE);
+  }
+
+  if (stdout_fd) {
+    close(pipe_fds[1]);
+    *stdout_fd = pipe_fds[0];
+  }
+
+  return pid;
+}
+
+ZMS_EXPORT bool
+zms_bench_wait_for_socket(const char* name, pid_t pid, int timeout_msec)
+{
+  const char* runtime_dir = getenv("XDG_RUNTIME_DIR");
+  char path[256];
+  struct stat st;
+
+  snprintf(path, sizeof path, "%s/%s", runtime_dir, name);
+
+  for (int waited = 0; waited < timeout_msec;
+       waited += SOCKET_POLL_INTERVAL_MSEC) {
+    if (stat(path, &st) == 0 && S_ISSOCK(st.st_mode)) return true;
+    if (waitpid(pid, NULL, WNOHANG) == pid) {
+      zms_log("the process exited before creating %s\n", name);
+      return false;
+    }
+    poll(NULL, 0, SOCKET_POLL_INTERVAL_MSEC);
+  }
+
+  zms_log("timed out waiting for %s\n", path);
+  return false;
+}
+
+ZMS_EXPORT uint64_t
+zms_bench_get_cpu_time(pid_t pid)
+{
+  char path[64], buffer[1024], *fields;
+  unsigned long utime, stime;
+  long ticks_per_second = sysconf(_SC_CLK_TCK);
+  ssize_t size;
+  int fd;
+
+  snprintf(path, sizeof path, "/proc/%d/stat", pid);
+  fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd == -1) return 0;
+  size = read(fd, buffer, sizeof buffer - 1);
+  close(fd);
+  if (size <= 0) return 0;
+  buffer[size] = '\0';
+
+  // the command name may contain spaces; fields restart after its ')'
+  fields = strrchr(buffer, ')');
+  if (fields == NULL) return 0;
+
+  // field 3 (state) to 13 are skipped; 14 is utime and 15 is stime
+  if (sscanf(fields + 1, " %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu",
+          &utime, &stime) != 2)
+    return 0;
+
+  return (uint64_t)(utime + stime) * 1000000000 / ticks_per_second;
+}
+
+ZMS_EXPORT void
+zms_bench_terminate(pid_t pid)
+{
+  if (pid <= 0) return;
+
+  kill(pid, SIGTERM);
+
+  for (int waited = 0; waited < TERMINATE_TIMEOUT_MSEC;
+       waited += SOCKET_POLL_INTERVAL_MSEC) {
+    if (waitpid(pid, NULL, WNOHANG) == pid) return;
+    poll(NULL, 0, SOCKET_POLL_INTERVAL_MSEC);
+  }
+
+  zms_log("killing %d, which did not exit on SIGTERM\n", pid);
+  kill(pid, SIGKILL);
+  waitpid(pid, NULL, 0);
+}
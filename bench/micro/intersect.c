@@ -0,0 +1,57 @@
+#include "intersect.h"
+
+#include "micro.h"
+
+#define RAY_COUNT 256
+
+struct intersect_bench {
+  vec3 origins[RAY_COUNT];
+  vec3 directions[RAY_COUNT];
+  vec3 v0, vx, vy;
+};
+
+static void*
+intersect_setup(void)
+{
+  struct intersect_bench* bench = zalloc(sizeof *bench);
+  uint32_t state = 2463534242;
+
+  if (bench == NULL) return NULL;
+
+  // a 0.6m x 0.34m screen 1m away, as the monitor is laid out
+  glm_vec3_copy((vec3){-0.3f, 0.17f, -1.0f}, bench->v0);
+  glm_vec3_copy((vec3){0.3f, 0.17f, -1.0f}, bench->vx);
+  glm_vec3_copy((vec3){-0.3f, -0.17f, -1.0f}, bench->vy);
+
+  // about half of the rays hit the screen
+  for (int i = 0; i < RAY_COUNT; i++) {
+    glm_vec3_zero(bench->origins[i]);
+    bench->directions[i][0] = zms_micro_random(&state) % 1000 / 1000.0f - 0.5f;
+    bench->directions[i][1] = zms_micro_random(&state) % 1000 / 1000.0f - 0.5f;
+    bench->directions[i][2] = -1;
+  }
+
+  return bench;
+}
+
+static void
+intersect_run(void* data, uint64_t iterations)
+{
+  struct intersect_bench* bench = data;
+  vec2 pos;
+  float distance;
+  uint64_t hits = 0;
+
+  for (uint64_t i = 0; i < iterations; i++) {
+    hits += zms_interesect_ray_rect(bench->origins[i % RAY_COUNT],
+        bench->directions[i % RAY_COUNT], bench->v0, bench->vx, bench->vy, pos,
+        &distance);
+  }
+
+  zms_micro_do_not_optimize(&hits);
+}
+
+const struct zms_micro_benchmark zms_micro_intersect_benchmarks[] = {
+    {"intersect_ray_rect", intersect_setup, intersect_run, free},
+    {NULL, NULL, NULL, NULL},
+};
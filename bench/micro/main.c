@@ -0,0 +1,341 @@
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <wayland-util.h>
+
+#include "micro.h"
+
+#define NAME_MAX_LENGTH 64
+#define DEFAULT_MIN_TIME_MSEC 200
+#define DEFAULT_THRESHOLD_PERCENT 10
+// the median of this many runs is reported
+#define RUN_COUNT 5
+
+struct options {
+  const char* filter;    // nullable, substring of the benchmark names
+  const char* baseline;  // nullable, output of a previous --json run
+  double threshold_percent;
+  uint64_t min_time_nsec;  // per run
+  bool json;
+};
+
+struct result {
+  double ns_per_op;  // median
+  double min_ns_per_op;
+  uint64_t iterations;  // per run
+};
+
+struct baseline_entry {
+  char name[NAME_MAX_LENGTH];
+  double ns_per_op;
+};
+
+static const struct zms_micro_benchmark* benchmark_groups[] = {
+    zms_micro_server_benchmarks,
+    zms_micro_util_benchmarks,
+    zms_micro_intersect_benchmarks,
+    NULL,
+};
+
+static void
+print_usage(const char* program)
+{
+  fprintf(stderr,
+      "usage: %s [options]\n"
+      "\n"
+      "Run the microbenchmarks of the compositing and region primitives\n"
+      "and report the median time per operation.\n"
+      "\n"
+      "  -f, --filter=TEXT     run only the benchmarks whose name has TEXT\n"
+      "  -t, --min-time=MSEC   minimum time of each run (default: 200)\n"
+      "  -b, --baseline=FILE   compare with the output of a --json run\n"
+      "  -r, --threshold=PCT   fail if a benchmark is more than PCT percent\n"
+      "                        slower than the baseline (default: 10)\n"
+      "  -j, --json            print one JSON object per benchmark\n"
+      "  -h, --help            show this help\n",
+      program);
+}
+
+static bool
+parse_options(int argc, char* argv[], struct options* options)
+{
+  static const struct option long_options[] = {
+      {"filter", required_argument, NULL, 'f'},
+      {"min-time", required_argument, NULL, 't'},
+      {"baseline", required_argument, NULL, 'b'},
+      {"threshold", required_argument, NULL, 'r'},
+      {"json", no_argument, NULL, 'j'},
+      {"help", no_argument, NULL, 'h'},
+      {NULL, 0, NULL, 0},
+  };
+  int opt, value;
+
+  while ((opt = getopt_long(argc, argv, "f:t:b:r:jh", long_options, NULL)) !=
+         -1) {
+    if ((opt == 't' || opt == 'r') &&
+        (sscanf(optarg, "%d", &value) != 1 || value < 1)) {
+      zms_log("invalid argument: %s\n", optarg);
+      return false;
+    }
+
+    switch (opt) {
+      case 'f':
+        options->filter = optarg;
+        break;
+
+      case 't':
+        options->min_time_nsec = (uint64_t)value * 1000000;
+        break;
+
+      case 'b':
+        options->baseline = optarg;
+        break;
+
+      case 'r':
+        options->threshold_percent = value;
+        break;
+
+      case 'j':
+        options->json = true;
+        break;
+
+      case 'h':
+      default:
+        print_usage(argv[0]);
+        return false;
+    }
+  }
+
+  return true;
+}
+
+ZMS_EXPORT uint32_t
+zms_micro_random(uint32_t* state)
+{
+  // xorshift32
+  *state ^= *state << 13;
+  *state ^= *state >> 17;
+  *state ^= *state << 5;
+
+  return *state;
+}
+
+static uint64_t
+get_time(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+static uint64_t
+time_run(const struct zms_micro_benchmark* benchmark, void* data,
+    uint64_t iterations)
+{
+  uint64_t begin = get_time();
+
+  benchmark->run(data, iterations);
+
+  return get_time() - begin;
+}
+
+static int
+compare_double(const void* a, const void* b)
+{
+  double x = *(const double*)a, y = *(const double*)b;
+
+  return (x > y) - (x < y);
+}
+
+static bool
+run_benchmark(const struct zms_micro_benchmark* benchmark,
+    struct options* options, struct result* result)
+{
+  double ns_per_op[RUN_COUNT];
+  uint64_t iterations = 1, elapsed;
+  void* data = NULL;
+
+  if (benchmark->setup) {
+    data = benchmark->setup();
+    if (data == NULL) {
+      zms_log("failed to set up %s\n", benchmark->name);
+      return false;
+    }
+  }
+
+  // grow the iterations until a run takes long enough, also warming up
+  for (;;) {
+    elapsed = time_run(benchmark, data, iterations);
+    if (elapsed >= options->min_time_nsec) break;
+    if (elapsed == 0)
+      iterations *= 100;
+    else
+      iterations = MIN(iterations * 100,
+          iterations * options->min_time_nsec * 6 / 5 / elapsed + 1);
+  }
+
+  for (int i = 0; i < RUN_COUNT; i++)
+    ns_per_op[i] =
+        (double)time_run(benchmark, data, iterations) / (double)iterations;
+
+  if (benchmark->teardown) benchmark->teardown(data);
+
+  qsort(ns_per_op, RUN_COUNT, sizeof ns_per_op[0], compare_double);
+  result->ns_per_op = ns_per_op[RUN_COUNT / 2];
+  result->min_ns_per_op = ns_per_op[0];
+  result->iterations = iterations;
+
+  return true;
+}
+
+static bool
+load_baseline(const char* path, struct wl_array* entries)
+{
+  struct baseline_entry* entry;
+  char line[256], name[NAME_MAX_LENGTH];
+  double ns_per_op;
+  FILE* file;
+
+  file = fopen(path, "r");
+  if (file == NULL) {
+    zms_log("failed to open %s\n", path);
+    return false;
+  }
+
+  // lines of other shapes are skipped
+  while (fgets(line, sizeof line, file)) {
+    if (sscanf(line, "{\"name\": \"%63[^\"]\", \"ns_per_op\": %lf", name,
+            &ns_per_op) != 2)
+      continue;
+
+    entry = wl_array_add(entries, sizeof *entry);
+    if (entry == NULL) {
+      zms_log("failed to allocate memory\n");
+      fclose(file);
+      return false;
+    }
+    strcpy(entry->name, name);
+    entry->ns_per_op = ns_per_op;
+  }
+
+  fclose(file);
+
+  return true;
+}
+
+static struct baseline_entry*
+find_baseline(struct wl_array* entries, const char* name)
+{
+  struct baseline_entry* entry;
+
+  wl_array_for_each(entry, entries)
+  {
+    if (strcmp(entry->name, name) == 0) return entry;
+  }
+
+  return NULL;
+}
+
+static bool
+is_regression(struct result* result, struct baseline_entry* baseline,
+    double threshold_percent)
+{
+  if (baseline == NULL) return false;
+
+  return result->ns_per_op >
+         baseline->ns_per_op * (1 + threshold_percent / 100);
+}
+
+static void
+print_result(const char* name, struct result* result,
+    struct baseline_entry* baseline, bool json)
+{
+  if (json) {
+    printf(
+        "{\"name\": \"%s\", \"ns_per_op\": %.2f, \"min_ns_per_op\": %.2f, "
+        "\"iterations\": %lu}\n",
+        name, result->ns_per_op, result->min_ns_per_op, result->iterations);
+  } else {
+    printf("%-36s %12.1f ns/op  (min %.1f, %lu iterations)", name,
+        result->ns_per_op, result->min_ns_per_op, result->iterations);
+    if (baseline)
+      printf("  %+.1f%%",
+          (result->ns_per_op / baseline->ns_per_op - 1) * 100);
+    printf("\n");
+  }
+
+  fflush(stdout);
+}
+
+int
+main(int argc, char* argv[])
+{
+  struct options options = {
+      .filter = NULL,
+      .baseline = NULL,
+      .threshold_percent = DEFAULT_THRESHOLD_PERCENT,
+      .min_time_nsec = (uint64_t)DEFAULT_MIN_TIME_MSEC * 1000000,
+      .json = false,
+  };
+  const struct zms_micro_benchmark* benchmark;
+  struct baseline_entry* baseline;
+  struct wl_array baseline_entries;
+  struct result result;
+  char runtime_dir[] = "/tmp/zmonitors-micro-XXXXXX";
+  int regression_count = 0, exit_code = EXIT_FAILURE;
+
+  wl_array_init(&baseline_entries);
+
+  if (parse_options(argc, argv, &options) == false) goto out;
+
+  if (options.baseline &&
+      load_baseline(options.baseline, &baseline_entries) == false)
+    goto out;
+
+  // zms_compositor_create adds a socket, which no one connects to
+  if (mkdtemp(runtime_dir) == NULL) {
+    zms_log("failed to create a runtime dir\n");
+    goto out;
+  }
+  setenv("XDG_RUNTIME_DIR", runtime_dir, 1);
+
+  for (int i = 0; benchmark_groups[i]; i++) {
+    for (benchmark = benchmark_groups[i]; benchmark->name; benchmark++) {
+      if (options.filter && strstr(benchmark->name, options.filter) == NULL)
+        continue;
+
+      if (run_benchmark(benchmark, &options, &result) == false)
+        goto out_runtime_dir;
+
+      baseline = find_baseline(&baseline_entries, benchmark->name);
+      print_result(benchmark->name, &result, baseline, options.json);
+
+      if (is_regression(&result, baseline, options.threshold_percent)) {
+        zms_log("%s regressed: %.1f ns/op, baseline %.1f ns/op\n",
+            benchmark->name, result.ns_per_op, baseline->ns_per_op);
+        regression_count++;
+      }
+    }
+  }
+
+  if (regression_count > 0) {
+    zms_log("%d benchmarks regressed by more than %.0f%%\n", regression_count,
+        options.threshold_percent);
+    goto out_runtime_dir;
+  }
+
+  exit_code = EXIT_SUCCESS;
+
+out_runtime_dir:
+  rmdir(runtime_dir);
+
+out:
+  wl_array_release(&baseline_entries);
+
+  return exit_code;
+}
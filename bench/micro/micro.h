@@ -0,0 +1,29 @@
+#ifndef ZMONITORS_BENCH_MICRO_MICRO_H
+#define ZMONITORS_BENCH_MICRO_MICRO_H
+
+#include <stdint.h>
+#include <zmonitors-util.h>
+
+struct zms_micro_benchmark {
+  const char* name;
+  void* (*setup)(void); /* nullable; returns NULL on failure */
+  void (*run)(void* data, uint64_t iterations);
+  void (*teardown)(void* data); /* nullable */
+};
+
+// NULL-name terminated
+extern const struct zms_micro_benchmark zms_micro_server_benchmarks[];
+extern const struct zms_micro_benchmark zms_micro_util_benchmarks[];
+extern const struct zms_micro_benchmark zms_micro_intersect_benchmarks[];
+
+/* Deterministic, so that every run does the same */
+uint32_t zms_micro_random(uint32_t* state);
+
+/* Keep the compiler from dropping a computation whose result is unused */
+static inline void
+zms_micro_do_not_optimize(void* value)
+{
+  __asm__ volatile("" : : "g"(value) : "memory");
+}
+
+#endif  //  ZMONITORS_BENCH_MICRO_MICRO_H
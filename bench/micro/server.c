@@ -0,0 +1,267 @@
+#include "compositor.h"
+#include "micro.h"
+#include "output.h"
+#include "pixman-helper.h"
+#include "view.h"
+
+#define OUTPUT_WIDTH 1920
+#define OUTPUT_HEIGHT 1080
+#define MAX_VIEW_COUNT 256
+#define DAMAGE_SIZE 64
+// output damage is cleared every this many zms_output_render
+#define RENDERS_PER_FRAME 64
+
+struct output_bench {
+  struct zms_compositor* compositor;
+  struct zms_output* output;
+  struct zms_view* views[MAX_VIEW_COUNT];
+  int view_count;
+  uint32_t random_state;
+};
+
+static void
+output_bench_schedule_repaint(void* user_data, struct zms_output* output)
+{
+  Z_UNUSED(user_data);
+  Z_UNUSED(output);
+}
+
+static const struct zms_output_interface output_interface = {
+    .schedule_repaint = output_bench_schedule_repaint,
+};
+
+/* Not backed by a client; the surface is only used on commit and frame,
+ * which are not benchmarked here. */
+static struct zms_view*
+output_bench_create_view(struct output_bench* bench)
+{
+  struct zms_view* view;
+  int32_t width = 128 + zms_micro_random(&bench->random_state) % 512;
+  int32_t height = 96 + zms_micro_random(&bench->random_state) % 384;
+
+  view = zms_view_create(NULL);
+  if (view == NULL) return NULL;
+
+  view->priv->image =
+      pixman_image_create_bits(PIXMAN_x8r8g8b8, width, height, NULL, 0);
+  if (view->priv->image == NULL) {
+    zms_view_destroy(view);
+    return NULL;
+  }
+
+  zms_view_set_origin(view,
+      zms_micro_random(&bench->random_state) % (OUTPUT_WIDTH - width),
+      zms_micro_random(&bench->random_state) % (OUTPUT_HEIGHT - height));
+
+  return view;
+}
+
+static void output_bench_teardown(void* data);
+
+static struct output_bench*
+output_bench_create(int view_count, int pixel_buffer_count)
+{
+  struct output_bench* bench;
+  struct zms_screen_size size = {OUTPUT_WIDTH, OUTPUT_HEIGHT};
+  vec2 physical_size = {0.6, 0.34};
+
+  bench = zalloc(sizeof *bench);
+  if (bench == NULL) return NULL;
+
+  bench->random_state = 2463534242;
+
+  bench->compositor = zms_compositor_create();
+  if (bench->compositor == NULL) goto err;
+
+  bench->output = zms_output_create(bench->compositor, size, physical_size,
+      "zmonitors", "micro", pixel_buffer_count);
+  if (bench->output == NULL) goto err;
+  zms_output_set_implementation(bench->output, NULL, &output_interface);
+
+  for (int i = 0; i < view_count; i++) {
+    bench->views[i] = output_bench_create_view(bench);
+    if (bench->views[i] == NULL) goto err;
+    bench->view_count++;
+    zms_output_map_view(
+        bench->output, bench->views[i], ZMS_OUTPUT_MAIN_LAYER_INDEX);
+  }
+
+  // start from a clean frame
+  zms_output_repaint(bench->output);
+  zms_output_repaint(bench->output);
+
+  return bench;
+
+err:
+  output_bench_teardown(bench);
+  return NULL;
+}
+
+static void
+output_bench_teardown(void* data)
+{
+  struct output_bench* bench = data;
+
+  for (int i = 0; i < bench->view_count; i++)
+    zms_view_destroy(bench->views[i]);
+  if (bench->output) zms_output_destroy(bench->output);
+  if (bench->compositor) zms_compositor_destroy(bench->compositor);
+  free(bench);
+}
+
+static void
+output_bench_damage_random_rect(struct output_bench* bench, int32_t size)
+{
+  pixman_region32_t damage;
+
+  pixman_region32_init_rect(&damage,
+      zms_micro_random(&bench->random_state) % (OUTPUT_WIDTH - size),
+      zms_micro_random(&bench->random_state) % (OUTPUT_HEIGHT - size), size,
+      size);
+  zms_output_render(bench->output, &damage);
+  pixman_region32_fini(&damage);
+}
+
+static void*
+output_render_setup(void)
+{
+  return output_bench_create(16, 2);
+}
+
+/* Damage accumulated by commits within a frame */
+static void
+output_render_run(void* data, uint64_t iterations)
+{
+  struct output_bench* bench = data;
+
+  for (uint64_t i = 0; i < iterations; i++) {
+    output_bench_damage_random_rect(bench, DAMAGE_SIZE);
+    if (i % RENDERS_PER_FRAME == RENDERS_PER_FRAME - 1)
+      pixman_region32_clear(&bench->output->priv->damage);
+  }
+}
+
+static void*
+output_repaint_16_views_setup(void)
+{
+  return output_bench_create(16, 2);
+}
+
+static void*
+output_repaint_256_views_setup(void)
+{
+  return output_bench_create(256, 2);
+}
+
+/* A small damage composited over overlapping views */
+static void
+output_repaint_small_run(void* data, uint64_t iterations)
+{
+  struct output_bench* bench = data;
+
+  for (uint64_t i = 0; i < iterations; i++) {
+    output_bench_damage_random_rect(bench, DAMAGE_SIZE * 4);
+    zms_output_repaint(bench->output);
+  }
+}
+
+static void
+output_repaint_full_run(void* data, uint64_t iterations)
+{
+  struct output_bench* bench = data;
+  pixman_region32_t damage;
+
+  pixman_region32_init_rect(&damage, 0, 0, OUTPUT_WIDTH, OUTPUT_HEIGHT);
+  for (uint64_t i = 0; i < iterations; i++) {
+    zms_output_render(bench->output, &damage);
+    zms_output_repaint(bench->output);
+  }
+  pixman_region32_fini(&damage);
+}
+
+static void*
+output_repaint_catch_up_setup(void)
+{
+  return output_bench_create(16, 4);
+}
+
+/* With 4 buffers, each repaint first copies the damage of the 3 frames the
+ * back buffer missed, as zms_output_buffer_ring_rotate used to */
+static void
+output_repaint_catch_up_run(void* data, uint64_t iterations)
+{
+  output_repaint_small_run(data, iterations);
+}
+
+static void*
+region_setup(void)
+{
+  return output_bench_create(64, 2);
+}
+
+/* Regions of views unioned as on map, unmap and move */
+static void
+region_union_views_run(void* data, uint64_t iterations)
+{
+  struct output_bench* bench = data;
+  pixman_region32_t region, view_region;
+
+  for (uint64_t i = 0; i < iterations; i++) {
+    pixman_region32_init(&region);
+    for (int j = 0; j < bench->view_count; j++) {
+      pixman_region32_init_view_global(&view_region, bench->views[j]);
+      pixman_region32_union(&region, &region, &view_region);
+      pixman_region32_fini(&view_region);
+    }
+    zms_micro_do_not_optimize(&region);
+    pixman_region32_fini(&region);
+  }
+}
+
+/* Clips of views against a scattered damage, as in a repaint */
+static void
+region_intersect_damage_run(void* data, uint64_t iterations)
+{
+  struct output_bench* bench = data;
+  pixman_region32_t damage, clip, view_region;
+
+  pixman_region32_init(&damage);
+  for (int j = 0; j < 16; j++) {
+    pixman_region32_union_rect(&damage, &damage,
+        zms_micro_random(&bench->random_state) % (OUTPUT_WIDTH - DAMAGE_SIZE),
+        zms_micro_random(&bench->random_state) % (OUTPUT_HEIGHT - DAMAGE_SIZE),
+        DAMAGE_SIZE, DAMAGE_SIZE);
+  }
+
+  pixman_region32_init(&clip);
+  for (uint64_t i = 0; i < iterations; i++) {
+    for (int j = 0; j < bench->view_count; j++) {
+      pixman_region32_init_view_global(&view_region, bench->views[j]);
+      pixman_region32_intersect(&clip, &damage, &view_region);
+      pixman_region32_subtract(&damage, &damage, &clip);
+      pixman_region32_union(&damage, &damage, &clip);
+      pixman_region32_fini(&view_region);
+    }
+  }
+  zms_micro_do_not_optimize(&clip);
+  pixman_region32_fini(&clip);
+  pixman_region32_fini(&damage);
+}
+
+const struct zms_micro_benchmark zms_micro_server_benchmarks[] = {
+    {"output_render_64x64", output_render_setup, output_render_run,
+        output_bench_teardown},
+    {"output_repaint_256x256_16_views", output_repaint_16_views_setup,
+        output_repaint_small_run, output_bench_teardown},
+    {"output_repaint_256x256_256_views", output_repaint_256_views_setup,
+        output_repaint_small_run, output_bench_teardown},
+    {"output_repaint_full_16_views", output_repaint_16_views_setup,
+        output_repaint_full_run, output_bench_teardown},
+    {"output_repaint_catch_up_4_buffers", output_repaint_catch_up_setup,
+        output_repaint_catch_up_run, output_bench_teardown},
+    {"region_union_64_views", region_setup, region_union_views_run,
+        output_bench_teardown},
+    {"region_intersect_64_views", region_setup, region_intersect_damage_run,
+        output_bench_teardown},
+    {NULL, NULL, NULL, NULL},
+};
@@ -0,0 +1,103 @@
+#include "micro.h"
+
+#define LISTENER_COUNT 8
+#define WEAK_REF_COUNT 64
+
+struct signal_bench {
+  struct zms_signal signal;
+  struct zms_listener listeners[LISTENER_COUNT];
+  uint64_t notified;
+};
+
+static void
+signal_bench_notify(struct zms_listener* listener, void* data)
+{
+  Z_UNUSED(listener);
+  struct signal_bench* bench = data;
+
+  bench->notified++;
+}
+
+static void*
+signal_emit_setup(void)
+{
+  struct signal_bench* bench = zalloc(sizeof *bench);
+
+  if (bench == NULL) return NULL;
+
+  zms_signal_init(&bench->signal);
+  for (int i = 0; i < LISTENER_COUNT; i++) {
+    bench->listeners[i].notify = signal_bench_notify;
+    zms_signal_add(&bench->signal, &bench->listeners[i]);
+  }
+
+  return bench;
+}
+
+static void
+signal_emit_run(void* data, uint64_t iterations)
+{
+  struct signal_bench* bench = data;
+
+  for (uint64_t i = 0; i < iterations; i++)
+    zms_signal_emit(&bench->signal, bench);
+
+  zms_micro_do_not_optimize(&bench->notified);
+}
+
+struct weak_ref_bench {
+  struct zms_signal destroy_signals[2];
+  struct zms_weak_ref refs[WEAK_REF_COUNT];
+};
+
+static void*
+weak_ref_setup(void)
+{
+  struct weak_ref_bench* bench = zalloc(sizeof *bench);
+
+  if (bench == NULL) return NULL;
+
+  zms_signal_init(&bench->destroy_signals[0]);
+  zms_signal_init(&bench->destroy_signals[1]);
+  for (int i = 0; i < WEAK_REF_COUNT; i++) zms_weak_ref_init(&bench->refs[i]);
+
+  return bench;
+}
+
+/* As focus changes: every ref moves to the other object, and the objects are
+ * destroyed now and then, clearing all refs at once */
+static void
+weak_ref_churn_run(void* data, uint64_t iterations)
+{
+  struct weak_ref_bench* bench = data;
+  int target;
+
+  for (uint64_t i = 0; i < iterations; i++) {
+    target = i & 1;
+    if (i % WEAK_REF_COUNT == WEAK_REF_COUNT - 1) {
+      zms_signal_emit(&bench->destroy_signals[target], NULL);
+      continue;
+    }
+    zms_weak_reference(&bench->refs[i % WEAK_REF_COUNT],
+        &bench->destroy_signals[target], &bench->destroy_signals[target]);
+  }
+
+  zms_micro_do_not_optimize(bench->refs);
+}
+
+static void
+weak_ref_teardown(void* data)
+{
+  struct weak_ref_bench* bench = data;
+
+  for (int i = 0; i < WEAK_REF_COUNT; i++)
+    zms_weak_reference(&bench->refs[i], NULL, NULL);
+
+  free(bench);
+}
+
+const struct zms_micro_benchmark zms_micro_util_benchmarks[] = {
+    {"signal_emit_8_listeners", signal_emit_setup, signal_emit_run, free},
+    {"weak_ref_churn", weak_ref_setup, weak_ref_churn_run, weak_ref_teardown},
+    {NULL, NULL, NULL, NULL},
+};
@@ -0,0 +1,455 @@
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "stress.h"
+
+#define DAMAGE_SIZE 16
+
+static const struct {
+  int32_t width, height;
+} window_sizes[ZMS_STRESS_WINDOW_SIZE_COUNT] = {
+    {64, 48},
+    {128, 96},
+    {256, 192},
+    {400, 300},
+    {640, 480},
+};
+
+static void
+zms_stress_wm_base_ping(
+    void* data, struct xdg_wm_base* wm_base, uint32_t serial)
+{
+  Z_UNUSED(data);
+  xdg_wm_base_pong(wm_base, serial);
+}
+
+static const struct xdg_wm_base_listener wm_base_listener = {
+    .ping = zms_stress_wm_base_ping,
+};
+
+static void
+zms_stress_pointer_enter(void* data, struct wl_pointer* pointer,
+    uint32_t serial, struct wl_surface* surface, wl_fixed_t x, wl_fixed_t y)
+{
+  Z_UNUSED(pointer);
+  Z_UNUSED(surface);
+  Z_UNUSED(x);
+  Z_UNUSED(y);
+  struct zms_stress_client* client = data;
+
+  client->has_pointer_focus = true;
+  client->cursor_set = false;
+  client->enter_serial = serial;
+}
+
+static void
+zms_stress_pointer_leave(void* data, struct wl_pointer* pointer,
+    uint32_t serial, struct wl_surface* surface)
+{
+  Z_UNUSED(pointer);
+  Z_UNUSED(serial);
+  Z_UNUSED(surface);
+  struct zms_stress_client* client = data;
+
+  client->has_pointer_focus = false;
+}
+
+static void
+zms_stress_pointer_motion(void* data, struct wl_pointer* pointer,
+    uint32_t time, wl_fixed_t x, wl_fixed_t y)
+{
+  Z_UNUSED(data);
+  Z_UNUSED(pointer);
+  Z_UNUSED(time);
+  Z_UNUSED(x);
+  Z_UNUSED(y);
+}
+
+static void
+zms_stress_pointer_button(void* data, struct wl_pointer* pointer,
+    uint32_t serial, uint32_t time, uint32_t button, uint32_t state)
+{
+  Z_UNUSED(data);
+  Z_UNUSED(pointer);
+  Z_UNUSED(serial);
+  Z_UNUSED(time);
+  Z_UNUSED(button);
+  Z_UNUSED(state);
+}
+
+static void
+zms_stress_pointer_axis(void* data, struct wl_pointer* pointer, uint32_t time,
+    uint32_t axis, wl_fixed_t value)
+{
+  Z_UNUSED(data);
+  Z_UNUSED(pointer);
+  Z_UNUSED(time);
+  Z_UNUSED(axis);
+  Z_UNUSED(value);
+}
+
+static const struct wl_pointer_listener pointer_listener = {
+    .enter = zms_stress_pointer_enter,
+    .leave = zms_stress_pointer_leave,
+    .motion = zms_stress_pointer_motion,
+    .button = zms_stress_pointer_button,
+    .axis = zms_stress_pointer_axis,
+};
+
+static void
+zms_stress_seat_capabilities(
+    void* data, struct wl_seat* seat, uint32_t capabilities)
+{
+  struct zms_stress_client* client = data;
+
+  if (capabilities & WL_SEAT_CAPABILITY_POINTER && client->pointer == NULL) {
+    client->pointer = wl_seat_get_pointer(seat);
+    wl_pointer_add_listener(client->pointer, &pointer_listener, client);
+  }
+}
+
+static const struct wl_seat_listener seat_listener = {
+    .capabilities = zms_stress_seat_capabilities,
+};
+
+static void
+zms_stress_registry_global(void* data, struct wl_registry* registry,
+    uint32_t name, const char* interface, uint32_t version)
+{
+  Z_UNUSED(version);
+  struct zms_stress_client* client = data;
+
+  if (strcmp(interface, "wl_compositor") == 0) {
+    client->compositor =
+        wl_registry_bind(registry, name, &wl_compositor_interface, 4);
+  } else if (strcmp(interface, "wl_shm") == 0) {
+    client->shm = wl_registry_bind(registry, name, &wl_shm_interface, 1);
+  } else if (strcmp(interface, "xdg_wm_base") == 0) {
+    client->wm_base =
+        wl_registry_bind(registry, name, &xdg_wm_base_interface, 1);
+    xdg_wm_base_add_listener(client->wm_base, &wm_base_listener, client);
+  } else if (strcmp(interface, "wl_seat") == 0) {
+    client->seat = wl_registry_bind(registry, name, &wl_seat_interface, 1);
+    wl_seat_add_listener(client->seat, &seat_listener, client);
+  }
+}
+
+static void
+zms_stress_registry_global_remove(
+    void* data, struct wl_registry* registry, uint32_t name)
+{
+  Z_UNUSED(data);
+  Z_UNUSED(registry);
+  Z_UNUSED(name);
+}
+
+static const struct wl_registry_listener registry_listener = {
+    .global = zms_stress_registry_global,
+    .global_remove = zms_stress_registry_global_remove,
+};
+
+static void
+zms_stress_buffer_init(struct zms_stress_buffer* buffer,
+    struct wl_shm_pool* pool, size_t* offset, int32_t width, int32_t height)
+{
+  buffer->width = width;
+  buffer->height = height;
+  buffer->proxy = wl_shm_pool_create_buffer(pool, *offset, width, height,
+      width * sizeof(uint32_t), WL_SHM_FORMAT_XRGB8888);
+  *offset += (size_t)width * height * sizeof(uint32_t);
+}
+
+static bool
+zms_stress_client_create_buffers(struct zms_stress_client* client)
+{
+  struct wl_shm_pool* pool;
+  size_t offset = 0;
+
+  client->pool_size = 0;
+  for (int i = 0; i < ZMS_STRESS_WINDOW_SIZE_COUNT; i++)
+    client->pool_size += window_sizes[i].width * window_sizes[i].height;
+  client->pool_size += ZMS_STRESS_POPUP_WIDTH * ZMS_STRESS_POPUP_HEIGHT;
+  client->pool_size += ZMS_STRESS_CURSOR_SIZE * ZMS_STRESS_CURSOR_SIZE * 2;
+  client->pool_size *= sizeof(uint32_t);
+
+  client->pool_fd =
+      zms_util_create_shared_fd(client->pool_size, "zmonitors-stress");
+  if (client->pool_fd < 0) return false;
+
+  // the content is never looked at; every pixel is a mid gray
+  client->pool_data = mmap(NULL, client->pool_size, PROT_READ | PROT_WRITE,
+      MAP_SHARED, client->pool_fd, 0);
+  if (client->pool_data == MAP_FAILED) {
+    close(client->pool_fd);
+    return false;
+  }
+  memset(client->pool_data, 0x80, client->pool_size);
+
+  pool = wl_shm_create_pool(client->shm, client->pool_fd, client->pool_size);
+
+  for (int i = 0; i < ZMS_STRESS_WINDOW_SIZE_COUNT; i++) {
+    zms_stress_buffer_init(&client->window_buffers[i], pool, &offset,
+        window_sizes[i].width, window_sizes[i].height);
+  }
+  zms_stress_buffer_init(&client->popup_buffer, pool, &offset,
+      ZMS_STRESS_POPUP_WIDTH, ZMS_STRESS_POPUP_HEIGHT);
+  for (int i = 0; i < 2; i++) {
+    zms_stress_buffer_init(&client->cursor_buffers[i], pool, &offset,
+        ZMS_STRESS_CURSOR_SIZE, ZMS_STRESS_CURSOR_SIZE);
+  }
+
+  wl_shm_pool_destroy(pool);
+
+  return true;
+}
+
+ZMS_EXPORT struct zms_stress_client*
+zms_stress_client_create(struct zms_stress* stress)
+{
+  struct zms_stress_client* client;
+  int fds[2];
+
+  client = zalloc(sizeof *client);
+  if (client == NULL) goto err;
+
+  if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) == -1) {
+    zms_log("failed to create a socket pair\n");
+    goto err_socket;
+  }
+
+  if (wl_client_create(stress->compositor->display, fds[0]) == NULL) {
+    zms_log("failed to create a client\n");
+    close(fds[0]);
+    close(fds[1]);
+    goto err_socket;
+  }
+
+  client->display = wl_display_connect_to_fd(fds[1]);
+  if (client->display == NULL) {
+    zms_log("failed to connect\n");
+    close(fds[1]);
+    goto err_socket;
+  }
+
+  client->stress = stress;
+  wl_list_init(&client->window_list);
+  wl_list_insert(stress->client_list.prev, &client->link);
+
+  client->registry = wl_display_get_registry(client->display);
+  wl_registry_add_listener(client->registry, &registry_listener, client);
+
+  // globals, then the seat capabilities
+  if (!zms_stress_roundtrip(stress) || !zms_stress_roundtrip(stress))
+    goto err_globals;
+
+  if (!client->compositor || !client->shm || !client->wm_base ||
+      !client->seat) {
+    zms_log("the server lacks required globals\n");
+    goto err_globals;
+  }
+
+  if (zms_stress_client_create_buffers(client) == false) {
+    zms_log("failed to create buffers\n");
+    goto err_globals;
+  }
+
+  client->cursor_surface = wl_compositor_create_surface(client->compositor);
+
+  return client;
+
+err_globals:
+  wl_list_remove(&client->link);
+  wl_display_disconnect(client->display);
+
+err_socket:
+  free(client);
+
+err:
+  return NULL;
+}
+
+ZMS_EXPORT void
+zms_stress_client_destroy(struct zms_stress_client* client)
+{
+  struct zms_stress_window *window, *tmp;
+
+  wl_list_for_each_safe(window, tmp, &client->window_list, link)
+  {
+    wl_list_remove(&window->link);
+    free(window);
+  }
+
+  wl_list_remove(&client->link);
+  // the server cleans up the resources of the closed connection
+  wl_display_disconnect(client->display);
+  munmap(client->pool_data, client->pool_size);
+  close(client->pool_fd);
+  free(client);
+}
+
+static void
+zms_stress_xdg_surface_configure(
+    void* data, struct xdg_surface* xdg_surface, uint32_t serial)
+{
+  struct zms_stress_window* window = data;
+
+  xdg_surface_ack_configure(xdg_surface, serial);
+  window->configured = true;
+}
+
+static const struct xdg_surface_listener xdg_surface_listener = {
+    .configure = zms_stress_xdg_surface_configure,
+};
+
+static void
+zms_stress_toplevel_configure(void* data, struct xdg_toplevel* toplevel,
+    int32_t width, int32_t height, struct wl_array* states)
+{
+  Z_UNUSED(data);
+  Z_UNUSED(toplevel);
+  Z_UNUSED(width);
+  Z_UNUSED(height);
+  Z_UNUSED(states);
+}
+
+static void
+zms_stress_toplevel_close(void* data, struct xdg_toplevel* toplevel)
+{
+  Z_UNUSED(data);
+  Z_UNUSED(toplevel);
+}
+
+static const struct xdg_toplevel_listener toplevel_listener = {
+    .configure = zms_stress_toplevel_configure,
+    .close = zms_stress_toplevel_close,
+};
+
+static void
+zms_stress_popup_configure(void* data, struct xdg_popup* popup, int32_t x,
+    int32_t y, int32_t width, int32_t height)
+{
+  Z_UNUSED(data);
+  Z_UNUSED(popup);
+  Z_UNUSED(x);
+  Z_UNUSED(y);
+  Z_UNUSED(width);
+  Z_UNUSED(height);
+}
+
+static void
+zms_stress_popup_done(void* data, struct xdg_popup* popup)
+{
+  Z_UNUSED(data);
+  Z_UNUSED(popup);
+}
+
+static const struct xdg_popup_listener popup_listener = {
+    .configure = zms_stress_popup_configure,
+    .popup_done = zms_stress_popup_done,
+};
+
+ZMS_EXPORT struct zms_stress_window*
+zms_stress_window_create(struct zms_stress_client* client,
+    struct zms_stress_window* parent, uint32_t size_index)
+{
+  struct zms_stress_window* window;
+  struct xdg_positioner* positioner;
+
+  window = zalloc(sizeof *window);
+  if (window == NULL) return NULL;
+
+  window->client = client;
+  window->surface = wl_compositor_create_surface(client->compositor);
+  window->xdg_surface =
+      xdg_wm_base_get_xdg_surface(client->wm_base, window->surface);
+  xdg_surface_add_listener(window->xdg_surface, &xdg_surface_listener, window);
+
+  if (parent) {
+    positioner = xdg_wm_base_create_positioner(client->wm_base);
+    xdg_positioner_set_size(
+        positioner, ZMS_STRESS_POPUP_WIDTH, ZMS_STRESS_POPUP_HEIGHT);
+    xdg_positioner_set_anchor_rect(positioner, 0, 0, 1, 1);
+    window->popup = xdg_surface_get_popup(
+        window->xdg_surface, parent->xdg_surface, positioner);
+    xdg_popup_add_listener(window->popup, &popup_listener, window);
+    xdg_positioner_destroy(positioner);
+    window->buffer = &client->popup_buffer;
+  } else {
+    window->toplevel = xdg_surface_get_toplevel(window->xdg_surface);
+    xdg_toplevel_add_listener(window->toplevel, &toplevel_listener, window);
+    window->buffer =
+        &client->window_buffers[size_index % ZMS_STRESS_WINDOW_SIZE_COUNT];
+  }
+
+  wl_surface_commit(window->surface);
+  wl_list_insert(client->window_list.prev, &window->link);
+
+  return window;
+}
+
+ZMS_EXPORT void
+zms_stress_window_map(struct zms_stress_window* window)
+{
+  if (window->configured == false || window->mapped) return;
+
+  wl_surface_attach(window->surface, window->buffer->proxy, 0, 0);
+  wl_surface_damage_buffer(
+      window->surface, 0, 0, window->buffer->width, window->buffer->height);
+  wl_surface_commit(window->surface);
+  window->mapped = true;
+}
+
+static void
+zms_stress_frame_done(void* data, struct wl_callback* callback, uint32_t time)
+{
+  Z_UNUSED(time);
+  struct zms_stress_window* window = data;
+
+  window->pending_frames--;
+  wl_callback_destroy(callback);
+}
+
+static const struct wl_callback_listener frame_listener = {
+    .done = zms_stress_frame_done,
+};
+
+ZMS_EXPORT void
+zms_stress_window_commit(
+    struct zms_stress_window* window, int32_t x, int32_t y, bool frame)
+{
+  struct wl_callback* callback;
+
+  if (frame) {
+    callback = wl_surface_frame(window->surface);
+    wl_callback_add_listener(callback, &frame_listener, window);
+    window->pending_frames++;
+  }
+
+  x %= MAX(window->buffer->width - DAMAGE_SIZE, 1);
+  y %= MAX(window->buffer->height - DAMAGE_SIZE, 1);
+
+  wl_surface_attach(window->surface, window->buffer->proxy, 0, 0);
+  wl_surface_damage_buffer(window->surface, x, y, DAMAGE_SIZE, DAMAGE_SIZE);
+  wl_surface_commit(window->surface);
+}
+
+ZMS_EXPORT void
+zms_stress_client_update_cursor(struct zms_stress_client* client, uint32_t seq)
+{
+  struct zms_stress_buffer* buffer = &client->cursor_buffers[seq % 2];
+
+  if (client->has_pointer_focus == false || client->pointer == NULL) return;
+
+  wl_surface_attach(client->cursor_surface, buffer->proxy, 0, 0);
+  wl_surface_damage_buffer(
+      client->cursor_surface, 0, 0, buffer->width, buffer->height);
+  wl_surface_commit(client->cursor_surface);
+
+  if (client->cursor_set) return;
+
+  wl_pointer_set_cursor(
+      client->pointer, client->enter_serial, client->cursor_surface, 0, 0);
+  client->cursor_set = true;
+}
@@ -0,0 +1,471 @@
+#include <errno.h>
+#include <getopt.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "stress.h"
+
+#define OUTPUT_WIDTH 1920
+#define OUTPUT_HEIGHT 1080
+#define FIRST_STEP_WINDOW_COUNT 16
+#define STEP_FACTOR 4
+/* Requests are flushed by a roundtrip every this many windows, so that the
+ * client sockets never fill up while the server is not dispatched. Same for
+ * the pointer events of picks. */
+#define OPERATIONS_PER_ROUNDTRIP 64
+#define FRAME_INTERVAL_MSEC 16
+
+struct options {
+  int max_window_count;
+  int popup_ratio;  // one popup per this many toplevels
+  int pick_count;
+  int cursor_update_count;
+  bool json;
+};
+
+struct step_result {
+  int toplevel_count;
+  int popup_count;
+  double map_usec;        // per toplevel
+  double popup_map_usec;  // per popup
+  double commit_usec;     // per toplevel commit, including its frame request
+  double render_msec;     // per zms_output_repaint
+  double frame_usec;      // per zms_output_frame
+  double pick_usec;       // per pointer motion
+  double cursor_usec;     // per cursor surface commit
+};
+
+static void
+print_usage(const char* program)
+{
+  fprintf(stderr,
+      "usage: %s [options]\n"
+      "\n"
+      "Map more and more windows on the server library and report the\n"
+      "server side cost of each operation per step.\n"
+      "\n"
+      "  -n, --max-windows=N     stop after N toplevels (default: 4096)\n"
+      "  -p, --popup-ratio=R     one popup per R toplevels (default: 4)\n"
+      "  -k, --picks=N           pointer motions per step (default: 1024)\n"
+      "  -c, --cursor-updates=N  cursor commits per step (default: 128)\n"
+      "  -j, --json              print one JSON object per step\n"
+      "  -h, --help              show this help\n",
+      program);
+}
+
+static bool
+parse_options(int argc, char* argv[], struct options* options)
+{
+  static const struct option long_options[] = {
+      {"max-windows", required_argument, NULL, 'n'},
+      {"popup-ratio", required_argument, NULL, 'p'},
+      {"picks", required_argument, NULL, 'k'},
+      {"cursor-updates", required_argument, NULL, 'c'},
+      {"json", no_argument, NULL, 'j'},
+      {"help", no_argument, NULL, 'h'},
+      {NULL, 0, NULL, 0},
+  };
+  int opt, value;
+
+  while ((opt = getopt_long(argc, argv, "n:p:k:c:jh", long_options, NULL)) !=
+         -1) {
+    if (opt != 'j' && opt != 'h' &&
+        (sscanf(optarg, "%d", &value) != 1 || value < 1)) {
+      zms_log("invalid argument: %s\n", optarg);
+      return false;
+    }
+
+    switch (opt) {
+      case 'n':
+        options->max_window_count = value;
+        break;
+
+      case 'p':
+        options->popup_ratio = value;
+        break;
+
+      case 'k':
+        options->pick_count = value;
+        break;
+
+      case 'c':
+        options->cursor_update_count = value;
+        break;
+
+      case 'j':
+        options->json = true;
+        break;
+
+      case 'h':
+      default:
+        print_usage(argv[0]);
+        return false;
+    }
+  }
+
+  return true;
+}
+
+ZMS_EXPORT uint64_t
+zms_stress_get_time(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+ZMS_EXPORT uint32_t
+zms_stress_random(struct zms_stress* stress, uint32_t max)
+{
+  // xorshift32
+  stress->random_state ^= stress->random_state << 13;
+  stress->random_state ^= stress->random_state >> 17;
+  stress->random_state ^= stress->random_state << 5;
+
+  return stress->random_state % max;
+}
+
+ZMS_EXPORT void
+zms_stress_dispatch_server(struct zms_stress* stress)
+{
+  uint64_t begin = zms_stress_get_time();
+
+  wl_event_loop_dispatch(stress->loop, 0);
+  wl_display_flush_clients(stress->compositor->display);
+
+  stress->server_nsec += zms_stress_get_time() - begin;
+}
+
+static void
+zms_stress_sync_done(void* data, struct wl_callback* callback, uint32_t serial)
+{
+  Z_UNUSED(serial);
+  int* pending = data;
+
+  (*pending)--;
+  wl_callback_destroy(callback);
+}
+
+static const struct wl_callback_listener sync_listener = {
+    .done = zms_stress_sync_done,
+};
+
+/* Read events the server has sent without blocking */
+static bool
+zms_stress_client_read(struct zms_stress_client* client)
+{
+  struct pollfd pfd;
+
+  while (wl_display_prepare_read(client->display) != 0)
+    if (wl_display_dispatch_pending(client->display) == -1) return false;
+
+  pfd.fd = wl_display_get_fd(client->display);
+  pfd.events = POLLIN;
+
+  if (poll(&pfd, 1, 0) == 1) {
+    if (wl_display_read_events(client->display) == -1) return false;
+  } else {
+    wl_display_cancel_read(client->display);
+  }
+
+  return wl_display_dispatch_pending(client->display) != -1;
+}
+
+ZMS_EXPORT bool
+zms_stress_roundtrip(struct zms_stress* stress)
+{
+  struct zms_stress_client* client;
+  struct wl_callback* callback;
+  int pending = 0;
+
+  wl_list_for_each(client, &stress->client_list, link)
+  {
+    callback = wl_display_sync(client->display);
+    wl_callback_add_listener(callback, &sync_listener, &pending);
+    pending++;
+  }
+
+  while (pending > 0) {
+    // a full socket is flushed again on the next iteration
+    wl_list_for_each(client, &stress->client_list, link)
+        wl_display_flush(client->display);
+
+    zms_stress_dispatch_server(stress);
+
+    wl_list_for_each(client, &stress->client_list, link)
+    {
+      if (zms_stress_client_read(client) == false) {
+        zms_log("a client was disconnected: %s\n",
+            strerror(wl_display_get_error(client->display)));
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+static void
+output_schedule_repaint(void* user_data, struct zms_output* output)
+{
+  Z_UNUSED(user_data);
+  Z_UNUSED(output);
+  // repainted explicitly, so that it can be timed
+}
+
+static const struct zms_output_interface output_interface = {
+    .schedule_repaint = output_schedule_repaint,
+};
+
+static struct zms_stress_client*
+pick_client(struct zms_stress* stress, int index)
+{
+  struct zms_stress_client* client;
+
+  wl_list_for_each(client, &stress->client_list, link)
+  {
+    if (index-- == 0) return client;
+  }
+
+  return NULL;
+}
+
+static bool
+map_windows(struct zms_stress* stress, struct zms_stress_window** windows,
+    int begin, int end, struct zms_stress_window** parents, double* usec)
+{
+  uint64_t server_nsec = stress->server_nsec;
+
+  if (begin >= end) {
+    *usec = 0;
+    return true;
+  }
+
+  for (int i = begin; i < end; i++) {
+    windows[i] = zms_stress_window_create(
+        pick_client(stress, i % ZMS_STRESS_CLIENT_COUNT),
+        parents ? parents[i] : NULL, zms_stress_random(stress, UINT32_MAX));
+    if (windows[i] == NULL) return false;
+    if (i % OPERATIONS_PER_ROUNDTRIP == OPERATIONS_PER_ROUNDTRIP - 1 &&
+        zms_stress_roundtrip(stress) == false)
+      return false;
+  }
+
+  // configure, then map
+  if (zms_stress_roundtrip(stress) == false) return false;
+  for (int i = begin; i < end; i++) {
+    zms_stress_window_map(windows[i]);
+    if (i % OPERATIONS_PER_ROUNDTRIP == OPERATIONS_PER_ROUNDTRIP - 1 &&
+        zms_stress_roundtrip(stress) == false)
+      return false;
+  }
+  if (zms_stress_roundtrip(stress) == false) return false;
+
+  *usec = (stress->server_nsec - server_nsec) / 1e3 / (end - begin);
+
+  return true;
+}
+
+static bool
+run_step(struct zms_stress* stress, struct options* options,
+    struct zms_stress_window** toplevels, struct zms_stress_window** popups,
+    struct zms_stress_window** popup_parents, int previous_count,
+    struct step_result* result, uint32_t* time)
+{
+  int toplevel_count = result->toplevel_count;
+  int previous_popup_count = previous_count / options->popup_ratio;
+  int popup_count = toplevel_count / options->popup_ratio;
+  struct zms_stress_client* focus = NULL;
+  uint64_t server_nsec, begin, pick_nsec = 0;
+  vec2 position;
+
+  result->popup_count = popup_count;
+
+  if (!map_windows(stress, toplevels, previous_count, toplevel_count, NULL,
+          &result->map_usec))
+    return false;
+
+  for (int i = previous_popup_count; i < popup_count; i++)
+    popup_parents[i] = toplevels[i * options->popup_ratio];
+  if (!map_windows(stress, popups, previous_popup_count, popup_count,
+          popup_parents, &result->popup_map_usec))
+    return false;
+
+  // composite everything mapped so far, so only the commits below are drawn
+  zms_output_repaint(stress->output);
+
+  server_nsec = stress->server_nsec;
+  for (int i = 0; i < toplevel_count; i++) {
+    zms_stress_window_commit(toplevels[i], zms_stress_random(stress, 1024),
+        zms_stress_random(stress, 1024), true);
+    if (i % OPERATIONS_PER_ROUNDTRIP == OPERATIONS_PER_ROUNDTRIP - 1 &&
+        zms_stress_roundtrip(stress) == false)
+      return false;
+  }
+  if (zms_stress_roundtrip(stress) == false) return false;
+  result->commit_usec =
+      (stress->server_nsec - server_nsec) / 1e3 / toplevel_count;
+
+  begin = zms_stress_get_time();
+  zms_output_repaint(stress->output);
+  result->render_msec = (zms_stress_get_time() - begin) / 1e6;
+
+  *time += FRAME_INTERVAL_MSEC;
+  begin = zms_stress_get_time();
+  zms_output_frame(stress->output, *time, true);
+  result->frame_usec = (zms_stress_get_time() - begin) / 1e3;
+  if (zms_stress_roundtrip(stress) == false) return false;
+
+  for (int i = 0; i < options->pick_count; i++) {
+    position[0] = zms_stress_random(stress, OUTPUT_WIDTH);
+    position[1] = zms_stress_random(stress, OUTPUT_HEIGHT);
+    // the last one is on the center, where every window overlaps
+    if (i == options->pick_count - 1) {
+      position[0] = OUTPUT_WIDTH / 2;
+      position[1] = OUTPUT_HEIGHT / 2;
+    }
+
+    begin = zms_stress_get_time();
+    zms_seat_notify_pointer_motion_abs(
+        stress->compositor->seat, stress->output, position, *time);
+    pick_nsec += zms_stress_get_time() - begin;
+
+    if (i % OPERATIONS_PER_ROUNDTRIP == OPERATIONS_PER_ROUNDTRIP - 1 &&
+        zms_stress_roundtrip(stress) == false)
+      return false;
+  }
+  if (zms_stress_roundtrip(stress) == false) return false;
+  result->pick_usec = pick_nsec / 1e3 / options->pick_count;
+
+  wl_list_for_each(focus, &stress->client_list, link)
+  {
+    if (focus->has_pointer_focus) break;
+  }
+
+  result->cursor_usec = 0;
+  if (&focus->link != &stress->client_list) {
+    server_nsec = stress->server_nsec;
+    for (int i = 0; i < options->cursor_update_count; i++)
+      zms_stress_client_update_cursor(focus, i);
+    if (zms_stress_roundtrip(stress) == false) return false;
+    result->cursor_usec = (stress->server_nsec - server_nsec) / 1e3 /
+                          options->cursor_update_count;
+  }
+
+  return true;
+}
+
+static void
+print_result(struct step_result* result, bool json)
+{
+  if (json) {
+    printf(
+        "{\"toplevels\": %d, \"popups\": %d, \"map_us\": %.2f, "
+        "\"popup_map_us\": %.2f, \"commit_us\": %.2f, \"render_ms\": %.3f, "
+        "\"frame_us\": %.2f, \"pick_us\": %.2f, \"cursor_us\": %.2f}\n",
+        result->toplevel_count, result->popup_count, result->map_usec,
+        result->popup_map_usec, result->commit_usec, result->render_msec,
+        result->frame_usec, result->pick_usec, result->cursor_usec);
+  } else {
+    printf("%9d %7d %9.2f %9.2f %9.2f %9.3f %9.2f %9.2f %9.2f\n",
+        result->toplevel_count, result->popup_count, result->map_usec,
+        result->popup_map_usec, result->commit_usec, result->render_msec,
+        result->frame_usec, result->pick_usec, result->cursor_usec);
+  }
+  fflush(stdout);
+}
+
+int
+main(int argc, char* argv[])
+{
+  struct options options = {
+      .max_window_count = 4096,
+      .popup_ratio = 4,
+      .pick_count = 1024,
+      .cursor_update_count = 128,
+      .json = false,
+  };
+  struct zms_stress stress = {0};
+  struct zms_stress_client *client, *tmp;
+  struct zms_stress_window **toplevels = NULL, **popups = NULL;
+  struct zms_stress_window** popup_parents = NULL;
+  struct zms_screen_size size = {OUTPUT_WIDTH, OUTPUT_HEIGHT};
+  struct step_result result;
+  char runtime_dir[] = "/tmp/zmonitors-stress-XXXXXX";
+  vec2 physical_size = {0.6, 0.34};
+  uint32_t time = 0;
+  int previous_count = 0, exit_code = EXIT_FAILURE;
+
+  if (parse_options(argc, argv, &options) == false) goto out;
+
+  // zms_compositor_create adds a socket, which no one connects to
+  if (mkdtemp(runtime_dir) == NULL) {
+    zms_log("failed to create a runtime dir\n");
+    goto out;
+  }
+  setenv("XDG_RUNTIME_DIR", runtime_dir, 1);
+
+  stress.random_state = 2463534242;
+  wl_list_init(&stress.client_list);
+
+  stress.compositor = zms_compositor_create();
+  if (stress.compositor == NULL) goto out_runtime_dir;
+  stress.loop = wl_display_get_event_loop(stress.compositor->display);
+
+  stress.output = zms_output_create(
+      stress.compositor, size, physical_size, "zmonitors", "stress", 2);
+  if (stress.output == NULL) goto out_compositor;
+  zms_output_set_implementation(stress.output, NULL, &output_interface);
+  zms_seat_init_pointer(stress.compositor->seat);
+
+  for (int i = 0; i < ZMS_STRESS_CLIENT_COUNT; i++)
+    if (zms_stress_client_create(&stress) == NULL) goto out_clients;
+
+  toplevels = calloc(options.max_window_count, sizeof *toplevels);
+  popups = calloc(options.max_window_count, sizeof *popups);
+  popup_parents = calloc(options.max_window_count, sizeof *popup_parents);
+  if (!toplevels || !popups || !popup_parents) goto out_clients;
+
+  if (options.json == false) {
+    printf("%9s %7s %9s %9s %9s %9s %9s %9s %9s\n", "toplevels", "popups",
+        "map_us", "popup_us", "commit_us", "render_ms", "frame_us", "pick_us",
+        "cursor_us");
+  }
+
+  for (int count = FIRST_STEP_WINDOW_COUNT;; count *= STEP_FACTOR) {
+    result.toplevel_count = MIN(count, options.max_window_count);
+    if (!run_step(&stress, &options, toplevels, popups, popup_parents,
+            previous_count, &result, &time))
+      goto out_clients;
+    print_result(&result, options.json);
+
+    previous_count = result.toplevel_count;
+    if (previous_count == options.max_window_count) break;
+  }
+
+  exit_code = EXIT_SUCCESS;
+
+out_clients:
+  wl_list_for_each_safe(client, tmp, &stress.client_list, link)
+      zms_stress_client_destroy(client);
+  // let the server destroy the resources of the closed connections
+  zms_stress_dispatch_server(&stress);
+  free(toplevels);
+  free(popups);
+  free(popup_parents);
+  zms_output_destroy(stress.output);
+
+out_compositor:
+  zms_compositor_destroy(stress.compositor);
+
+out_runtime_dir:
+  rmdir(runtime_dir);
+
+out:
+  return exit_code;
+}
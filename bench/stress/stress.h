@@ -0,0 +1,117 @@
+#ifndef ZMONITORS_BENCH_STRESS_STRESS_H
+#define ZMONITORS_BENCH_STRESS_STRESS_H
+
+#include <stdint.h>
+#include <wayland-client.h>
+#include <xdg-shell-client-protocol.h>
+#include <zmonitors-server.h>
+#include <zmonitors-util.h>
+
+/* Ramps up the number of mapped windows, popups and cursor updates on the
+ * server library, and measures the server side cost of each operation.
+ *
+ * The server and the clients share one thread. Clients are connected over
+ * socket pairs, and the server is dispatched by zms_stress_roundtrip, so the
+ * time spent in the server can be told apart from the clients. */
+
+#define ZMS_STRESS_CLIENT_COUNT 8
+
+// sizes of the shared buffers which windows are drawn with
+#define ZMS_STRESS_WINDOW_SIZE_COUNT 5
+#define ZMS_STRESS_POPUP_WIDTH 64
+#define ZMS_STRESS_POPUP_HEIGHT 48
+#define ZMS_STRESS_CURSOR_SIZE 32
+
+struct zms_stress;
+
+struct zms_stress_buffer {
+  struct wl_buffer* proxy;
+  int32_t width, height;
+};
+
+struct zms_stress_client {
+  struct zms_stress* stress;
+
+  struct wl_display* display;
+  struct wl_registry* registry;
+  struct wl_compositor* compositor;
+  struct wl_shm* shm;
+  struct xdg_wm_base* wm_base;
+  struct wl_seat* seat;
+  struct wl_pointer* pointer;  // nullable
+
+  int pool_fd;
+  void* pool_data;
+  size_t pool_size;
+  // every window of a size is drawn with the same buffer
+  struct zms_stress_buffer window_buffers[ZMS_STRESS_WINDOW_SIZE_COUNT];
+  struct zms_stress_buffer popup_buffer;
+  struct zms_stress_buffer cursor_buffers[2];
+
+  struct wl_surface* cursor_surface;
+  bool has_pointer_focus;
+  bool cursor_set;  // since the last enter
+  uint32_t enter_serial;
+
+  struct wl_list window_list;  // -> zms_stress_window.link
+  struct wl_list link;         // -> zms_stress.client_list
+};
+
+struct zms_stress_window {
+  struct zms_stress_client* client;
+  struct wl_surface* surface;
+  struct xdg_surface* xdg_surface;
+  struct xdg_toplevel* toplevel;  // nullable
+  struct xdg_popup* popup;        // nullable
+  struct zms_stress_buffer* buffer;
+  bool configured;
+  bool mapped;
+  uint32_t pending_frames;  // frame callbacks not done yet
+
+  struct wl_list link;  // -> zms_stress_client.window_list
+};
+
+struct zms_stress {
+  struct zms_compositor* compositor;
+  struct zms_output* output;
+  struct wl_event_loop* loop;
+
+  uint64_t server_nsec;  // spent dispatching the server so far
+  uint32_t random_state;
+
+  struct wl_list client_list;  // -> zms_stress_client.link
+};
+
+uint64_t zms_stress_get_time(void);
+
+/* Deterministic, so that every run does the same */
+uint32_t zms_stress_random(struct zms_stress* stress, uint32_t max);
+
+/* Dispatch the server once without blocking, adding its time to server_nsec */
+void zms_stress_dispatch_server(struct zms_stress* stress);
+
+/* Until the server has handled every request sent so far by all clients, and
+ * the clients have handled the events it sent back */
+bool zms_stress_roundtrip(struct zms_stress* stress);
+
+struct zms_stress_client* zms_stress_client_create(struct zms_stress* stress);
+
+void zms_stress_client_destroy(struct zms_stress_client* client);
+
+/* Create a toplevel, or a popup of parent. Mapped on the roundtrip after the
+ * next one, once configured and committed with zms_stress_window_map. */
+struct zms_stress_window* zms_stress_window_create(
+    struct zms_stress_client* client, struct zms_stress_window* parent,
+    uint32_t size_index);
+
+/* Attach the buffer once configured */
+void zms_stress_window_map(struct zms_stress_window* window);
+
+void zms_stress_window_commit(
+    struct zms_stress_window* window, int32_t x, int32_t y, bool frame);
+
+/* Set or update the cursor image; the client must have the pointer focus */
+void zms_stress_client_update_cursor(
+    struct zms_stress_client* client, uint32_t seq);
+
+#endif  //  ZMONITORS_BENCH_STRESS_STRESS_H
@@ -117,6 +117,19 @@ void zms_opengl_vertex_buffer_destroy(
 int zms_opengl_vertex_buffer_get_fd(
     struct zms_opengl_vertex_buffer* vertex_buffer);
 
+/* opengl texture pool */
+
+struct zms_opengl_texture_pool;
+
+/**
+ * Share the memory of fd, which is fd_size long, with zigen once, so that
+ * textures over parts of it do not each map all of it.
+ */
+struct zms_opengl_texture_pool* zms_opengl_texture_pool_create(
+    struct zms_backend* backend, int fd, size_t fd_size);
+
+void zms_opengl_texture_pool_destroy(struct zms_opengl_texture_pool* pool);
+
 /* opengl texture */
 
 struct zms_opengl_texture;
@@ -124,6 +137,15 @@ struct zms_opengl_texture;
 struct zms_opengl_texture* zms_opengl_texture_create_by_fd(
     struct zms_backend* backend, int fd, struct zms_screen_size size);
 
+/**
+ * Create a texture showing a width x height rectangle of the ARGB8888 image
+ * in the memory of the pool, starting at offset with the given row stride.
+ * The memory is shared, not copied. The texture may outlive the pool.
+ */
+struct zms_opengl_texture* zms_opengl_texture_create_by_pool(
+    struct zms_opengl_texture_pool* pool, int32_t offset, uint32_t stride,
+    struct zms_screen_size size);
+
 static inline struct zms_opengl_texture*
 zms_opengl_texture_create(
     struct zms_backend* backend, struct zms_screen_size size)
@@ -135,6 +157,12 @@ void zms_opengl_texture_destroy(struct zms_opengl_texture* texture);
 
 int zms_opengl_texture_get_fd(struct zms_opengl_texture* texture);
 
+/**
+ * @return true from when an update of the texture is sent until zigen
+ * releases its memory; writing to the memory meanwhile may tear the texture
+ */
+bool zms_opengl_texture_is_busy(struct zms_opengl_texture* texture);
+
 /* opengl component */
 
 struct zms_opengl_component_private;
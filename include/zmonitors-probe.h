@@ -0,0 +1,70 @@
+#ifndef ZMONITORS_PROBE_H
+#define ZMONITORS_PROBE_H
+
+/**
+ * USDT probes of the zmonitors provider, for bpftrace, perf and systemtap,
+ * e.g. `bpftrace -e 'usdt:./zmonitors:zmonitors:surface_commit { ... }'`.
+ *
+ * Each probe needs ZMS_PROBE_DEFINE(name) once at file scope of the source
+ * file firing it. With sys/sdt.h, the definition is the semaphore a tracer
+ * increments while attached, and a probe evaluates its arguments only then;
+ * otherwise it costs a load and a branch. Use ZMS_PROBE_ENABLED(name) to skip
+ * computing arguments outside of the probe. Without sys/sdt.h, a probe
+ * compiles to nothing and its arguments are never evaluated.
+ */
+
+#ifdef HAVE_SYS_SDT_H
+
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+
+#define ZMS_PROBE_DEFINE(name)                              \
+  __extension__ unsigned short zmonitors_##name##_semaphore \
+      __attribute__((unused, section(".probes"), visibility("hidden")))
+#define ZMS_PROBE_ENABLED(name) \
+  __builtin_expect(zmonitors_##name##_semaphore, 0)
+
+#define ZMS_PROBE1(name, a)                                         \
+  do {                                                              \
+    if (ZMS_PROBE_ENABLED(name)) DTRACE_PROBE1(zmonitors, name, a); \
+  } while (0)
+#define ZMS_PROBE2(name, a, b)                                         \
+  do {                                                                 \
+    if (ZMS_PROBE_ENABLED(name)) DTRACE_PROBE2(zmonitors, name, a, b); \
+  } while (0)
+#define ZMS_PROBE3(name, a, b, c)                                         \
+  do {                                                                    \
+    if (ZMS_PROBE_ENABLED(name)) DTRACE_PROBE3(zmonitors, name, a, b, c); \
+  } while (0)
+#define ZMS_PROBE4(name, a, b, c, d)              \
+  do {                                            \
+    if (ZMS_PROBE_ENABLED(name))                  \
+      DTRACE_PROBE4(zmonitors, name, a, b, c, d); \
+  } while (0)
+
+#else
+
+#define ZMS_PROBE_DEFINE(name) struct zms_probe_##name##_unused
+#define ZMS_PROBE_ENABLED(name) 0
+
+// type checked, never evaluated
+#define ZMS_PROBE1(name, a) \
+  do {                      \
+    if (0) (void)(a);       \
+  } while (0)
+#define ZMS_PROBE2(name, a, b)   \
+  do {                           \
+    if (0) (void)(a), (void)(b); \
+  } while (0)
+#define ZMS_PROBE3(name, a, b, c)           \
+  do {                                      \
+    if (0) (void)(a), (void)(b), (void)(c); \
+  } while (0)
+#define ZMS_PROBE4(name, a, b, c, d)                   \
+  do {                                                 \
+    if (0) (void)(a), (void)(b), (void)(c), (void)(d); \
+  } while (0)
+
+#endif
+
+#endif  //  ZMONITORS_PROBE_H
@@ -9,6 +9,7 @@ extern "C" {
 #include <zmonitors-util.h>
 
 struct zms_compositor;
+struct zms_view;
 
 /* pixel buffer */
 
@@ -33,6 +34,32 @@ struct zms_output_private;
 
 struct zms_output_interface {
   void (*schedule_repaint)(void *user_data, struct zms_output *output);
+
+  /* When set, cursor surfaces are not composited into the pixel buffers, and
+   * this is called instead whenever the cursor appears, disappears, moves or
+   * changes its image. Use zms_output_get_cursor to get the current state. */
+  void (*update_cursor)(void *user_data, struct zms_output *output,
+      bool image_changed); /* nullable */
+
+  /* When all of these are set, toplevel windows are not composited into the
+   * pixel buffers either, so that each can be drawn on its own. map_window is
+   * called when a window is put on top of the others, update_window when it
+   * moves, resizes or its content is damaged, and unmap_window right before
+   * it disappears. Set update_cursor as well, or the cursor would be
+   * composited below the windows. */
+  void (*map_window)(void *user_data, struct zms_output *output,
+      struct zms_view *view); /* nullable */
+  void (*update_window)(void *user_data, struct zms_output *output,
+      struct zms_view *view, bool content_changed); /* nullable */
+  void (*unmap_window)(void *user_data, struct zms_output *output,
+      struct zms_view *view); /* nullable */
+
+  /* Whether the rectangle of the pixel buffer is still read by the
+   * implementation, e.g. not yet released by the display server. A busy
+   * pixel buffer is not repainted. */
+  bool (*is_pixel_buffer_busy)(void *user_data, struct zms_output *output,
+      struct zms_pixel_buffer *pixel_buffer, int32_t x, int32_t y,
+      uint32_t width, uint32_t height); /* nullable */
 };
 
 struct zms_output {
@@ -44,7 +71,7 @@ struct zms_output {
 
 struct zms_output *zms_output_create(struct zms_compositor *compositor,
     struct zms_screen_size size, vec2 physical_size, char *manufacturer,
-    char *model);
+    char *model, int pixel_buffer_count /* >= 2 */);
 
 void zms_output_destroy(struct zms_output *output);
 
@@ -52,12 +79,69 @@ void zms_output_set_implementation(struct zms_output *output, void *user_data,
     const struct zms_output_interface *interface);
 
 /**
- * @return previously-used back buffer (next front buffer)
+ * Composite the damage accumulated since the last repaint into a pixel buffer
+ * which is not busy, and make it the front buffer. Frames which could not be
+ * repainted meanwhile are never drawn; their damage goes to the next frame.
+ * Call this once per frame.
+ * @return false if every other pixel buffer is busy and the damage is kept
+ */
+bool zms_output_repaint(struct zms_output *output);
+
+/**
+ * @return true if the rectangle was repainted by the last zms_output_repaint
+ */
+bool zms_output_frame_damage_intersects(struct zms_output *output, int32_t x,
+    int32_t y, uint32_t width, uint32_t height);
+
+/**
+ * @return the number of pixels of the rectangle repainted by the last
+ * zms_output_repaint
  */
-struct zms_pixel_buffer *zms_output_buffer_ring_rotate(
+uint64_t zms_output_get_frame_damage_area(struct zms_output *output,
+    int32_t x, int32_t y, uint32_t width, uint32_t height);
+
+/**
+ * @return the pixel buffer having the newest frame
+ */
+struct zms_pixel_buffer *zms_output_get_front_buffer(
     struct zms_output *output);
 
-void zms_output_frame(struct zms_output *output, uint32_t time);
+/**
+ * @param consecutive true if this frame was requested right at the previous
+ * one, so that the interval between them is a refresh interval of the display
+ * rather than the time the output was idle
+ */
+void zms_output_frame(
+    struct zms_output *output, uint32_t time, bool consecutive);
+
+/**
+ * @return true while the refresh interval is not measured yet or the last
+ * back-to-back frame came late, i.e. frames without content are worth
+ * requesting to measure it
+ */
+bool zms_output_needs_frame_timing(struct zms_output *output);
+
+/**
+ * @return false if no cursor is shown on the output
+ */
+bool zms_output_get_cursor(struct zms_output *output, int32_t *x, int32_t *y,
+    uint32_t *width, uint32_t *height);
+
+/**
+ * Copy the current cursor image as ARGB8888 into data, which must be large
+ * enough for the size given by zms_output_get_cursor.
+ * @return false if no cursor is shown on the output
+ */
+bool zms_output_read_cursor_image(
+    struct zms_output *output, void *data, uint32_t stride);
+
+/**
+ * Identifies the wl_buffer shown as the cursor; the same while the cursor
+ * shows that buffer, and never reused. The client may redraw the buffer once
+ * it is released, so compare the image as well before reusing a copy of it.
+ * @return 0 if unknown, e.g. with shadow buffers, or if no cursor is shown
+ */
+uint64_t zms_output_get_cursor_buffer_id(struct zms_output *output);
 
 /* seat */
 
@@ -104,11 +188,38 @@ struct zms_view_private;
 struct zms_view {
   struct zms_view_private *priv;
 
+  /* Owned by the zms_output_interface implementation from map_window to
+   * unmap_window. nullable */
+  void *window_data;
+
   // signals
   struct zms_signal destroy_signal;
   struct zms_signal unmap_signal; /* invoked also when destroyed; */
 };
 
+/**
+ * Get the position of the view on its output and its size in pixels.
+ */
+void zms_view_get_geometry(struct zms_view *view, int32_t *x, int32_t *y,
+    uint32_t *width, uint32_t *height);
+
+/**
+ * Copy the part of the view image changed since the last call as ARGB8888
+ * into data, which holds the whole image of the size given by
+ * zms_view_get_geometry. Other pixels in data are left untouched.
+ * Only tracked for windows drawn through zms_output_interface.map_window.
+ * @param copied_pixels nullable; set to the number of pixels copied
+ * @return false if the view has no image
+ */
+bool zms_view_read_damaged_image(struct zms_view *view, void *data,
+    uint32_t stride, uint64_t *copied_pixels);
+
+/**
+ * Let the next zms_view_read_damaged_image copy the whole image, e.g. into
+ * data that does not hold the image yet.
+ */
+void zms_view_damage_whole_image(struct zms_view *view);
+
 /* compositor */
 
 struct zms_compositor_private;
@@ -125,6 +236,56 @@ struct zms_compositor *zms_compositor_create();
 
 void zms_compositor_destroy(struct zms_compositor *compositor);
 
+/**
+ * Composite outputs in tiles on thread_count threads including the main
+ * thread. thread_count <= 1 renders everything on the main thread (default).
+ */
+void zms_compositor_set_render_thread_count(
+    struct zms_compositor *compositor, int thread_count);
+
+/**
+ * When enabled, views keep a copy of the committed content, updated over the
+ * damage, and release client buffers right after each commit. Clients can
+ * then draw into a single buffer. Applies to buffers committed afterwards.
+ */
+void zms_compositor_set_shadow_buffers(
+    struct zms_compositor *compositor, bool enabled);
+
+/* metrics */
+
+enum zms_metrics_source {
+  ZMS_METRICS_SOURCE_CLIENTS,  // client requests, idles and timers
+  ZMS_METRICS_SOURCE_BACKEND,  // the connection to zigen
+  ZMS_METRICS_SOURCE_SIGNALS,
+  ZMS_METRICS_SOURCE_METRICS,  // the metrics socket itself
+  ZMS_METRICS_SOURCE_COUNT,
+};
+
+/**
+ * Serve a snapshot of the metrics in text to each connection to
+ * $XDG_RUNTIME_DIR/<wayland display name>.metrics, as read by zmonitors-top.
+ * The metrics are counted whether or not this is called.
+ */
+bool zms_compositor_listen_metrics(struct zms_compositor *compositor);
+
+/**
+ * Time spent for an event source of the display event loop. Call
+ * zms_compositor_record_dispatch_time after each dispatch as well.
+ */
+void zms_compositor_record_source_time(struct zms_compositor *compositor,
+    enum zms_metrics_source source, uint64_t nsec);
+
+/**
+ * Time spent in a whole wl_event_loop_dispatch, not including the wait for
+ * events. Whatever the other sources did not take is counted for clients.
+ */
+void zms_compositor_record_dispatch_time(
+    struct zms_compositor *compositor, uint64_t nsec);
+
+/** A texture read by the display server was updated */
+void zms_compositor_record_texture_upload(
+    struct zms_compositor *compositor, uint64_t bytes);
+
 #ifdef __cplusplus
 }
 #endif
@@ -6,6 +6,7 @@ extern "C" {
 #endif
 
 #include <cglm/cglm.h>
+#include <stdbool.h>
 #include <stdlib.h>
 #include <wayland-util.h>
 #include <zmonitors-types.h>
@@ -113,6 +114,51 @@ void zms_weak_ref_init(struct zms_weak_ref *ref);
 void zms_weak_reference(
     struct zms_weak_ref *ref, void *data, struct zms_signal *destroy_signal);
 
+/* tracing */
+
+enum zms_trace_event_type {
+  ZMS_TRACE_EVENT_BEGIN,
+  ZMS_TRACE_EVENT_END,
+  ZMS_TRACE_EVENT_COUNTER,
+};
+
+extern bool zms_trace_enabled;
+
+/**
+ * Start recording trace events into a ring buffer per thread, which keeps
+ * the newest ones. They are written to the file at path as Chrome trace JSON
+ * by zms_trace_dump, and also on a crash.
+ */
+bool zms_trace_start(const char *path);
+
+/** Dump and stop recording */
+void zms_trace_stop(void);
+
+/** Async signal safe; the events are kept */
+bool zms_trace_dump(void);
+
+/** @param name must be a string literal without escaped characters */
+void zms_trace_record(
+    enum zms_trace_event_type type, const char *name, int64_t value);
+
+static inline void
+zms_trace_begin(const char *name)
+{
+  if (zms_trace_enabled) zms_trace_record(ZMS_TRACE_EVENT_BEGIN, name, 0);
+}
+
+static inline void
+zms_trace_end(const char *name)
+{
+  if (zms_trace_enabled) zms_trace_record(ZMS_TRACE_EVENT_END, name, 0);
+}
+
+static inline void
+zms_trace_counter(const char *name, int64_t value)
+{
+  if (zms_trace_enabled) zms_trace_record(ZMS_TRACE_EVENT_COUNTER, name, value);
+}
+
 #ifdef __cplusplus
 }
 #endif
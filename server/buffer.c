@@ -4,6 +4,8 @@
 
 static void zms_buffer_destroy(struct zms_buffer *buffer);
 
+static uint64_t next_buffer_id = 1;
+
 static void
 zms_buffer_resource_destroy_handler(struct wl_listener *listener, void *data)
 {
@@ -14,8 +16,8 @@ zms_buffer_resource_destroy_handler(struct wl_listener *listener, void *data)
   zms_buffer_destroy(buffer);
 }
 
-ZMS_EXPORT struct zms_buffer *
-zms_buffer_create_from_resource(struct wl_resource *resource)
+static struct zms_buffer *
+zms_buffer_create(struct wl_resource *resource)
 {
   struct zms_buffer *buffer;
 
@@ -23,6 +25,17 @@ zms_buffer_create_from_resource(struct wl_resource *resource)
   if (buffer == NULL) goto err;
 
   buffer->resource = resource;
+  buffer->id = next_buffer_id++;
+  buffer->shm_buffer = wl_shm_buffer_get(resource);
+  buffer->shm_pool = NULL;
+  buffer->image = NULL;
+
+  if (buffer->shm_buffer) {
+    /* Only used to tell pools apart; the wl_shm_buffer keeps the pool alive.
+     * Holding a reference would defer the client's pool resizes. */
+    buffer->shm_pool = wl_shm_buffer_ref_pool(buffer->shm_buffer);
+    wl_shm_pool_unref(buffer->shm_pool);
+  }
   buffer->resource_destroy_listener.notify =
       zms_buffer_resource_destroy_handler;
   wl_resource_add_destroy_listener(
@@ -39,10 +52,58 @@ err:
 static void
 zms_buffer_destroy(struct zms_buffer *buffer)
 {
-  wl_signal_emit(&buffer->destroy_signal, NULL);
+  wl_signal_emit(&buffer->destroy_signal, buffer);
+  if (buffer->image) pixman_image_unref(buffer->image);
   free(buffer);
 }
 
+ZMS_EXPORT struct zms_buffer *
+zms_buffer_from_resource(struct wl_resource *resource)
+{
+  struct zms_buffer *buffer;
+  struct wl_listener *listener;
+
+  listener = wl_resource_get_destroy_listener(
+      resource, zms_buffer_resource_destroy_handler);
+
+  if (listener)
+    return wl_container_of(listener, buffer, resource_destroy_listener);
+  else
+    return zms_buffer_create(resource);
+}
+
+ZMS_EXPORT pixman_image_t *
+zms_buffer_create_image(struct zms_buffer *buffer)
+{
+  struct wl_shm_buffer *shm_buffer = buffer->shm_buffer;
+  pixman_format_code_t format;
+
+  if (shm_buffer == NULL) return NULL;
+
+  format = wl_shm_buffer_get_format(shm_buffer) == WL_SHM_FORMAT_XRGB8888
+               ? PIXMAN_x8r8g8b8
+               : PIXMAN_a8r8g8b8;
+
+  return pixman_image_create_bits(format, wl_shm_buffer_get_width(shm_buffer),
+      wl_shm_buffer_get_height(shm_buffer), wl_shm_buffer_get_data(shm_buffer),
+      wl_shm_buffer_get_stride(shm_buffer));
+}
+
+ZMS_EXPORT pixman_image_t *
+zms_buffer_get_image(struct zms_buffer *buffer)
+{
+  // a resized pool may have been mapped at another address
+  if (buffer->image && pixman_image_get_data(buffer->image) !=
+                           wl_shm_buffer_get_data(buffer->shm_buffer)) {
+    pixman_image_unref(buffer->image);
+    buffer->image = NULL;
+  }
+
+  if (buffer->image == NULL) buffer->image = zms_buffer_create_image(buffer);
+
+  return buffer->image;
+}
+
 static void
 zms_buffer_ref_buffer_destroy_handler(struct wl_listener *listener, void *data)
 {
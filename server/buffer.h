@@ -1,15 +1,24 @@
 #ifndef ZMONITORS_SERVER_BUFFER_H
 #define ZMONITORS_SERVER_BUFFER_H
 
+#include <pixman-1/pixman.h>
 #include <wayland-server.h>
 
 struct zms_buffer {
   struct wl_resource *resource;
   struct wl_listener resource_destroy_listener;
 
-  struct wl_signal destroy_signal;
+  struct wl_signal destroy_signal;  // with the zms_buffer as the data
+
+  uint64_t id;  // never reused, unlike the address
 
   uint32_t busy_count;
+
+  /* The pool, offset, size, stride and format of a wl_buffer never change,
+   * so these are kept for the lifetime of the resource. */
+  struct wl_shm_buffer *shm_buffer; /* nullable; null if not a shm buffer */
+  struct wl_shm_pool *shm_pool;     /* nullable; not referenced */
+  pixman_image_t *image;            /* nullable; created on the first use */
 };
 
 struct zms_buffer_ref {
@@ -17,8 +26,20 @@ struct zms_buffer_ref {
   struct wl_listener buffer_destroy_listener;
 };
 
-struct zms_buffer *zms_buffer_create_from_resource(
-    struct wl_resource *resource);
+/* Returns the zms_buffer of the wl_buffer resource, creating it on the first
+ * call. The same zms_buffer is returned until the resource is destroyed, so
+ * that the busy count carries across attaches. */
+struct zms_buffer *zms_buffer_from_resource(struct wl_resource *resource);
+
+/* Returns the image over the shm buffer memory, or NULL if the buffer is not
+ * a shm buffer. The image is owned by the buffer and created again when the
+ * pool was remapped; take a reference to keep it. Access the memory between
+ * wl_shm_buffer_begin_access and wl_shm_buffer_end_access. */
+pixman_image_t *zms_buffer_get_image(struct zms_buffer *buffer);
+
+/* Same as zms_buffer_get_image but always creates a new image, owned by the
+ * caller. */
+pixman_image_t *zms_buffer_create_image(struct zms_buffer *buffer);
 
 void zms_buffer_reference(
     struct zms_buffer_ref *ref, struct zms_buffer *buffer /* nullable */);
@@ -1,6 +1,7 @@
 #include "compositor.h"
 
 #include <stdbool.h>
+#include <stdio.h>
 #include <wayland-server.h>
 #include <zmonitors-server.h>
 
@@ -62,6 +63,7 @@ zms_compositor_create()
   struct wl_global* global;
   struct zms_wm_base* wm_base;
   struct zms_data_device_manager* data_device_manager;
+  struct zms_presentation* presentation;
   struct zms_seat* seat;
   const char* socket;
 
@@ -97,6 +99,10 @@ zms_compositor_create()
   }
 
   wl_list_init(&priv->output_list);
+  priv->socket_name = socket;
+  zms_metrics_init(&priv->metrics, compositor);
+  priv->render_pool = NULL;
+  priv->shadow_buffers = false;
   compositor->priv = priv;
   compositor->display = display;
 
@@ -119,6 +125,12 @@ zms_compositor_create()
     goto err_data_device_manager;
   }
 
+  presentation = zms_presentation_create(compositor);
+  if (presentation == NULL) {
+    zms_log("failed to create a presentation\n");
+    goto err_presentation;
+  }
+
   seat = zms_seat_create(compositor);
   if (seat == NULL) {
     zms_log("failed to create a seat\n");
@@ -127,11 +139,15 @@ zms_compositor_create()
 
   compositor->priv->wm_base = wm_base;
   compositor->priv->data_device_manager = data_device_manager;
+  compositor->priv->presentation = presentation;
   compositor->seat = seat;
 
   return compositor;
 
 err_seat:
+  zms_presentation_destroy(presentation);
+
+err_presentation:
   zms_data_device_manager_destroy(data_device_manager);
 
 err_data_device_manager:
@@ -156,11 +172,40 @@ zms_compositor_destroy(struct zms_compositor* compositor)
   zms_seat_destroy(compositor->seat);
   zms_wm_base_destroy(compositor->priv->wm_base);
   zms_data_device_manager_destroy(compositor->priv->data_device_manager);
+  zms_presentation_destroy(compositor->priv->presentation);
+  zms_metrics_fini(&compositor->priv->metrics);
   wl_display_destroy(compositor->display);
+  if (compositor->priv->render_pool)
+    zms_render_pool_destroy(compositor->priv->render_pool);
   free(compositor->priv);
   free(compositor);
 }
 
+ZMS_EXPORT void
+zms_compositor_set_render_thread_count(
+    struct zms_compositor* compositor, int thread_count)
+{
+  struct zms_render_pool* pool = NULL;
+
+  if (thread_count > 1) {
+    pool = zms_render_pool_create(thread_count);
+    if (pool == NULL)
+      zms_log("failed to create render threads; render on the main thread\n");
+  }
+
+  if (compositor->priv->render_pool)
+    zms_render_pool_destroy(compositor->priv->render_pool);
+
+  compositor->priv->render_pool = pool;
+}
+
+ZMS_EXPORT void
+zms_compositor_set_shadow_buffers(
+    struct zms_compositor* compositor, bool enabled)
+{
+  compositor->priv->shadow_buffers = enabled;
+}
+
 ZMS_EXPORT struct zms_output*
 zms_compositor_get_primary_output(struct zms_compositor* compositor)
 {
@@ -172,3 +217,54 @@ zms_compositor_get_primary_output(struct zms_compositor* compositor)
 
   assert(false && "not reached");
 }
+
+ZMS_EXPORT bool
+zms_compositor_listen_metrics(struct zms_compositor* compositor)
+{
+  const char* runtime_dir = getenv("XDG_RUNTIME_DIR");
+  char path[256];
+
+  if (runtime_dir == NULL) {
+    zms_log("XDG_RUNTIME_DIR is not set\n");
+    return false;
+  }
+
+  snprintf(path, sizeof path, "%s/%s.metrics", runtime_dir,
+      compositor->priv->socket_name);
+
+  return zms_metrics_listen(&compositor->priv->metrics, path);
+}
+
+ZMS_EXPORT void
+zms_compositor_record_source_time(struct zms_compositor* compositor,
+    enum zms_metrics_source source, uint64_t nsec)
+{
+  struct zms_metrics* metrics = &compositor->priv->metrics;
+
+  metrics->sources[source].count++;
+  metrics->sources[source].nsec += nsec;
+  if (source != ZMS_METRICS_SOURCE_CLIENTS)
+    metrics->dispatch_source_nsec += nsec;
+}
+
+ZMS_EXPORT void
+zms_compositor_record_dispatch_time(
+    struct zms_compositor* compositor, uint64_t nsec)
+{
+  struct zms_metrics* metrics = &compositor->priv->metrics;
+  uint64_t source_nsec = metrics->dispatch_source_nsec;
+
+  metrics->dispatch_source_nsec = 0;
+  if (nsec <= source_nsec) return;
+
+  zms_compositor_record_source_time(
+      compositor, ZMS_METRICS_SOURCE_CLIENTS, nsec - source_nsec);
+}
+
+ZMS_EXPORT void
+zms_compositor_record_texture_upload(
+    struct zms_compositor* compositor, uint64_t bytes)
+{
+  compositor->priv->metrics.texture_upload_count++;
+  compositor->priv->metrics.texture_upload_bytes += bytes;
+}
@@ -5,14 +5,30 @@
 #include <zmonitors-server.h>
 
 #include "data-device-manager.h"
+#include "metrics.h"
+#include "presentation.h"
+#include "render-pool.h"
 #include "xdg-wm-base.h"
 
 struct zms_compositor_private {
   /* global objects */
   struct zms_wm_base* wm_base;
   struct zms_data_device_manager* data_device_manager;
+  struct zms_presentation* presentation;
 
   struct wl_list output_list;
+
+  const char* socket_name;  // owned by the display
+
+  struct zms_metrics metrics;
+
+  /* render threads shared by outputs.
+   * null when rendering on the main thread. */
+  struct zms_render_pool* render_pool;
+
+  /* views copy committed content into images of their own and release
+   * client buffers right away */
+  bool shadow_buffers;
 };
 
 struct zms_output* zms_compositor_get_primary_output(
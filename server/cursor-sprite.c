@@ -92,7 +92,7 @@ zms_cursor_sprite_pointer_moved_handler(
 
   pixman_region32_union(&damage, &old_region, &new_region);
 
-  zms_output_render(view->priv->output, &damage);
+  zms_output_damage_view(view->priv->output, view, &damage, false);
 
   pixman_region32_fini(&damage);
   pixman_region32_fini(&old_region);
@@ -189,7 +189,8 @@ zms_cursor_sprite_update_hotspot(
 
   pixman_region32_union(&damage, &old_region, &new_region);
 
-  zms_output_render(sprite->surface->view->priv->output, &damage);
+  zms_output_damage_view(sprite->surface->view->priv->output,
+      sprite->surface->view, &damage, false);
 
   pixman_region32_fini(&damage);
   pixman_region32_fini(&old_region);
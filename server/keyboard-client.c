@@ -53,6 +53,7 @@ zms_keyboard_client_create(
     struct wl_client *client, struct zms_keyboard *keyboard)
 {
   struct zms_keyboard_client *keyboard_client;
+  struct zms_view *focus_view;
 
   keyboard_client = zalloc(sizeof *keyboard_client);
   if (keyboard_client == NULL) {
@@ -74,6 +75,12 @@ zms_keyboard_client_create(
 
   wl_list_init(&keyboard_client->resource_list);
 
+  // the client bound the keyboard after its view got the focus
+  focus_view = keyboard->focus_view_ref.data;
+  if (focus_view &&
+      wl_resource_get_client(focus_view->priv->surface->resource) == client)
+    keyboard->focus_client = keyboard_client;
+
   return keyboard_client;
 
 err:
@@ -93,6 +100,9 @@ zms_keyboard_client_destroy(struct zms_keyboard_client *keyboard_client)
     wl_list_remove(wl_resource_get_link(resource));
   }
 
+  if (keyboard_client->keyboard->focus_client == keyboard_client)
+    keyboard_client->keyboard->focus_client = NULL;
+
   wl_list_remove(&keyboard_client->link);
   wl_list_remove(&keyboard_client->keyboard_destroy_listener.link);
   wl_list_remove(&keyboard_client->client_destroy_listener.link);
@@ -147,7 +157,17 @@ zms_keyboard_client_find(
     struct wl_client *client, struct zms_keyboard *keyboard)
 {
   struct zms_keyboard_client *keyboard_client;
+  struct wl_listener *listener;
+
+  // every keyboard client listens to the destruction of its wl_client
+  listener = wl_client_get_destroy_listener(client, client_destroy_handler);
+  if (listener) {
+    keyboard_client =
+        wl_container_of(listener, keyboard_client, client_destroy_listener);
+    if (keyboard_client->keyboard == keyboard) return keyboard_client;
+  }
 
+  // the client has keyboard clients for multiple keyboards
   wl_list_for_each(keyboard_client, &keyboard->keyboard_client_list, link)
   {
     if (keyboard_client->client == client) return keyboard_client;
@@ -17,6 +17,7 @@ zms_keyboard_create(struct zms_seat *seat)
   keyboard->seat = seat;
   wl_list_init(&keyboard->keyboard_client_list);
   zms_weak_ref_init(&keyboard->focus_view_ref);
+  keyboard->focus_client = NULL;
   zms_signal_init(&keyboard->destroy_signal);
 
   return keyboard;
@@ -56,18 +57,20 @@ zms_keyboard_set_focus(
 
   if (prev_focus) {
     uint32_t serial = wl_display_next_serial(display);
-    client = wl_resource_get_client(prev_focus->priv->surface->resource);
-    keyboard_client = zms_keyboard_client_find(client, keyboard);
+    keyboard_client = keyboard->focus_client;
     if (keyboard_client)
       zms_keyboard_client_send_leave(keyboard_client, serial, prev_focus);
   }
 
+  keyboard->focus_client = NULL;
+
   if (view) {
     uint32_t serial = wl_display_next_serial(display);
     struct wl_array keys;  // TODO: set keys pressed
     wl_array_init(&keys);
     client = wl_resource_get_client(view->priv->surface->resource);
     keyboard_client = zms_keyboard_client_find(client, keyboard);
+    keyboard->focus_client = keyboard_client;
     if (keyboard_client)
       zms_keyboard_client_send_enter(keyboard_client, serial, view, &keys);
     wl_array_release(&keys);
@@ -82,16 +85,9 @@ zms_keyboard_send_key(struct zms_keyboard *keyboard, uint32_t serial,
     uint32_t time, uint32_t key, uint32_t state)
 {
   struct zms_view *view = keyboard->focus_view_ref.data;
-  struct zms_keyboard_client *keyboard_client;
-  struct wl_client *client;
-
-  if (view == NULL) return;
-
-  client = wl_resource_get_client(view->priv->surface->resource);
+  struct zms_keyboard_client *keyboard_client = keyboard->focus_client;
 
-  keyboard_client = zms_keyboard_client_find(client, keyboard);
-
-  if (keyboard_client == NULL) return;
+  if (view == NULL || keyboard_client == NULL) return;
 
   zms_keyboard_client_send_key(keyboard_client, serial, time, key, state);
 }
@@ -102,16 +98,9 @@ zms_keyboard_send_modifiers(struct zms_keyboard *keyboard, uint32_t serial,
     uint32_t group)
 {
   struct zms_view *view = keyboard->focus_view_ref.data;
-  struct zms_keyboard_client *keyboard_client;
-  struct wl_client *client;
-
-  if (view == NULL) return;
-
-  client = wl_resource_get_client(view->priv->surface->resource);
-
-  keyboard_client = zms_keyboard_client_find(client, keyboard);
+  struct zms_keyboard_client *keyboard_client = keyboard->focus_client;
 
-  if (keyboard_client == NULL) return;
+  if (view == NULL || keyboard_client == NULL) return;
 
   zms_keyboard_client_send_modifiers(keyboard_client, serial, mods_depressed,
       mods_latched, mods_locked, group);
@@ -13,6 +13,9 @@ struct zms_keyboard {
   uint32_t keymap_format;
 
   struct zms_weak_ref focus_view_ref;
+  /* keyboard client of the focus view's client, looked up when the focus
+   * changes. nullable. valid only when focus_view_ref.data is not null. */
+  struct zms_keyboard_client *focus_client;
 
   // signals
   struct zms_signal destroy_signal;
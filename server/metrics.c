@@ -0,0 +1,272 @@
+#include "metrics.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "compositor.h"
+#include "output.h"
+
+static const char* source_names[ZMS_METRICS_SOURCE_COUNT] = {
+    [ZMS_METRICS_SOURCE_CLIENTS] = "clients",
+    [ZMS_METRICS_SOURCE_BACKEND] = "backend",
+    [ZMS_METRICS_SOURCE_SIGNALS] = "signals",
+    [ZMS_METRICS_SOURCE_METRICS] = "metrics",
+};
+
+static void
+zms_metrics_client_destroy(struct zms_metrics_client* metrics_client)
+{
+  wl_list_remove(&metrics_client->link);
+  wl_list_remove(&metrics_client->client_destroy_listener.link);
+  free(metrics_client);
+}
+
+static void
+zms_metrics_client_handle_client_destroy(
+    struct wl_listener* listener, void* data)
+{
+  Z_UNUSED(data);
+  struct zms_metrics_client* metrics_client;
+
+  metrics_client =
+      wl_container_of(listener, metrics_client, client_destroy_listener);
+
+  zms_metrics_client_destroy(metrics_client);
+}
+
+static struct zms_metrics_client*
+zms_metrics_client_get(struct zms_metrics* metrics, struct wl_client* client)
+{
+  struct zms_metrics_client* metrics_client;
+  struct wl_listener* listener;
+
+  listener = wl_client_get_destroy_listener(
+      client, zms_metrics_client_handle_client_destroy);
+  if (listener)
+    return wl_container_of(listener, metrics_client, client_destroy_listener);
+
+  metrics_client = zalloc(sizeof *metrics_client);
+  if (metrics_client == NULL) return NULL;
+
+  wl_client_get_credentials(client, &metrics_client->pid, NULL, NULL);
+  metrics_client->client_destroy_listener.notify =
+      zms_metrics_client_handle_client_destroy;
+  wl_client_add_destroy_listener(
+      client, &metrics_client->client_destroy_listener);
+  wl_list_insert(&metrics->client_list, &metrics_client->link);
+
+  return metrics_client;
+}
+
+static void
+zms_metrics_write_histogram(
+    FILE* file, const char* name, struct zms_metrics_histogram* histogram)
+{
+  fprintf(file, "histogram %s count=%" PRIu64 " sum=%" PRIu64, name,
+      histogram->count, histogram->sum);
+  for (int i = 0; i < ZMS_METRICS_HISTOGRAM_BUCKET_COUNT; i++)
+    fprintf(file, " b%d=%" PRIu64, i, histogram->buckets[i]);
+  fprintf(file, "\n");
+}
+
+/* One line per object: its kind, its id, then key=value pairs */
+static void
+zms_metrics_write_snapshot(struct zms_metrics* metrics, FILE* file)
+{
+  struct zms_output* output;
+  struct zms_metrics_client* metrics_client;
+  int index = 0;
+
+  fprintf(file, "time now nsec=%" PRIu64 "\n", zms_metrics_get_time());
+
+  fprintf(file,
+      "compositor main composited_pixels=%" PRIu64 " copied_bytes=%" PRIu64
+      " texture_uploads=%" PRIu64 " texture_upload_bytes=%" PRIu64 "\n",
+      metrics->composited_pixels, metrics->copied_bytes,
+      metrics->texture_upload_count, metrics->texture_upload_bytes);
+
+  wl_list_for_each(output, &metrics->compositor->priv->output_list, link)
+  {
+    fprintf(file,
+        "output %d width=%d height=%d frames=%" PRIu64 " repaints=%" PRIu64
+        " composited_pixels=%" PRIu64 "\n",
+        index++, output->priv->size.width, output->priv->size.height,
+        output->priv->frame_count, output->priv->repaint_count,
+        output->priv->composited_pixels);
+  }
+
+  wl_list_for_each(metrics_client, &metrics->client_list, link)
+  {
+    fprintf(file, "client %d commits=%" PRIu64 "\n", metrics_client->pid,
+        metrics_client->commit_count);
+  }
+
+  for (int i = 0; i < ZMS_METRICS_SOURCE_COUNT; i++) {
+    fprintf(file, "source %s count=%" PRIu64 " nsec=%" PRIu64 "\n",
+        source_names[i], metrics->sources[i].count, metrics->sources[i].nsec);
+  }
+
+  zms_metrics_write_histogram(
+      file, "frame_latency_usec", &metrics->frame_latency);
+}
+
+static void
+zms_metrics_send_snapshot(struct zms_metrics* metrics, int fd)
+{
+  char* data = NULL;
+  size_t size = 0, offset = 0;
+  ssize_t sent;
+  FILE* file;
+
+  file = open_memstream(&data, &size);
+  if (file == NULL) {
+    zms_log("failed to allocate memory\n");
+    return;
+  }
+
+  zms_metrics_write_snapshot(metrics, file);
+  fclose(file);
+
+  // a snapshot fits in the socket buffer; a reader too slow for it loses it
+  while (offset < size) {
+    sent = send(fd, data + offset, size - offset, MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (sent < 0 && errno == EINTR) continue;
+    if (sent <= 0) break;
+    offset += sent;
+  }
+
+  free(data);
+}
+
+static int
+zms_metrics_handle_connection(int fd, uint32_t mask, void* data)
+{
+  Z_UNUSED(mask);
+  struct zms_metrics* metrics = data;
+  uint64_t begin = zms_metrics_get_time();
+  int client_fd;
+
+  client_fd = accept4(fd, NULL, NULL, SOCK_CLOEXEC | SOCK_NONBLOCK);
+  if (client_fd < 0) return 0;
+
+  zms_metrics_send_snapshot(metrics, client_fd);
+  close(client_fd);
+
+  zms_compositor_record_source_time(metrics->compositor,
+      ZMS_METRICS_SOURCE_METRICS, zms_metrics_get_time() - begin);
+
+  return 0;
+}
+
+ZMS_EXPORT void
+zms_metrics_init(struct zms_metrics* metrics, struct zms_compositor* compositor)
+{
+  memset(metrics, 0, sizeof *metrics);
+  metrics->compositor = compositor;
+  wl_list_init(&metrics->client_list);
+}
+
+ZMS_EXPORT void
+zms_metrics_fini(struct zms_metrics* metrics)
+{
+  struct zms_metrics_client *metrics_client, *tmp;
+
+  wl_list_for_each_safe(metrics_client, tmp, &metrics->client_list, link)
+      zms_metrics_client_destroy(metrics_client);
+
+  if (metrics->listen_source) {
+    wl_event_source_remove(metrics->listen_source);
+    unlink(metrics->path);
+    free(metrics->path);
+  }
+}
+
+ZMS_EXPORT bool
+zms_metrics_listen(struct zms_metrics* metrics, const char* path)
+{
+  struct wl_event_loop* loop;
+  struct sockaddr_un addr = {.sun_family = AF_UNIX};
+  int fd;
+
+  if (strlen(path) >= sizeof addr.sun_path) {
+    zms_log("metrics socket path too long: %s\n", path);
+    goto err;
+  }
+  strcpy(addr.sun_path, path);
+
+  metrics->path = strdup(path);
+  if (metrics->path == NULL) {
+    zms_log("failed to allocate memory\n");
+    goto err;
+  }
+
+  fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+  if (fd < 0) {
+    zms_log("failed to create a metrics socket\n");
+    goto err_socket;
+  }
+
+  // left by a zmonitors which did not exit cleanly
+  unlink(path);
+
+  if (bind(fd, (struct sockaddr*)&addr, sizeof addr) < 0 ||
+      listen(fd, 4) < 0) {
+    zms_log("failed to listen on %s: %s\n", path, strerror(errno));
+    goto err_listen;
+  }
+
+  loop = wl_display_get_event_loop(metrics->compositor->display);
+  // the event source has its own duplicate of the fd
+  metrics->listen_source = wl_event_loop_add_fd(
+      loop, fd, WL_EVENT_READABLE, zms_metrics_handle_connection, metrics);
+  close(fd);
+  if (metrics->listen_source == NULL) {
+    zms_log("failed to create a event source\n");
+    goto err_source;
+  }
+
+  return true;
+
+err_listen:
+  close(fd);
+
+err_source:
+  unlink(path);
+
+err_socket:
+  free(metrics->path);
+  metrics->path = NULL;
+
+err:
+  return false;
+}
+
+ZMS_EXPORT void
+zms_metrics_record_commit(struct zms_metrics* metrics, struct wl_client* client)
+{
+  struct zms_metrics_client* metrics_client;
+
+  metrics_client = zms_metrics_client_get(metrics, client);
+  if (metrics_client) metrics_client->commit_count++;
+}
+
+ZMS_EXPORT void
+zms_metrics_record_frame_latency(struct zms_metrics* metrics, uint64_t nsec)
+{
+  struct zms_metrics_histogram* histogram = &metrics->frame_latency;
+  uint64_t usec = nsec / 1000;
+  int bucket = 0;
+
+  while (bucket < ZMS_METRICS_HISTOGRAM_BUCKET_COUNT - 1 &&
+         usec >> (bucket + 1) > 0)
+    bucket++;
+
+  histogram->count++;
+  histogram->sum += usec;
+  histogram->buckets[bucket]++;
+}
@@ -0,0 +1,76 @@
+#ifndef ZMONITORS_SERVER_METRICS_H
+#define ZMONITORS_SERVER_METRICS_H
+
+#include <time.h>
+#include <wayland-server.h>
+#include <zmonitors-server.h>
+
+/* Bucket i counts values in [2^i, 2^(i+1)) microseconds, bucket 0 also 0 and
+ * the last one everything above */
+#define ZMS_METRICS_HISTOGRAM_BUCKET_COUNT 24
+
+struct zms_metrics_histogram {
+  uint64_t count;
+  uint64_t sum;  // in microseconds
+  uint64_t buckets[ZMS_METRICS_HISTOGRAM_BUCKET_COUNT];
+};
+
+struct zms_metrics_source_time {
+  uint64_t count;
+  uint64_t nsec;
+};
+
+struct zms_metrics_client {
+  struct wl_list link;  // -> zms_metrics.client_list
+  struct wl_listener client_destroy_listener;
+  pid_t pid;
+  uint64_t commit_count;
+};
+
+/* Counters since the compositor was created. Per output ones are in
+ * zms_output_private. */
+struct zms_metrics {
+  struct zms_compositor* compositor;
+
+  uint64_t composited_pixels;
+  uint64_t copied_bytes;  // by the CPU besides compositing
+  uint64_t texture_upload_count;
+  uint64_t texture_upload_bytes;
+  // from a commit with frame callbacks until they are done
+  struct zms_metrics_histogram frame_latency;
+
+  struct zms_metrics_source_time sources[ZMS_METRICS_SOURCE_COUNT];
+  // taken by the sources other than clients within the current dispatch
+  uint64_t dispatch_source_nsec;
+
+  struct wl_list client_list;  // <- zms_metrics_client.link
+
+  // null until zms_compositor_listen_metrics
+  struct wl_event_source* listen_source;
+  char* path;
+};
+
+void zms_metrics_init(
+    struct zms_metrics* metrics, struct zms_compositor* compositor);
+
+void zms_metrics_fini(struct zms_metrics* metrics);
+
+bool zms_metrics_listen(struct zms_metrics* metrics, const char* path);
+
+void zms_metrics_record_commit(
+    struct zms_metrics* metrics, struct wl_client* client);
+
+void zms_metrics_record_frame_latency(
+    struct zms_metrics* metrics, uint64_t nsec);
+
+static inline uint64_t
+zms_metrics_get_time(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+#endif  //  ZMONITORS_SERVER_METRICS_H
@@ -42,7 +42,7 @@ zms_move_grab_motion_abs(struct zms_pointer_grab* grab,
 
   pixman_region32_union(&damage, &old_view_region, &new_view_region);
 
-  zms_output_render(output, &damage);
+  zms_output_damage_view(output, move_grab->view, &damage, false);
 
   pixman_region32_fini(&damage);
   pixman_region32_fini(&old_view_region);
@@ -3,16 +3,46 @@
 #include <pixman-1/pixman.h>
 #include <sys/mman.h>
 #include <unistd.h>
+#include <zmonitors-probe.h>
 #include <zmonitors-server.h>
 
 #include "compositor.h"
 #include "math.h"
 #include "pixel-buffer.h"
 #include "pixman-helper.h"
+#include "presentation-feedback.h"
+#include "render-pool.h"
 #include "string.h"
 #include "surface.h"
 #include "view.h"
 
+ZMS_PROBE_DEFINE(view_map);
+ZMS_PROBE_DEFINE(view_unmap);
+ZMS_PROBE_DEFINE(output_render);
+ZMS_PROBE_DEFINE(output_repaint);
+ZMS_PROBE_DEFINE(buffer_rotate);
+
+#define ZMS_OUTPUT_RENDER_TILE_SIZE 128
+
+/* Frame callbacks come only while something is repainted; a longer gap
+ * between two of them is idle time rather than a refresh interval. */
+#define ZMS_OUTPUT_MAX_FRAME_INTERVAL_MSEC 100
+
+/* A back-to-back frame later than this many smoothed intervals suggests that
+ * the refresh rate has dropped */
+#define ZMS_OUTPUT_LATE_FRAME_RATIO 1.5
+
+/* Weight of a new frame interval in the smoothed one. zigen gives frame
+ * times in whole milliseconds, so single intervals jitter by 1 ms. */
+#define ZMS_OUTPUT_FRAME_INTERVAL_SMOOTHING 0.05
+
+// until measured
+#define ZMS_OUTPUT_DEFAULT_REFRESH 60000
+
+/* The measured refresh rate is advertised again only when it moves further
+ * than this from the advertised one, in mHz */
+#define ZMS_OUTPUT_REFRESH_HYSTERESIS 1000
+
 static void
 draw_background(struct zms_bgra* bg, struct zms_screen_size size)
 {
@@ -59,16 +89,24 @@ static const struct wl_output_interface output_interface = {
     .release = zms_output_protocol_release,
 };
 
+static void
+zms_output_send_mode(struct zms_output* output, struct wl_resource* resource)
+{
+  wl_output_send_mode(resource,
+      WL_OUTPUT_MODE_CURRENT | WL_OUTPUT_MODE_PREFERRED,
+      output->priv->size.width, output->priv->size.height,
+      output->priv->refresh);
+}
+
 static void
 zms_output_send_geometry(struct zms_output* output, struct wl_client* client)
 {
   struct wl_resource* resource;
-  int32_t x, y, refresh;
+  int32_t x, y;
 
   // TODO: get geometry
   x = 0;
   y = 0;
-  refresh = 60000;
 
   wl_resource_for_each(resource, &output->priv->resource_list)
   {
@@ -81,9 +119,7 @@ zms_output_send_geometry(struct zms_output* output, struct wl_client* client)
         output->priv->manufacturer, output->priv->model,
         WL_OUTPUT_TRANSFORM_NORMAL);
     wl_output_send_scale(resource, 1);
-    wl_output_send_mode(resource,
-        WL_OUTPUT_MODE_CURRENT | WL_OUTPUT_MODE_PREFERRED,
-        output->priv->size.width, output->priv->size.height, refresh);
+    zms_output_send_mode(output, resource);
     wl_output_send_done(resource);
   }
 }
@@ -118,7 +154,7 @@ zms_output_bind(
 ZMS_EXPORT struct zms_output*
 zms_output_create(struct zms_compositor* compositor,
     struct zms_screen_size size, vec2 physical_size, char* manufacturer,
-    char* model)
+    char* model, int pixel_buffer_count)
 {
   struct zms_output* output;
   struct zms_output_private* priv;
@@ -127,11 +163,16 @@ zms_output_create(struct zms_compositor* compositor,
   struct zms_bgra* bg_buffer;
   pixman_image_t* bg_image;
   pixman_region32_t output_region;
-  int pixel_buffer_count = 2;
   struct zms_pixel_buffer** pixel_buffers;
+  struct zms_view_grid* view_grid;
 
   buffer_size = size.width * size.height * sizeof(struct zms_bgra);
 
+  if (pixel_buffer_count < 2) {
+    zms_log("an output needs at least 2 pixel buffers\n");
+    goto err;
+  }
+
   output = zalloc(sizeof *output);
   if (output == NULL) {
     zms_log("failed to allocate memory\n");
@@ -162,6 +203,9 @@ zms_output_create(struct zms_compositor* compositor,
   bg_image = pixman_image_create_bits(PIXMAN_a8r8g8b8, size.width, size.height,
       (uint32_t*)bg_buffer, size.width * sizeof(struct zms_bgra));
 
+  view_grid = zms_view_grid_create(size);
+  if (view_grid == NULL) goto err_view_grid;
+
   global = wl_global_create(
       compositor->display, &wl_output_interface, 3, output, zms_output_bind);
   if (global == NULL) {
@@ -177,11 +221,27 @@ zms_output_create(struct zms_compositor* compositor,
   glm_vec3_copy(physical_size, priv->physical_size);
   priv->manufacturer = strdup(manufacturer);
   priv->model = strdup(model);
-  priv->back_buffer_index = 0;
+  priv->front_buffer_index = pixel_buffer_count - 1;
+  priv->frame_timing.timestamp.tv_sec = 0;
+  priv->frame_timing.timestamp.tv_nsec = 0;
+  priv->frame_timing.refresh_nsec = 0;
+  priv->frame_timing.seq = 0;
+  priv->last_frame_time = 0;
+  priv->frame_interval_nsec = 0;
+  priv->frame_late = false;
+  priv->refresh = ZMS_OUTPUT_DEFAULT_REFRESH;
+  priv->frame_count = 0;
+  priv->repaint_count = 0;
+  priv->composited_pixels = 0;
+  pixman_region32_init(&priv->damage);
+  pixman_region32_init(&priv->frame_damage);
+  wl_list_init(&priv->feedback_list);
   wl_list_init(&priv->resource_list);
 
   for (int i = 0; i < ZMS_OUTPUT_VIEW_LAYER_COUNT; i++)
     zms_view_layer_init(&priv->layers[i]);
+  priv->last_stacking_order = 0;
+  priv->view_grid = view_grid;
 
   priv->bg_buffer = bg_buffer;
   priv->bg_image = bg_image;
@@ -200,6 +260,9 @@ zms_output_create(struct zms_compositor* compositor,
   return output;
 
 err_global:
+  zms_view_grid_destroy(view_grid);
+
+err_view_grid:
   free(bg_buffer);
 
 err_bg:
@@ -223,8 +286,13 @@ ZMS_EXPORT void
 zms_output_destroy(struct zms_output* output)
 {
   struct wl_resource *resource, *tmp;
+  struct zms_presentation_feedback *feedback, *feedback_tmp;
   // TODO: move mapped views to another output
 
+  wl_list_for_each_safe(
+      feedback, feedback_tmp, &output->priv->feedback_list, link)
+      zms_presentation_feedback_send_discarded(feedback);
+
   wl_resource_for_each_safe(resource, tmp, &output->priv->resource_list)
   {
     wl_resource_set_destructor(resource, NULL);
@@ -238,6 +306,9 @@ zms_output_destroy(struct zms_output* output)
   wl_list_remove(&output->link);
   wl_global_destroy(output->priv->global);
   free(output->pixel_buffers);
+  pixman_region32_fini(&output->priv->damage);
+  pixman_region32_fini(&output->priv->frame_damage);
+  zms_view_grid_destroy(output->priv->view_grid);
   free(output->priv->bg_buffer);
   free(output->priv->model);
   free(output->priv->manufacturer);
@@ -249,36 +320,165 @@ ZMS_EXPORT void
 zms_output_set_implementation(struct zms_output* output, void* user_data,
     const struct zms_output_interface* interface)
 {
+  // damage rendered before this is left to the first zms_output_repaint;
+  // the user may not be ready to repaint yet
   output->priv->user_data = user_data;
   output->priv->interface = interface;
 }
 
 ZMS_EXPORT struct zms_pixel_buffer*
-zms_output_buffer_ring_rotate(struct zms_output* output)
+zms_output_get_front_buffer(struct zms_output* output)
+{
+  return output->pixel_buffers[output->priv->front_buffer_index];
+}
+
+static void
+zms_output_update_frame_timing(
+    struct zms_output* output, uint32_t time, bool consecutive)
+{
+  struct zms_output_private* priv = output->priv;
+  struct zms_output_frame_timing* timing = &priv->frame_timing;
+  uint32_t interval = time - priv->last_frame_time;
+  bool first = timing->seq == 0;
+  uint64_t refresh_count = 1;
+
+  clock_gettime(CLOCK_MONOTONIC, &timing->timestamp);
+  priv->last_frame_time = time;
+
+  if (first || interval == 0) {
+    timing->seq++;
+    return;
+  }
+
+  if (consecutive) {
+    priv->frame_late =
+        priv->frame_interval_nsec > 0 &&
+        interval * 1000000.0 >
+            priv->frame_interval_nsec * ZMS_OUTPUT_LATE_FRAME_RATIO;
+  }
+
+  if (consecutive && interval <= ZMS_OUTPUT_MAX_FRAME_INTERVAL_MSEC) {
+    double interval_nsec = interval * 1000000.0;
+    if (priv->frame_interval_nsec == 0) {
+      priv->frame_interval_nsec = interval_nsec;
+    } else {
+      priv->frame_interval_nsec +=
+          (interval_nsec - priv->frame_interval_nsec) *
+          ZMS_OUTPUT_FRAME_INTERVAL_SMOOTHING;
+    }
+    timing->refresh_nsec = priv->frame_interval_nsec + 0.5;
+  }
+
+  // refresh cycles passed while idle are counted as well
+  if (timing->refresh_nsec > 0) {
+    uint64_t interval_nsec = (uint64_t)interval * 1000000;
+    refresh_count = (interval_nsec + timing->refresh_nsec / 2) /
+                    timing->refresh_nsec;
+    refresh_count = MAX(refresh_count, 1);
+  }
+
+  timing->seq += refresh_count;
+}
+
+/* Let clients pacing themselves from wl_output.mode render at the rate
+ * zigen actually shows frames at */
+static void
+zms_output_update_refresh(struct zms_output* output)
 {
-  struct zms_pixel_buffer *front, *back;
+  struct wl_resource* resource;
+  uint32_t refresh_nsec = output->priv->frame_timing.refresh_nsec;
+  int32_t refresh;
 
-  front = output->pixel_buffers[output->priv->back_buffer_index];
+  if (refresh_nsec == 0) return;
 
-  output->priv->back_buffer_index++;
-  if (output->priv->back_buffer_index == output->pixel_buffer_count)
-    output->priv->back_buffer_index = 0;
+  refresh = (1000000000000ull + refresh_nsec / 2) / refresh_nsec;
+  if (abs(refresh - output->priv->refresh) <= ZMS_OUTPUT_REFRESH_HYSTERESIS)
+    return;
 
-  back = output->pixel_buffers[output->priv->back_buffer_index];
+  output->priv->refresh = refresh;
 
-  // FIXME: dont need to do this if texture damage request exists
-  memcpy(back->priv->buffer, front->priv->buffer, back->size);
+  wl_resource_for_each(resource, &output->priv->resource_list)
+  {
+    zms_output_send_mode(output, resource);
+    if (wl_resource_get_version(resource) >= WL_OUTPUT_DONE_SINCE_VERSION)
+      wl_output_send_done(resource);
+  }
+}
 
-  return front;
+ZMS_EXPORT bool
+zms_output_needs_frame_timing(struct zms_output* output)
+{
+  return output->priv->frame_timing.refresh_nsec == 0 ||
+         output->priv->frame_late;
 }
 
 ZMS_EXPORT void
-zms_output_frame(struct zms_output* output, uint32_t time)
+zms_output_frame(struct zms_output* output, uint32_t time, bool consecutive)
 {
   struct zms_view_private* view_priv;
-  for (int i = 0; i < ZMS_OUTPUT_VIEW_LAYER_COUNT; i++)
+  struct zms_presentation_feedback *feedback, *tmp;
+
+  zms_trace_begin("output_frame");
+
+  output->priv->frame_count++;
+
+  zms_output_update_frame_timing(output, time, consecutive);
+  zms_output_update_refresh(output);
+
+  // this frame shows what the last zms_output_repaint composited
+  wl_list_for_each_safe(feedback, tmp, &output->priv->feedback_list, link)
+      zms_presentation_feedback_send_presented(feedback, output);
+
+  for (int i = 0; i < ZMS_OUTPUT_VIEW_LAYER_COUNT; i++) {
     zms_view_layer_for_each(view_priv, &output->priv->layers[i])
         zms_surface_send_frame_done(view_priv->surface, time);
+  }
+
+  zms_trace_end("output_frame");
+}
+
+static bool
+zms_output_has_cursor_overlay(struct zms_output* output)
+{
+  return output->priv->interface && output->priv->interface->update_cursor;
+}
+
+static bool
+zms_output_has_window_overlay(struct zms_output* output)
+{
+  const struct zms_output_interface* interface = output->priv->interface;
+
+  return interface && interface->map_window && interface->update_window &&
+         interface->unmap_window;
+}
+
+/* whether the view is drawn by the implementation instead of composited */
+static bool
+zms_output_is_window_overlay(struct zms_output* output, struct zms_view* view)
+{
+  return view->priv->layer_index == ZMS_OUTPUT_MAIN_LAYER_INDEX &&
+         zms_output_has_window_overlay(output);
+}
+
+/* whether the layer is composited into the pixel buffers */
+static bool
+zms_output_is_layer_composited(struct zms_output* output, int layer_index)
+{
+  switch (layer_index) {
+    case ZMS_OUTPUT_CURSOR_LAYER_INDEX:
+      return !zms_output_has_cursor_overlay(output);
+    case ZMS_OUTPUT_MAIN_LAYER_INDEX:
+      return !zms_output_has_window_overlay(output);
+    default:
+      return true;
+  }
+}
+
+static pid_t
+zms_output_get_view_client_pid(struct zms_view* view)
+{
+  return view->priv->surface ? zms_surface_get_client_pid(view->priv->surface)
+                             : 0;
 }
 
 ZMS_EXPORT void
@@ -289,13 +489,28 @@ zms_output_map_view(struct zms_output* output, struct zms_view* view,
 
   if (view->priv->output) zms_output_unmap_view(view->priv->output, view);
 
+  ZMS_PROBE4(view_map, zms_output_get_view_client_pid(view), layer_index,
+      zms_view_get_width(view), zms_view_get_height(view));
+
   view->priv->output = output;
+  view->priv->layer_index = layer_index;
+  view->priv->stacking_order = ++output->priv->last_stacking_order;
   wl_list_insert(
       &output->priv->layers[layer_index].view_list, &view->priv->link);
+  if (layer_index == ZMS_OUTPUT_MAIN_LAYER_INDEX)
+    zms_view_grid_insert(output->priv->view_grid, view);
+
+  if (zms_output_is_window_overlay(output, view)) {
+    pixman_region32_union_rect(&view->priv->window_damage,
+        &view->priv->window_damage, 0, 0, zms_view_get_width(view),
+        zms_view_get_height(view));
+    output->priv->interface->map_window(output->priv->user_data, output, view);
+    return;
+  }
 
   pixman_region32_init_view_global(&damage, view);
 
-  zms_output_render(output, &damage);
+  zms_output_damage_view(output, view, &damage, true);
 
   pixman_region32_fini(&damage);
 }
@@ -305,82 +520,589 @@ zms_output_unmap_view(struct zms_output* output, struct zms_view* view)
 {
   assert(output == view->priv->output);
   pixman_region32_t damage;
+  bool window_overlay;
 
   if (zms_view_is_mapped(view) == false) return;
 
+  ZMS_PROBE2(view_unmap, zms_output_get_view_client_pid(view),
+      view->priv->layer_index);
+
+  window_overlay = zms_output_is_window_overlay(output, view);
+  if (window_overlay) {
+    output->priv->interface->unmap_window(
+        output->priv->user_data, output, view);
+    pixman_region32_clear(&view->priv->window_damage);
+  }
+
+  pixman_region32_init_view_global(&damage, view);
+
+  if (view->priv->layer_index == ZMS_OUTPUT_MAIN_LAYER_INDEX)
+    zms_view_grid_remove(output->priv->view_grid, view);
+
   view->priv->output = NULL;
   wl_list_remove(&view->priv->link);
   wl_list_init(&view->priv->link);
 
-  pixman_region32_init_view_global(&damage, view);
-
-  zms_output_render(output, &damage);
+  if (window_overlay == false)
+    zms_output_damage_view(output, view, &damage, true);
 
   pixman_region32_fini(&damage);
   zms_signal_emit(&view->unmap_signal, NULL);
 }
 
-ZMS_EXPORT void
-zms_output_render(struct zms_output* output, pixman_region32_t* damage)
+/* Front to back pass to compute which part of each view is to be repainted.
+ * Stores it to zms_view_private.clip and returns the part of the damage not
+ * covered by any opaque view in background_clip. */
+static void
+zms_output_update_view_clips(struct zms_output* output,
+    pixman_region32_t* damage, pixman_region32_t* background_clip)
+{
+  struct zms_view_private* view_priv;
+  pixman_region32_t opaque_above, view_opaque;
+
+  pixman_region32_init(&opaque_above);
+
+  for (int i = 0; i < ZMS_OUTPUT_VIEW_LAYER_COUNT; i++) {
+    if (!zms_output_is_layer_composited(output, i)) continue;
+    wl_list_for_each(view_priv, &output->priv->layers[i].view_list, link)
+    {
+      struct zms_view* view = view_priv->pub;
+
+      pixman_region32_intersect_rect(&view_priv->clip, damage,
+          view_priv->origin[0], view_priv->origin[1],
+          zms_view_get_width(view), zms_view_get_height(view));
+      pixman_region32_subtract(
+          &view_priv->clip, &view_priv->clip, &opaque_above);
+
+      pixman_region32_init(&view_opaque);
+      pixman_region32_copy(&view_opaque, &view_priv->opaque);
+      pixman_region32_translate(
+          &view_opaque, view_priv->origin[0], view_priv->origin[1]);
+      pixman_region32_union(&opaque_above, &opaque_above, &view_opaque);
+
+      // e.g. a fullscreen video; copy its pixels instead of blending them
+      pixman_region32_subtract(&view_opaque, &view_priv->clip, &view_opaque);
+      view_priv->clip_opaque = !pixman_region32_not_empty(&view_opaque);
+
+      pixman_region32_fini(&view_opaque);
+    }
+  }
+
+  pixman_region32_subtract(background_clip, damage, &opaque_above);
+
+  pixman_region32_fini(&opaque_above);
+}
+
+/* Composites the background and the views into target_image, restricted to
+ * bounds. Expects the clips computed by zms_output_update_view_clips and the
+ * view transforms to be set. May run on a render thread. */
+static void
+zms_output_composite_bounds(struct zms_output* output,
+    pixman_image_t* target_image, pixman_region32_t* background_clip,
+    pixman_box32_t* bounds)
 {
   struct zms_view_private* view_priv;
   struct zms_view* view;
+  struct zms_buffer *buffer, *accessed = NULL;
   struct zms_screen_size size = output->priv->size;
-  pixman_image_t* target_image =
-      output->pixel_buffers[output->priv->back_buffer_index]->priv->image;
+  int32_t width = bounds->x2 - bounds->x1;
+  int32_t height = bounds->y2 - bounds->y1;
+  pixman_region32_t clip;
 
-  pixman_image_set_clip_region32(target_image, damage);
+  pixman_region32_init(&clip);
 
-  pixman_image_composite32(PIXMAN_OP_SRC, output->priv->bg_image, NULL,
-      target_image, 0, 0, 0, 0, 0, 0, size.width, size.height);
+  pixman_region32_intersect_rect(
+      &clip, background_clip, bounds->x1, bounds->y1, width, height);
 
-  pixman_image_set_clip_region32(target_image, NULL);
+  if (pixman_region32_not_empty(&clip)) {
+    pixman_image_set_clip_region32(target_image, &clip);
 
-  for (int i = ZMS_OUTPUT_MAIN_LAYER_INDEX; i >= ZMS_OUTPUT_CURSOR_LAYER_INDEX;
-       i--) {
+    pixman_image_composite32(PIXMAN_OP_SRC, output->priv->bg_image, NULL,
+        target_image, 0, 0, 0, 0, 0, 0, size.width, size.height);
+
+    pixman_image_set_clip_region32(target_image, NULL);
+  }
+
+  for (int i = ZMS_OUTPUT_VIEW_LAYER_COUNT - 1; i >= 0; i--) {
+    if (!zms_output_is_layer_composited(output, i)) continue;
     wl_list_for_each_reverse(
         view_priv, &output->priv->layers[i].view_list, link)
     {
-      pixman_region32_t view_region, repaint_region;
-      pixman_transform_t transform;
       view = view_priv->pub;
 
-      pixman_region32_init_view_global(&view_region, view);
-      pixman_region32_init(&repaint_region);
-      pixman_region32_intersect(&repaint_region, damage, &view_region);
+      pixman_region32_intersect_rect(
+          &clip, &view_priv->clip, bounds->x1, bounds->y1, width, height);
 
-      pixman_transform_init_view_global(&transform, view);
+      // occluded or out of the damage
+      if (!pixman_region32_not_empty(&clip)) continue;
 
-      pixman_image_set_clip_region32(target_image, &repaint_region);
+      pixman_image_set_clip_region32(target_image, &clip);
 
-      pixman_image_set_transform(view->priv->image, &transform);
+      /* libwayland allows accessing one pool at a time per thread; views
+       * from the same pool in a row share one access */
+      // no client memory is read for the view's own copy
+      buffer = view->priv->image_is_shadow ? NULL
+                                           : view->priv->buffer_ref.buffer;
+      if (accessed && buffer && accessed->shm_pool != buffer->shm_pool) {
+        wl_shm_buffer_end_access(accessed->shm_buffer);
+        accessed = NULL;
+      }
+      if (accessed == NULL && buffer) {
+        wl_shm_buffer_begin_access(buffer->shm_buffer);
+        accessed = buffer;
+      }
 
-      wl_shm_buffer_begin_access(
-          wl_shm_buffer_get(view->priv->buffer_ref.buffer->resource));
+      pixman_image_composite32(
+          view_priv->clip_opaque ? PIXMAN_OP_SRC : PIXMAN_OP_OVER,
+          view->priv->image, NULL, target_image, 0, 0, 0, 0, 0, 0, size.width,
+          size.height);
 
-      pixman_image_composite32(PIXMAN_OP_OVER, view->priv->image, NULL,
-          target_image, 0, 0, 0, 0, 0, 0, size.width, size.height);
+      pixman_image_set_clip_region32(target_image, NULL);
+    }
+  }
 
-      wl_shm_buffer_end_access(
-          wl_shm_buffer_get(view->priv->buffer_ref.buffer->resource));
+  if (accessed) wl_shm_buffer_end_access(accessed->shm_buffer);
 
-      pixman_image_set_clip_region32(target_image, NULL);
+  pixman_region32_fini(&clip);
+}
+
+struct zms_output_tile_job_data {
+  struct zms_output* output;
+  pixman_image_t* target_image;
+  pixman_region32_t* background_clip;
+  pixman_box32_t* tiles;
+};
+
+static void
+zms_output_composite_tile(void* data, int index)
+{
+  struct zms_output_tile_job_data* job = data;
+  pixman_image_t* tile_image;
+
+  // each thread needs its own destination image to have its own clip
+  tile_image = pixman_image_create_bits(
+      pixman_image_get_format(job->target_image),
+      pixman_image_get_width(job->target_image),
+      pixman_image_get_height(job->target_image),
+      pixman_image_get_data(job->target_image),
+      pixman_image_get_stride(job->target_image));
+  if (tile_image == NULL) {
+    zms_log("failed to create a tile image\n");
+    return;
+  }
+
+  zms_trace_begin("output_composite_tile");
+  zms_output_composite_bounds(
+      job->output, tile_image, job->background_clip, &job->tiles[index]);
+  zms_trace_end("output_composite_tile");
+
+  pixman_image_unref(tile_image);
+}
+
+static void
+zms_output_composite_tiled(struct zms_output* output,
+    struct zms_render_pool* pool, pixman_image_t* target_image,
+    pixman_region32_t* damage, pixman_region32_t* background_clip)
+{
+  struct zms_output_tile_job_data job;
+  struct zms_view_private* view_priv;
+  struct zms_screen_size size = output->priv->size;
+  int columns = (size.width + ZMS_OUTPUT_RENDER_TILE_SIZE - 1) /
+                ZMS_OUTPUT_RENDER_TILE_SIZE;
+  int rows = (size.height + ZMS_OUTPUT_RENDER_TILE_SIZE - 1) /
+             ZMS_OUTPUT_RENDER_TILE_SIZE;
+  pixman_box32_t* tiles;
+  int tile_count = 0;
+
+  tiles = malloc(sizeof(*tiles) * columns * rows);
+  if (tiles == NULL) {
+    zms_log("failed to allocate memory\n");
+    return;
+  }
+
+  for (int y = 0; y < rows; y++) {
+    for (int x = 0; x < columns; x++) {
+      pixman_box32_t* tile = &tiles[tile_count];
+      tile->x1 = x * ZMS_OUTPUT_RENDER_TILE_SIZE;
+      tile->y1 = y * ZMS_OUTPUT_RENDER_TILE_SIZE;
+      tile->x2 = MIN(tile->x1 + ZMS_OUTPUT_RENDER_TILE_SIZE, size.width);
+      tile->y2 = MIN(tile->y1 + ZMS_OUTPUT_RENDER_TILE_SIZE, size.height);
+      if (pixman_region32_contains_rectangle(damage, tile) != PIXMAN_REGION_OUT)
+        tile_count++;
+    }
+  }
+
+  /* pixman validates an image lazily on its first composite; do it here so
+   * that the render threads only read the shared source images. */
+  pixman_image_composite32(PIXMAN_OP_SRC, output->priv->bg_image, NULL,
+      target_image, 0, 0, 0, 0, 0, 0, 0, 0);
+  for (int i = ZMS_OUTPUT_VIEW_LAYER_COUNT - 1; i >= 0; i--) {
+    if (!zms_output_is_layer_composited(output, i)) continue;
+    zms_view_layer_for_each(view_priv, &output->priv->layers[i])
+    {
+      if (!pixman_region32_not_empty(&view_priv->clip)) continue;
+      pixman_image_composite32(
+          view_priv->clip_opaque ? PIXMAN_OP_SRC : PIXMAN_OP_OVER,
+          view_priv->image, NULL, target_image, 0, 0, 0, 0, 0, 0, 0, 0);
+    }
+  }
+
+  job.output = output;
+  job.target_image = target_image;
+  job.background_clip = background_clip;
+  job.tiles = tiles;
 
-      pixman_region32_fini(&view_region);
-      pixman_region32_fini(&repaint_region);
+  zms_render_pool_run(pool, tile_count, zms_output_composite_tile, &job);
+
+  free(tiles);
+}
+
+static void
+zms_output_composite(struct zms_output* output, pixman_region32_t* damage,
+    struct zms_pixel_buffer* back_buffer)
+{
+  struct zms_view_private* view_priv;
+  struct zms_render_pool* pool = output->priv->compositor->priv->render_pool;
+  struct zms_screen_size size = output->priv->size;
+  pixman_image_t* target_image = back_buffer->priv->image;
+  pixman_region32_t background_clip;
+  pixman_box32_t output_box = {0, 0, size.width, size.height};
+
+  pixman_region32_init(&background_clip);
+  zms_output_update_view_clips(output, damage, &background_clip);
+
+  for (int i = ZMS_OUTPUT_VIEW_LAYER_COUNT - 1; i >= 0; i--) {
+    if (!zms_output_is_layer_composited(output, i)) continue;
+    zms_view_layer_for_each(view_priv, &output->priv->layers[i])
+    {
+      pixman_transform_t transform;
+      if (!pixman_region32_not_empty(&view_priv->clip)) continue;
+      pixman_transform_init_view_global(&transform, view_priv->pub);
+      pixman_image_set_transform(view_priv->image, &transform);
     }
   }
 
+  if (pool) {
+    zms_output_composite_tiled(
+        output, pool, target_image, damage, &background_clip);
+  } else {
+    zms_output_composite_bounds(
+        output, target_image, &background_clip, &output_box);
+  }
+
+  pixman_region32_fini(&background_clip);
+
+  for (int i = 0; i < ZMS_OUTPUT_VIEW_LAYER_COUNT; i++) {
+    zms_view_layer_for_each(view_priv, &output->priv->layers[i])
+        pixman_region32_clear(&view_priv->clip);
+  }
+
+  for (int i = 0; i < output->pixel_buffer_count; i++) {
+    struct zms_pixel_buffer* pixel_buffer = output->pixel_buffers[i];
+    if (pixel_buffer == back_buffer) continue;
+    pixman_region32_union(
+        &pixel_buffer->priv->damage, &pixel_buffer->priv->damage, damage);
+  }
+}
+
+ZMS_EXPORT void
+zms_output_render(struct zms_output* output, pixman_region32_t* damage)
+{
+  bool scheduled = pixman_region32_not_empty(&output->priv->damage);
+
+  zms_trace_begin("output_render");
+  ZMS_PROBE2(output_render, pixman_region32_n_rects(damage),
+      pixman_region32_area(damage));
+
+  pixman_region32_union(&output->priv->damage, &output->priv->damage, damage);
+
+  if (!scheduled && pixman_region32_not_empty(&output->priv->damage) &&
+      output->priv->interface)
+    output->priv->interface->schedule_repaint(output->priv->user_data, output);
+
+  zms_trace_end("output_render");
+}
+
+ZMS_EXPORT void
+zms_output_schedule_repaint(struct zms_output* output)
+{
+  // otherwise already scheduled by zms_output_render
+  if (pixman_region32_not_empty(&output->priv->damage)) return;
+
   if (output->priv->interface)
     output->priv->interface->schedule_repaint(output->priv->user_data, output);
 }
 
+ZMS_EXPORT void
+zms_output_damage_view(struct zms_output* output, struct zms_view* view,
+    pixman_region32_t* damage, bool content_changed)
+{
+  if (view->priv->layer_index == ZMS_OUTPUT_CURSOR_LAYER_INDEX &&
+      zms_output_has_cursor_overlay(output)) {
+    output->priv->interface->update_cursor(
+        output->priv->user_data, output, content_changed);
+    return;
+  }
+
+  if (zms_output_is_window_overlay(output, view)) {
+    if (content_changed) {
+      pixman_region32_t local_damage;
+      pixman_region32_init(&local_damage);
+      pixman_region32_copy(&local_damage, damage);
+      pixman_region32_translate(
+          &local_damage, -view->priv->origin[0], -view->priv->origin[1]);
+      pixman_region32_union(&view->priv->window_damage,
+          &view->priv->window_damage, &local_damage);
+      pixman_region32_fini(&local_damage);
+    }
+    output->priv->interface->update_window(
+        output->priv->user_data, output, view, content_changed);
+    return;
+  }
+
+  zms_output_render(output, damage);
+}
+
+/* Whether the implementation still reads a part of the pixel buffer that a
+ * repaint into it would write to */
+static bool
+zms_output_is_pixel_buffer_busy(
+    struct zms_output* output, struct zms_pixel_buffer* pixel_buffer)
+{
+  const struct zms_output_interface* interface = output->priv->interface;
+  pixman_region32_t region;
+  pixman_box32_t* rects;
+  int n_rects;
+  bool busy = false;
+
+  if (interface == NULL || interface->is_pixel_buffer_busy == NULL)
+    return false;
+
+  pixman_region32_init(&region);
+  pixman_region32_union(
+      &region, &output->priv->damage, &pixel_buffer->priv->damage);
+
+  rects = pixman_region32_rectangles(&region, &n_rects);
+  for (int i = 0; i < n_rects && busy == false; i++) {
+    busy = interface->is_pixel_buffer_busy(output->priv->user_data, output,
+        pixel_buffer, rects[i].x1, rects[i].y1, rects[i].x2 - rects[i].x1,
+        rects[i].y2 - rects[i].y1);
+  }
+
+  pixman_region32_fini(&region);
+
+  return busy;
+}
+
+/* Everything committed so far is in the front buffer once a repaint is
+ * done, to be shown on the next frame */
+static void
+zms_output_queue_presentation_feedback(struct zms_output* output)
+{
+  struct zms_view_private* view_priv;
+
+  for (int i = 0; i < ZMS_OUTPUT_VIEW_LAYER_COUNT; i++) {
+    zms_view_layer_for_each(view_priv, &output->priv->layers[i])
+    {
+      wl_list_insert_list(
+          &output->priv->feedback_list, &view_priv->surface->feedback_list);
+      wl_list_init(&view_priv->surface->feedback_list);
+    }
+  }
+}
+
+ZMS_EXPORT bool
+zms_output_repaint(struct zms_output* output)
+{
+  struct zms_pixel_buffer *front, *back = NULL;
+  struct zms_metrics* metrics = &output->priv->compositor->priv->metrics;
+  int back_index = output->priv->front_buffer_index;
+  uint64_t copied_bytes, pixels;
+
+  pixman_region32_clear(&output->priv->frame_damage);
+
+  if (!pixman_region32_not_empty(&output->priv->damage)) {
+    // commits without damage are shown as they are
+    zms_output_queue_presentation_feedback(output);
+    return true;
+  }
+
+  // the oldest buffer first, so that the ring is used evenly
+  for (int i = 1; i < output->pixel_buffer_count; i++) {
+    int index = (output->priv->front_buffer_index + i) %
+                output->pixel_buffer_count;
+    if (zms_output_is_pixel_buffer_busy(output, output->pixel_buffers[index]))
+      continue;
+    back_index = index;
+    back = output->pixel_buffers[index];
+    break;
+  }
+
+  // the damage is kept and composited with newer damage later
+  if (back == NULL) return false;
+
+  zms_trace_begin("output_repaint");
+  zms_trace_counter(
+      "output_damage_rects", pixman_region32_n_rects(&output->priv->damage));
+
+  front = zms_output_get_front_buffer(output);
+
+  // bring the back buffer up to date by copying only what it has missed
+  if (pixman_region32_not_empty(&back->priv->damage)) {
+    copied_bytes =
+        pixman_region32_area(&back->priv->damage) * sizeof(struct zms_bgra);
+    metrics->copied_bytes += copied_bytes;
+    ZMS_PROBE2(buffer_rotate, back_index, copied_bytes);
+
+    pixman_image_set_clip_region32(back->priv->image, &back->priv->damage);
+
+    pixman_image_composite32(PIXMAN_OP_SRC, front->priv->image, NULL,
+        back->priv->image, 0, 0, 0, 0, 0, 0, back->width, back->height);
+
+    pixman_image_set_clip_region32(back->priv->image, NULL);
+    pixman_region32_clear(&back->priv->damage);
+  }
+
+  pixels = pixman_region32_area(&output->priv->damage);
+  output->priv->repaint_count++;
+  output->priv->composited_pixels += pixels;
+  metrics->composited_pixels += pixels;
+  ZMS_PROBE3(output_repaint, back_index,
+      pixman_region32_n_rects(&output->priv->damage), pixels);
+  zms_output_composite(output, &output->priv->damage, back);
+
+  output->priv->front_buffer_index = back_index;
+  pixman_region32_copy(&output->priv->frame_damage, &output->priv->damage);
+  pixman_region32_clear(&output->priv->damage);
+
+  zms_output_queue_presentation_feedback(output);
+
+  zms_trace_end("output_repaint");
+
+  return true;
+}
+
+ZMS_EXPORT bool
+zms_output_frame_damage_intersects(struct zms_output* output, int32_t x,
+    int32_t y, uint32_t width, uint32_t height)
+{
+  pixman_box32_t box = {x, y, x + width, y + height};
+
+  return pixman_region32_contains_rectangle(
+             &output->priv->frame_damage, &box) != PIXMAN_REGION_OUT;
+}
+
+ZMS_EXPORT uint64_t
+zms_output_get_frame_damage_area(struct zms_output* output, int32_t x,
+    int32_t y, uint32_t width, uint32_t height)
+{
+  pixman_region32_t region;
+  uint64_t area;
+
+  pixman_region32_init(&region);
+  pixman_region32_intersect_rect(
+      &region, &output->priv->frame_damage, x, y, width, height);
+  area = pixman_region32_area(&region);
+  pixman_region32_fini(&region);
+
+  return area;
+}
+
+static struct zms_view*
+zms_output_get_cursor_view(struct zms_output* output)
+{
+  struct zms_view_private* view_priv;
+
+  zms_view_layer_for_each(
+      view_priv, &output->priv->layers[ZMS_OUTPUT_CURSOR_LAYER_INDEX])
+  {
+    if (zms_view_has_image(view_priv->pub)) return view_priv->pub;
+  }
+
+  return NULL;
+}
+
+ZMS_EXPORT bool
+zms_output_get_cursor(struct zms_output* output, int32_t* x, int32_t* y,
+    uint32_t* width, uint32_t* height)
+{
+  struct zms_view* view = zms_output_get_cursor_view(output);
+
+  if (view == NULL) return false;
+
+  *x = view->priv->origin[0];
+  *y = view->priv->origin[1];
+  *width = zms_view_get_width(view);
+  *height = zms_view_get_height(view);
+
+  return true;
+}
+
+ZMS_EXPORT bool
+zms_output_read_cursor_image(
+    struct zms_output* output, void* data, uint32_t stride)
+{
+  struct zms_view* view = zms_output_get_cursor_view(output);
+  struct zms_buffer* buffer;
+  pixman_image_t* image;
+  uint32_t width, height;
+
+  if (view == NULL) return false;
+
+  width = zms_view_get_width(view);
+  height = zms_view_get_height(view);
+
+  image = pixman_image_create_bits(
+      PIXMAN_a8r8g8b8, width, height, (uint32_t*)data, stride);
+  if (image == NULL) return false;
+
+  // no client memory is read for the view's own copy
+  buffer = view->priv->image_is_shadow ? NULL : view->priv->buffer_ref.buffer;
+
+  // zms_output_composite sets the transform again before using it
+  pixman_image_set_transform(view->priv->image, NULL);
+
+  if (buffer) wl_shm_buffer_begin_access(buffer->shm_buffer);
+
+  pixman_image_composite32(PIXMAN_OP_SRC, view->priv->image, NULL, image, 0, 0,
+      0, 0, 0, 0, width, height);
+
+  if (buffer) wl_shm_buffer_end_access(buffer->shm_buffer);
+
+  pixman_image_unref(image);
+
+  return true;
+}
+
+ZMS_EXPORT uint64_t
+zms_output_get_cursor_buffer_id(struct zms_output* output)
+{
+  struct zms_view* view = zms_output_get_cursor_view(output);
+
+  if (view == NULL || view->priv->buffer_ref.buffer == NULL) return 0;
+
+  return view->priv->buffer_ref.buffer->id;
+}
+
+ZMS_EXPORT void
+zms_output_update_view_geometry(
+    struct zms_output* output, struct zms_view* view)
+{
+  if (view->priv->layer_index == ZMS_OUTPUT_MAIN_LAYER_INDEX)
+    zms_view_grid_update(output->priv->view_grid, view);
+}
+
 ZMS_EXPORT struct zms_view*
 zms_output_pick_view(
     struct zms_output* output, float x, float y, float* vx, float* vy)
 {
   struct zms_view_private* view_priv;
   struct zms_view* view;
+
+  if (zms_view_grid_contains(output->priv->view_grid, x, y))
+    return zms_view_grid_pick(output->priv->view_grid, x, y, vx, vy);
+
+  // out of the output
   wl_list_for_each(view_priv,
       &output->priv->layers[ZMS_OUTPUT_MAIN_LAYER_INDEX].view_list, link)
   {
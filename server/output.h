@@ -2,9 +2,11 @@
 #define ZMONITORS_SERVER_OUTPUT_H
 
 #include <pixman-1/pixman.h>
+#include <time.h>
 #include <zmonitors-server.h>
 
 #include "compositor.h"
+#include "view-grid.h"
 #include "view-layer.h"
 
 // ordered from top to bottom
@@ -15,6 +17,13 @@ enum zms_output_view_layer_index {
 
 #define ZMS_OUTPUT_VIEW_LAYER_COUNT 2
 
+// when the last frame was shown, measured from zigen frame callbacks
+struct zms_output_frame_timing {
+  struct timespec timestamp;  // CLOCK_MONOTONIC
+  uint32_t refresh_nsec;      // 0 if not known yet
+  uint64_t seq;               // refresh cycles counted so far
+};
+
 struct zms_output_private {
   void* user_data;
   const struct zms_output_interface* interface;
@@ -27,10 +36,32 @@ struct zms_output_private {
   char* manufacturer;
   char* model;
 
-  int back_buffer_index;
+  // the pixel buffer having the newest frame
+  int front_buffer_index;
+
+  // output global coordinates, composited on the next zms_output_repaint
+  pixman_region32_t damage;
+  // output global coordinates, composited by the last zms_output_repaint
+  pixman_region32_t frame_damage;
+  // zms_presentation_feedback.link; composited, presented on the next frame
+  struct wl_list feedback_list;
+
+  struct zms_output_frame_timing frame_timing;
+  uint32_t last_frame_time;    // in milliseconds, from zigen
+  double frame_interval_nsec;  // smoothed, 0 if not measured yet
+  bool frame_late;  // the last back-to-back frame came later than expected
+  int32_t refresh;             // in mHz, as sent by wl_output.mode
+
+  // metrics; see zms_metrics
+  uint64_t frame_count;
+  uint64_t repaint_count;
+  uint64_t composited_pixels;
 
   struct wl_list resource_list;
   struct zms_view_layer layers[ZMS_OUTPUT_VIEW_LAYER_COUNT];
+  uint64_t last_stacking_order;
+  // views of the main layer, for zms_output_pick_view
+  struct zms_view_grid* view_grid;
 
   struct zms_bgra* bg_buffer;
   pixman_image_t* bg_image;
@@ -42,8 +73,23 @@ void zms_output_map_view(struct zms_output* output,
 
 void zms_output_unmap_view(struct zms_output* output, struct zms_view* view);
 
+/* Add damage to be composited on the next repaint. The views are read at
+ * that time, so the newest content committed within a frame is shown. */
 void zms_output_render(struct zms_output* output, pixman_region32_t* damage);
 
+/* Repaint even without damage, e.g. to present a commit that changed
+ * nothing visible */
+void zms_output_schedule_repaint(struct zms_output* output);
+
+/* Damage caused by the view. Same as zms_output_render unless the view is
+ * shown outside of the pixel buffers, e.g. on a cursor overlay. */
+void zms_output_damage_view(struct zms_output* output, struct zms_view* view,
+    pixman_region32_t* damage, bool content_changed);
+
+/* Call after a mapped view moved or resized */
+void zms_output_update_view_geometry(
+    struct zms_output* output, struct zms_view* view);
+
 struct zms_view* zms_output_pick_view(
     struct zms_output* output, float x, float y, float* vx, float* vy);
 
@@ -33,6 +33,7 @@ zms_pixel_buffer_create(uint32_t width, uint32_t height, void *user_data)
 
   priv->buffer = buffer;
   priv->image = image;
+  pixman_region32_init(&priv->damage);
   pixel_buffer->priv = priv;
   pixel_buffer->fd = fd;
   pixel_buffer->width = width;
@@ -62,6 +63,7 @@ err:
 ZMS_EXPORT void
 zms_pixel_buffer_destroy(struct zms_pixel_buffer *pixel_buffer)
 {
+  pixman_region32_fini(&pixel_buffer->priv->damage);
   pixman_image_unref(pixel_buffer->priv->image);
   munmap(pixel_buffer->priv->buffer, pixel_buffer->size);
   close(pixel_buffer->fd);
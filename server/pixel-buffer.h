@@ -7,6 +7,9 @@
 struct zms_pixel_buffer_private {
   void *buffer;
   pixman_image_t *image;
+
+  // damage rendered into other buffers since this one was the back buffer
+  pixman_region32_t damage;
 };
 
 void zms_pixel_buffer_destroy(struct zms_pixel_buffer *pixel_buffer);
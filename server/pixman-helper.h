@@ -2,6 +2,7 @@
 #define ZMONITORS_PIXMAN_HELPER_H
 
 #include <pixman-1/pixman.h>
+#include <stdint.h>
 
 #include "view.h"
 
@@ -14,6 +15,37 @@ pixman_region32_init_view_global(
       zms_view_get_height(view));
 }
 
+/* Clients often send INT32_MAX as the size to cover the whole surface, so
+ * the far edges are clamped instead of overflowing. width and height must be
+ * positive. */
+static inline void
+pixman_region32_init_rect_clamped(pixman_region32_t *region, int32_t x,
+    int32_t y, int32_t width, int32_t height)
+{
+  pixman_box32_t box;
+
+  box.x1 = x;
+  box.y1 = y;
+  box.x2 = MIN((int64_t)x + width, INT32_MAX);
+  box.y2 = MIN((int64_t)y + height, INT32_MAX);
+
+  pixman_region32_init_with_extents(region, &box);
+}
+
+static inline uint64_t
+pixman_region32_area(pixman_region32_t *region)
+{
+  pixman_box32_t *rects;
+  int n_rects;
+  uint64_t area = 0;
+
+  rects = pixman_region32_rectangles(region, &n_rects);
+  for (int i = 0; i < n_rects; i++)
+    area += (uint64_t)(rects[i].x2 - rects[i].x1) * (rects[i].y2 - rects[i].y1);
+
+  return area;
+}
+
 static inline void
 pixman_transform_init_view_global(
     pixman_transform_t *transform, struct zms_view *view)
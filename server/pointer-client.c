@@ -84,6 +84,7 @@ static struct zms_pointer_client *
 zms_pointer_client_create(struct wl_client *client, struct zms_pointer *pointer)
 {
   struct zms_pointer_client *pointer_client;
+  struct zms_view *focus_view;
 
   pointer_client = zalloc(sizeof *pointer_client);
   if (pointer_client == NULL) {
@@ -105,6 +106,12 @@ zms_pointer_client_create(struct wl_client *client, struct zms_pointer *pointer)
 
   wl_list_init(&pointer_client->resource_list);
 
+  // the client bound the pointer after its view got the focus
+  focus_view = pointer->focus_view_ref.data;
+  if (focus_view &&
+      wl_resource_get_client(focus_view->priv->surface->resource) == client)
+    pointer->focus_client = pointer_client;
+
   return pointer_client;
 
 err:
@@ -124,6 +131,9 @@ zms_pointer_client_destroy(struct zms_pointer_client *pointer_client)
     wl_list_remove(wl_resource_get_link(resource));
   }
 
+  if (pointer_client->pointer->focus_client == pointer_client)
+    pointer_client->pointer->focus_client = NULL;
+
   wl_list_remove(&pointer_client->link);
   wl_list_remove(&pointer_client->pointer_destroy_listener.link);
   wl_list_remove(&pointer_client->client_destroy_listener.link);
@@ -177,7 +187,17 @@ ZMS_EXPORT struct zms_pointer_client *
 zms_pointer_client_find(struct wl_client *client, struct zms_pointer *pointer)
 {
   struct zms_pointer_client *pointer_client;
+  struct wl_listener *listener;
+
+  // every pointer client listens to the destruction of its wl_client
+  listener = wl_client_get_destroy_listener(client, client_destroy_handler);
+  if (listener) {
+    pointer_client =
+        wl_container_of(listener, pointer_client, client_destroy_listener);
+    if (pointer_client->pointer == pointer) return pointer_client;
+  }
 
+  // the client has pointer clients for multiple pointers
   wl_list_for_each(pointer_client, &pointer->point_client_list, link)
   {
     if (pointer_client->client == client) return pointer_client;
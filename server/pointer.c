@@ -14,15 +14,9 @@ static void
 zms_pointer_send_motion(struct zms_pointer* pointer, uint32_t time)
 {
   struct zms_view* view = pointer->focus_view_ref.data;
-  struct wl_client* client;
-  struct zms_pointer_client* pointer_client;
-
-  if (view == NULL) return;
+  struct zms_pointer_client* pointer_client = pointer->focus_client;
 
-  client = wl_resource_get_client(view->priv->surface->resource);
-  pointer_client = zms_pointer_client_find(client, pointer);
-
-  if (pointer_client == NULL) return;
+  if (view == NULL || pointer_client == NULL) return;
 
   zms_pointer_client_send_motion(
       pointer_client, time, pointer->vx, pointer->vy);
@@ -65,19 +59,13 @@ default_grab_button(struct zms_pointer_grab* grab, uint32_t time,
   struct zms_pointer* pointer = grab->pointer;
   struct zms_keyboard* keyboard = pointer->seat->priv->keyboard;
   struct zms_view* view = pointer->focus_view_ref.data;
-  struct wl_client* client;
-  struct zms_pointer_client* pointer_client;
+  struct zms_pointer_client* pointer_client = pointer->focus_client;
 
   if (keyboard && pointer->button_count == 1 &&
       state == WL_POINTER_BUTTON_STATE_PRESSED)
     zms_keyboard_set_focus(keyboard, view);
 
-  if (view == NULL) return;
-
-  client = wl_resource_get_client(view->priv->surface->resource);
-  pointer_client = zms_pointer_client_find(client, pointer);
-
-  if (pointer_client == NULL) return;
+  if (view == NULL || pointer_client == NULL) return;
 
   zms_pointer_client_send_button(pointer_client, serial, time, button, state);
 
@@ -113,6 +101,7 @@ zms_pointer_create(struct zms_seat* seat)
   pointer->default_grab.pointer = pointer;
   wl_list_init(&pointer->point_client_list);
   zms_weak_ref_init(&pointer->focus_view_ref);
+  pointer->focus_client = NULL;
   zms_weak_ref_init(&pointer->sprite_ref);
   zms_signal_init(&pointer->destroy_signal);
   zms_signal_init(&pointer->moved_signal);
@@ -150,8 +139,7 @@ zms_pointer_set_focus(struct zms_pointer* pointer,
     struct zms_pointer_client* pointer_client;
     pointer->enter_serial = 0;
 
-    client = wl_resource_get_client(current_focus->priv->surface->resource);
-    pointer_client = zms_pointer_client_find(client, pointer);
+    pointer_client = pointer->focus_client;
     zms_pointer_set_cursor(pointer, NULL, 0, 0);
     if (pointer_client) {
       zms_pointer_client_send_leave(
@@ -159,6 +147,8 @@ zms_pointer_set_focus(struct zms_pointer* pointer,
     }
   }
 
+  pointer->focus_client = NULL;
+
   if (view) {
     struct zms_pointer_client* pointer_client;
     uint32_t serial = wl_display_next_serial(display);
@@ -166,6 +156,7 @@ zms_pointer_set_focus(struct zms_pointer* pointer,
 
     client = wl_resource_get_client(view->priv->surface->resource);
     pointer_client = zms_pointer_client_find(client, pointer);
+    pointer->focus_client = pointer_client;
     if (pointer_client) {
       zms_pointer_client_send_enter(
           pointer_client, serial, view->priv->surface, vx, vy);
@@ -36,6 +36,9 @@ struct zms_pointer {
   struct wl_list point_client_list;
 
   struct zms_weak_ref focus_view_ref; /** keeps *mapped* view */
+  /* pointer client of the focus view's client, looked up when the focus
+   * changes. nullable. valid only when focus_view_ref.data is not null. */
+  struct zms_pointer_client* focus_client;
   float vx, vy;
   uint32_t enter_serial;
 
@@ -0,0 +1,90 @@
+#include "presentation-feedback.h"
+
+#include <presentation-time-server-protocol.h>
+#include <zmonitors-server.h>
+
+static void zms_presentation_feedback_destroy(
+    struct zms_presentation_feedback* feedback);
+
+static void
+zms_presentation_feedback_handle_destroy(struct wl_resource* resource)
+{
+  struct zms_presentation_feedback* feedback;
+
+  feedback = wl_resource_get_user_data(resource);
+
+  zms_presentation_feedback_destroy(feedback);
+}
+
+ZMS_EXPORT struct zms_presentation_feedback*
+zms_presentation_feedback_create(struct wl_client* client, uint32_t id)
+{
+  struct zms_presentation_feedback* feedback;
+  struct wl_resource* resource;
+
+  feedback = zalloc(sizeof *feedback);
+  if (feedback == NULL) {
+    wl_client_post_no_memory(client);
+    goto err;
+  }
+
+  resource =
+      wl_resource_create(client, &wp_presentation_feedback_interface, 1, id);
+  if (resource == NULL) {
+    wl_client_post_no_memory(client);
+    goto err_resource;
+  }
+
+  feedback->resource = resource;
+  wl_list_init(&feedback->link);
+
+  wl_resource_set_implementation(
+      resource, NULL, feedback, zms_presentation_feedback_handle_destroy);
+
+  return feedback;
+
+err_resource:
+  free(feedback);
+
+err:
+  return NULL;
+}
+
+static void
+zms_presentation_feedback_destroy(struct zms_presentation_feedback* feedback)
+{
+  wl_list_remove(&feedback->link);
+  free(feedback);
+}
+
+ZMS_EXPORT void
+zms_presentation_feedback_send_presented(
+    struct zms_presentation_feedback* feedback, struct zms_output* output)
+{
+  struct zms_output_frame_timing* timing = &output->priv->frame_timing;
+  struct wl_client* client = wl_resource_get_client(feedback->resource);
+  struct wl_resource* output_resource;
+  uint64_t tv_sec = timing->timestamp.tv_sec;
+
+  wl_resource_for_each(output_resource, &output->priv->resource_list)
+  {
+    if (wl_resource_get_client(output_resource) != client) continue;
+    wp_presentation_feedback_send_sync_output(
+        feedback->resource, output_resource);
+  }
+
+  // zigen tells nothing about how the frame was shown; no flags are set
+  wp_presentation_feedback_send_presented(feedback->resource, tv_sec >> 32,
+      tv_sec & 0xffffffff, timing->timestamp.tv_nsec, timing->refresh_nsec,
+      timing->seq >> 32, timing->seq & 0xffffffff, 0);
+
+  wl_resource_destroy(feedback->resource);
+}
+
+ZMS_EXPORT void
+zms_presentation_feedback_send_discarded(
+    struct zms_presentation_feedback* feedback)
+{
+  wp_presentation_feedback_send_discarded(feedback->resource);
+  wl_resource_destroy(feedback->resource);
+}
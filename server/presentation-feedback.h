@@ -0,0 +1,23 @@
+#ifndef ZMONITORS_SERVER_PRESENTATION_FEEDBACK_H
+#define ZMONITORS_SERVER_PRESENTATION_FEEDBACK_H
+
+#include <wayland-server.h>
+
+#include "output.h"
+
+struct zms_presentation_feedback {
+  struct wl_resource* resource;
+  struct wl_list link;
+};
+
+struct zms_presentation_feedback* zms_presentation_feedback_create(
+    struct wl_client* client, uint32_t id);
+
+/* Both destroy the feedback */
+void zms_presentation_feedback_send_presented(
+    struct zms_presentation_feedback* feedback, struct zms_output* output);
+
+void zms_presentation_feedback_send_discarded(
+    struct zms_presentation_feedback* feedback);
+
+#endif  //  ZMONITORS_SERVER_PRESENTATION_FEEDBACK_H
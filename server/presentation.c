@@ -0,0 +1,97 @@
+#include "presentation.h"
+
+#include <presentation-time-server-protocol.h>
+#include <time.h>
+#include <zmonitors-server.h>
+
+#include "presentation-feedback.h"
+#include "surface.h"
+
+static void
+zms_presentation_protocol_destroy(
+    struct wl_client* client, struct wl_resource* resource)
+{
+  Z_UNUSED(client);
+  wl_resource_destroy(resource);
+}
+
+static void
+zms_presentation_protocol_feedback(struct wl_client* client,
+    struct wl_resource* resource, struct wl_resource* surface_resource,
+    uint32_t callback)
+{
+  Z_UNUSED(resource);
+  struct zms_surface* surface;
+  struct zms_presentation_feedback* feedback;
+
+  surface = wl_resource_get_user_data(surface_resource);
+
+  feedback = zms_presentation_feedback_create(client, callback);
+  if (feedback == NULL) return;
+
+  wl_list_insert(surface->pending.feedback_list.prev, &feedback->link);
+}
+
+static const struct wp_presentation_interface presentation_interface = {
+    .destroy = zms_presentation_protocol_destroy,
+    .feedback = zms_presentation_protocol_feedback,
+};
+
+static void
+zms_presentation_bind(
+    struct wl_client* client, void* data, uint32_t version, uint32_t id)
+{
+  struct zms_presentation* presentation = data;
+  struct wl_resource* resource;
+
+  resource =
+      wl_resource_create(client, &wp_presentation_interface, version, id);
+  if (resource == NULL) {
+    wl_client_post_no_memory(client);
+    return;
+  }
+
+  wl_resource_set_implementation(
+      resource, &presentation_interface, presentation, NULL);
+
+  // the clock of zms_output_frame_timing.timestamp
+  wp_presentation_send_clock_id(resource, CLOCK_MONOTONIC);
+}
+
+ZMS_EXPORT struct zms_presentation*
+zms_presentation_create(struct zms_compositor* compositor)
+{
+  struct zms_presentation* presentation;
+  struct wl_global* global;
+
+  presentation = zalloc(sizeof *presentation);
+  if (presentation == NULL) {
+    zms_log("failed to allocate memory\n");
+    goto err;
+  }
+
+  global = wl_global_create(compositor->display, &wp_presentation_interface, 1,
+      presentation, zms_presentation_bind);
+  if (global == NULL) {
+    zms_log("failed to create a presentation wl_global\n");
+    goto err_global;
+  }
+
+  presentation->global = global;
+  presentation->compositor = compositor;
+
+  return presentation;
+
+err_global:
+  free(presentation);
+
+err:
+  return NULL;
+}
+
+ZMS_EXPORT void
+zms_presentation_destroy(struct zms_presentation* presentation)
+{
+  wl_global_destroy(presentation->global);
+  free(presentation);
+}
@@ -0,0 +1,18 @@
+#ifndef ZMONITORS_SERVER_PRESENTATION_H
+#define ZMONITORS_SERVER_PRESENTATION_H
+
+#include <wayland-server.h>
+
+#include "compositor.h"
+
+struct zms_presentation {
+  struct wl_global* global;
+  struct zms_compositor* compositor;
+};
+
+struct zms_presentation* zms_presentation_create(
+    struct zms_compositor* compositor);
+
+void zms_presentation_destroy(struct zms_presentation* presentation);
+
+#endif  //  ZMONITORS_SERVER_PRESENTATION_H
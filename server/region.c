@@ -3,6 +3,8 @@
 #include <wayland-server.h>
 #include <zmonitors-server.h>
 
+#include "pixman-helper.h"
+
 static void zms_region_destroy(struct zms_region *region);
 
 static void
@@ -28,13 +30,15 @@ static void
 zms_region_protocol_add(struct wl_client *client, struct wl_resource *resource,
     int32_t x, int32_t y, int32_t width, int32_t height)
 {
-  zms_log("request not implemented yet: wl_region.add\n");
+  struct zms_region *region = wl_resource_get_user_data(resource);
+  pixman_region32_t rect;
   Z_UNUSED(client);
-  Z_UNUSED(resource);
-  Z_UNUSED(x);
-  Z_UNUSED(y);
-  Z_UNUSED(width);
-  Z_UNUSED(height);
+
+  if (width <= 0 || height <= 0) return;
+
+  pixman_region32_init_rect_clamped(&rect, x, y, width, height);
+  pixman_region32_union(&region->region, &region->region, &rect);
+  pixman_region32_fini(&rect);
 }
 
 static void
@@ -42,13 +46,15 @@ zms_region_protocol_subtract(struct wl_client *client,
     struct wl_resource *resource, int32_t x, int32_t y, int32_t width,
     int32_t height)
 {
-  zms_log("request not implemented yet: wl_region.subtract\n");
+  struct zms_region *region = wl_resource_get_user_data(resource);
+  pixman_region32_t rect;
   Z_UNUSED(client);
-  Z_UNUSED(resource);
-  Z_UNUSED(x);
-  Z_UNUSED(y);
-  Z_UNUSED(width);
-  Z_UNUSED(height);
+
+  if (width <= 0 || height <= 0) return;
+
+  pixman_region32_init_rect_clamped(&rect, x, y, width, height);
+  pixman_region32_subtract(&region->region, &region->region, &rect);
+  pixman_region32_fini(&rect);
 }
 
 static const struct wl_region_interface region_interface = {
@@ -79,6 +85,7 @@ zms_region_create(struct wl_client *client, uint32_t id)
       resource, &region_interface, region, zms_region_handle_destroy);
 
   region->resource = resource;
+  pixman_region32_init(&region->region);
 
   return region;
 
@@ -92,5 +99,6 @@ err:
 static void
 zms_region_destroy(struct zms_region *region)
 {
+  pixman_region32_fini(&region->region);
   free(region);
 }
@@ -1,10 +1,12 @@
 #ifndef ZMONITORS_SERVER_REGION_H
 #define ZMONITORS_SERVER_REGION_H
 
+#include <pixman-1/pixman.h>
 #include <wayland-server.h>
 
 struct zms_region {
   struct wl_resource *resource;
+  pixman_region32_t region;
 };
 
 struct zms_region *zms_region_create(struct wl_client *client, uint32_t id);
@@ -0,0 +1,140 @@
+#include "render-pool.h"
+
+#include <zmonitors-server.h>
+
+/* Takes and runs jobs of the current batch until none is left.
+ * Must be called with pool->mutex locked. */
+static void
+zms_render_pool_drain(struct zms_render_pool* pool)
+{
+  int index;
+
+  while (pool->next_job < pool->job_count) {
+    index = pool->next_job++;
+
+    pthread_mutex_unlock(&pool->mutex);
+    pool->func(pool->data, index);
+    pthread_mutex_lock(&pool->mutex);
+
+    pool->finished_job_count++;
+    if (pool->finished_job_count == pool->job_count)
+      pthread_cond_signal(&pool->done_cond);
+  }
+}
+
+static void*
+zms_render_pool_worker_main(void* data)
+{
+  struct zms_render_pool* pool = data;
+
+  pthread_mutex_lock(&pool->mutex);
+  while (true) {
+    while (pool->quit == false && pool->next_job >= pool->job_count)
+      pthread_cond_wait(&pool->job_cond, &pool->mutex);
+
+    if (pool->quit) break;
+
+    zms_render_pool_drain(pool);
+  }
+  pthread_mutex_unlock(&pool->mutex);
+
+  return NULL;
+}
+
+ZMS_EXPORT struct zms_render_pool*
+zms_render_pool_create(int thread_count)
+{
+  struct zms_render_pool* pool;
+  pthread_t* workers;
+  int worker_count = thread_count - 1;
+  int i;
+
+  if (worker_count < 1) goto err;
+
+  pool = zalloc(sizeof *pool);
+  if (pool == NULL) {
+    zms_log("failed to allocate memory\n");
+    goto err;
+  }
+
+  workers = zalloc(sizeof(*workers) * worker_count);
+  if (workers == NULL) {
+    zms_log("failed to allocate memory\n");
+    goto err_workers;
+  }
+
+  pthread_mutex_init(&pool->mutex, NULL);
+  pthread_cond_init(&pool->job_cond, NULL);
+  pthread_cond_init(&pool->done_cond, NULL);
+  pool->workers = workers;
+  pool->job_count = 0;
+  pool->next_job = 0;
+  pool->finished_job_count = 0;
+  pool->quit = false;
+
+  for (i = 0; i < worker_count; i++) {
+    if (pthread_create(&workers[i], NULL, zms_render_pool_worker_main, pool) !=
+        0) {
+      zms_log("failed to create a render thread\n");
+      goto err_thread;
+    }
+  }
+  pool->worker_count = worker_count;
+
+  return pool;
+
+err_thread:
+  pool->worker_count = i;
+  zms_render_pool_destroy(pool);
+  return NULL;
+
+err_workers:
+  free(pool);
+
+err:
+  return NULL;
+}
+
+ZMS_EXPORT void
+zms_render_pool_destroy(struct zms_render_pool* pool)
+{
+  pthread_mutex_lock(&pool->mutex);
+  pool->quit = true;
+  pthread_cond_broadcast(&pool->job_cond);
+  pthread_mutex_unlock(&pool->mutex);
+
+  for (int i = 0; i < pool->worker_count; i++)
+    pthread_join(pool->workers[i], NULL);
+
+  pthread_cond_destroy(&pool->done_cond);
+  pthread_cond_destroy(&pool->job_cond);
+  pthread_mutex_destroy(&pool->mutex);
+  free(pool->workers);
+  free(pool);
+}
+
+ZMS_EXPORT void
+zms_render_pool_run(struct zms_render_pool* pool, int job_count,
+    zms_render_pool_job_func_t func, void* data)
+{
+  if (job_count <= 0) return;
+
+  pthread_mutex_lock(&pool->mutex);
+
+  pool->func = func;
+  pool->data = data;
+  pool->job_count = job_count;
+  pool->next_job = 0;
+  pool->finished_job_count = 0;
+  pthread_cond_broadcast(&pool->job_cond);
+
+  zms_render_pool_drain(pool);
+
+  while (pool->finished_job_count < pool->job_count)
+    pthread_cond_wait(&pool->done_cond, &pool->mutex);
+
+  pool->job_count = 0;
+  pool->next_job = 0;
+
+  pthread_mutex_unlock(&pool->mutex);
+}
@@ -0,0 +1,39 @@
+#ifndef ZMONITORS_SERVER_RENDER_POOL_H
+#define ZMONITORS_SERVER_RENDER_POOL_H
+
+#include <pthread.h>
+#include <stdbool.h>
+
+typedef void (*zms_render_pool_job_func_t)(void* data, int index);
+
+struct zms_render_pool {
+  int worker_count;
+  pthread_t* workers;
+
+  pthread_mutex_t mutex;
+  pthread_cond_t job_cond;   // signaled when a new batch is posted or on quit
+  pthread_cond_t done_cond;  // signaled when the last job of a batch finishes
+
+  // the current batch, guarded by mutex
+  zms_render_pool_job_func_t func;
+  void* data;
+  int job_count;
+  int next_job;
+  int finished_job_count;
+  bool quit;
+};
+
+/**
+ * @param thread_count total number of threads rendering a batch, including
+ * the caller of zms_render_pool_run.
+ */
+struct zms_render_pool* zms_render_pool_create(int thread_count);
+
+void zms_render_pool_destroy(struct zms_render_pool* pool);
+
+/* Runs func(data, 0) ... func(data, job_count - 1) on the pool and the calling
+ * thread, and returns after all of them finish. */
+void zms_render_pool_run(struct zms_render_pool* pool, int job_count,
+    zms_render_pool_job_func_t func, void* data);
+
+#endif  //  ZMONITORS_SERVER_RENDER_POOL_H
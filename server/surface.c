@@ -1,15 +1,34 @@
 #include "surface.h"
 
+#include <zmonitors-probe.h>
 #include <zmonitors-server.h>
 
 #include "buffer.h"
 #include "frame-callback.h"
+#include "presentation-feedback.h"
 #include "output.h"
 #include "pixman-helper.h"
+#include "region.h"
 #include "view.h"
 
+ZMS_PROBE_DEFINE(surface_commit);
+ZMS_PROBE_DEFINE(frame_done);
+
 static void zms_surface_destroy(struct zms_surface *surface);
 
+static void
+zms_surface_damage_add(pixman_region32_t *damage, int32_t x, int32_t y,
+    int32_t width, int32_t height)
+{
+  pixman_region32_t rect;
+
+  if (width <= 0 || height <= 0) return;
+
+  pixman_region32_init_rect_clamped(&rect, x, y, width, height);
+  pixman_region32_union(damage, damage, &rect);
+  pixman_region32_fini(&rect);
+}
+
 static void
 zms_surface_clear_pending_buffer(struct zms_surface *surface)
 {
@@ -60,14 +79,17 @@ zms_surface_protocol_attach(struct wl_client *client,
   // TODO: handle x and y args;
   Z_UNUSED(x);
   Z_UNUSED(y);
-  Z_UNUSED(client);
   struct zms_surface *surface = wl_resource_get_user_data(resource);
 
   if (surface->pending.buffer)
     wl_list_remove(&surface->pending_buffer_destroy_listener.link);
 
   if (buffer_resource) {
-    surface->pending.buffer = zms_buffer_create_from_resource(buffer_resource);
+    surface->pending.buffer = zms_buffer_from_resource(buffer_resource);
+    if (surface->pending.buffer == NULL) {
+      wl_client_post_no_memory(client);
+      return;
+    }
     wl_signal_add(&surface->pending.buffer->destroy_signal,
         &surface->pending_buffer_destroy_listener);
   } else {
@@ -82,14 +104,12 @@ zms_surface_protocol_damage(struct wl_client *client,
     struct wl_resource *resource, int32_t x, int32_t y, int32_t width,
     int32_t height)
 {
-  // TODO:
-  zms_log("request not implemented yet: wl_surface.damage\n");
+  struct zms_surface *surface = wl_resource_get_user_data(resource);
   Z_UNUSED(client);
-  Z_UNUSED(resource);
-  Z_UNUSED(x);
-  Z_UNUSED(y);
-  Z_UNUSED(width);
-  Z_UNUSED(height);
+
+  // buffer scale, transform and attach offsets are never applied, so surface
+  // and buffer coordinates are the same
+  zms_surface_damage_add(&surface->pending.damage, x, y, width, height);
 }
 
 static void
@@ -108,13 +128,18 @@ zms_surface_protocol_frame(struct wl_client *client,
 
 static void
 zms_surface_protocol_set_opaque_region(struct wl_client *client,
-    struct wl_resource *resource, struct wl_resource *region)
+    struct wl_resource *resource, struct wl_resource *region_resource)
 {
-  // TODO:
-  zms_log("request not implemented yet: wl_surface.set_opaque_region\n");
+  struct zms_surface *surface = wl_resource_get_user_data(resource);
+  struct zms_region *region;
   Z_UNUSED(client);
-  Z_UNUSED(resource);
-  Z_UNUSED(region);
+
+  if (region_resource) {
+    region = wl_resource_get_user_data(region_resource);
+    pixman_region32_copy(&surface->pending.opaque, &region->region);
+  } else {
+    pixman_region32_clear(&surface->pending.opaque);
+  }
 }
 
 static void
@@ -132,20 +157,50 @@ static void
 zms_surface_protocol_commit(
     struct wl_client *client, struct wl_resource *resource)
 {
-  Z_UNUSED(client);
   struct zms_surface *surface;
+  struct zms_presentation_feedback *feedback, *tmp;
 
   surface = wl_resource_get_user_data(resource);
 
+  zms_trace_begin("surface_commit");
+
+  pixman_region32_union(&surface->damage, &surface->pending.damage,
+      &surface->pending.buffer_damage);
+  pixman_region32_clear(&surface->pending.damage);
+  pixman_region32_clear(&surface->pending.buffer_damage);
+  pixman_region32_copy(&surface->opaque, &surface->pending.opaque);
+
+  ZMS_PROBE3(surface_commit, zms_surface_get_client_pid(surface),
+      pixman_region32_n_rects(&surface->damage),
+      pixman_region32_area(&surface->damage));
+
   zms_view_commit(surface->view);
 
   zms_surface_clear_pending_buffer(surface);
 
+  zms_metrics_record_commit(&surface->compositor->priv->metrics, client);
+
+  if (wl_list_empty(&surface->frame_callback_list) &&
+      !wl_list_empty(&surface->pending.frame_callback_list))
+    surface->frame_request_nsec = zms_metrics_get_time();
   wl_list_insert_list(
       &surface->frame_callback_list, &surface->pending.frame_callback_list);
   wl_list_init(&surface->pending.frame_callback_list);
 
+  // the previous content was never presented
+  wl_list_for_each_safe(feedback, tmp, &surface->feedback_list, link)
+      zms_presentation_feedback_send_discarded(feedback);
+  wl_list_insert_list(&surface->feedback_list, &surface->pending.feedback_list);
+  wl_list_init(&surface->pending.feedback_list);
+
+  // presented once a repaint has the content; may be nothing to composite
+  if (!wl_list_empty(&surface->feedback_list) &&
+      zms_view_is_mapped(surface->view))
+    zms_output_schedule_repaint(surface->view->priv->output);
+
   zms_signal_emit(&surface->commit_signal, NULL);
+
+  zms_trace_end("surface_commit");
 }
 
 static void
@@ -175,14 +230,10 @@ zms_surface_protocol_damage_buffer(struct wl_client *client,
     struct wl_resource *resource, int32_t x, int32_t y, int32_t width,
     int32_t height)
 {
-  // TODO:
-  zms_log("request not implemented yet: wl_surface.damage_buffer\n");
+  struct zms_surface *surface = wl_resource_get_user_data(resource);
   Z_UNUSED(client);
-  Z_UNUSED(resource);
-  Z_UNUSED(x);
-  Z_UNUSED(y);
-  Z_UNUSED(width);
-  Z_UNUSED(height);
+
+  zms_surface_damage_add(&surface->pending.buffer_damage, x, y, width, height);
 }
 
 static const struct wl_surface_interface surface_interface = {
@@ -235,8 +286,16 @@ zms_surface_create(
   surface->view = view;
   surface->pending.buffer = NULL;
   surface->pending.newly_attached = false;
+  pixman_region32_init(&surface->pending.damage);
+  pixman_region32_init(&surface->pending.buffer_damage);
+  pixman_region32_init(&surface->pending.opaque);
   wl_list_init(&surface->pending.frame_callback_list);
+  wl_list_init(&surface->pending.feedback_list);
+  pixman_region32_init(&surface->damage);
+  pixman_region32_init(&surface->opaque);
   wl_list_init(&surface->frame_callback_list);
+  surface->frame_request_nsec = 0;
+  wl_list_init(&surface->feedback_list);
   zms_signal_init(&surface->commit_signal);
   zms_signal_init(&surface->destroy_signal);
 
@@ -259,6 +318,7 @@ static void
 zms_surface_destroy(struct zms_surface *surface)
 {
   struct zms_server_frame_callback *frame_callback, *tmp;
+  struct zms_presentation_feedback *feedback, *feedback_tmp;
 
   wl_list_for_each_safe(
       frame_callback, tmp, &surface->pending.frame_callback_list, link)
@@ -267,10 +327,22 @@ zms_surface_destroy(struct zms_surface *surface)
   wl_list_for_each_safe(frame_callback, tmp, &surface->frame_callback_list,
       link) wl_resource_destroy(frame_callback->resource);
 
+  wl_list_for_each_safe(
+      feedback, feedback_tmp, &surface->pending.feedback_list, link)
+      zms_presentation_feedback_send_discarded(feedback);
+
+  wl_list_for_each_safe(feedback, feedback_tmp, &surface->feedback_list, link)
+      zms_presentation_feedback_send_discarded(feedback);
+
   if (surface->pending.buffer)
     wl_list_remove(&surface->pending_buffer_destroy_listener.link);
   zms_signal_emit(&surface->destroy_signal, NULL);
   zms_view_destroy(surface->view);
+  pixman_region32_fini(&surface->pending.damage);
+  pixman_region32_fini(&surface->pending.buffer_damage);
+  pixman_region32_fini(&surface->pending.opaque);
+  pixman_region32_fini(&surface->damage);
+  pixman_region32_fini(&surface->opaque);
   free(surface);
 }
 
@@ -315,6 +387,14 @@ zms_surface_send_frame_done(struct zms_surface *surface, uint32_t time)
 {
   struct zms_server_frame_callback *frame_callback, *tmp;
 
+  ZMS_PROBE3(frame_done, zms_surface_get_client_pid(surface),
+      wl_list_length(&surface->frame_callback_list), time);
+
+  if (!wl_list_empty(&surface->frame_callback_list)) {
+    zms_metrics_record_frame_latency(&surface->compositor->priv->metrics,
+        zms_metrics_get_time() - surface->frame_request_nsec);
+  }
+
   wl_list_for_each_safe(
       frame_callback, tmp, &surface->frame_callback_list, link)
   {
@@ -323,3 +403,14 @@ zms_surface_send_frame_done(struct zms_surface *surface, uint32_t time)
   }
   wl_client_flush(wl_resource_get_client(surface->resource));
 }
+
+ZMS_EXPORT pid_t
+zms_surface_get_client_pid(struct zms_surface *surface)
+{
+  pid_t pid;
+
+  wl_client_get_credentials(
+      wl_resource_get_client(surface->resource), &pid, NULL, NULL);
+
+  return pid;
+}
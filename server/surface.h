@@ -1,6 +1,7 @@
 #ifndef ZMONITORS_SERVER_SURFACE_H
 #define ZMONITORS_SERVER_SURFACE_H
 
+#include <pixman-1/pixman.h>
 #include <stdbool.h>
 #include <wayland-server.h>
 #include <zmonitors-server.h>
@@ -26,10 +27,23 @@ struct zms_surface {
     bool newly_attached;
     struct zms_buffer *buffer; /* nullable */
 
+    pixman_region32_t damage;         // surface local coordinates
+    pixman_region32_t buffer_damage;  // buffer coordinates
+    pixman_region32_t opaque;         // surface local coordinates
+
     struct wl_list frame_callback_list;  // <- zms_frame_callback
+    struct wl_list feedback_list;        // <- zms_presentation_feedback
   } pending;
 
+  pixman_region32_t damage;  // buffer coordinates, applied on the last commit
+  pixman_region32_t opaque;  // surface local coordinates
+
   struct wl_list frame_callback_list;  // <- zms_frame_callback
+  // when the oldest of frame_callback_list were committed, for metrics
+  uint64_t frame_request_nsec;
+  /* for the content of the last commit until a repaint composites it, then
+   * moved to zms_output_private.feedback_list; discarded if superseded */
+  struct wl_list feedback_list;  // <- zms_presentation_feedback
 
   /* nullable
    * for example when a role object was once created and then destroyed */
@@ -53,4 +67,6 @@ int zms_surface_set_role(struct zms_surface *surface,
 
 void zms_surface_send_frame_done(struct zms_surface *surface, uint32_t time);
 
+pid_t zms_surface_get_client_pid(struct zms_surface *surface);
+
 #endif  //  ZMONITORS_SERVER_SURFACE_H
@@ -0,0 +1,186 @@
+#include "view-grid.h"
+
+#include <math.h>
+
+#include "view.h"
+
+/* cells covered by the view rectangle, edges included as zms_view_contains */
+static void
+zms_view_grid_get_cells(
+    struct zms_view_grid* grid, struct zms_view* view, pixman_box32_t* cells)
+{
+  float x = view->priv->origin[0];
+  float y = view->priv->origin[1];
+
+  cells->x1 = floorf(x / ZMS_VIEW_GRID_CELL_SIZE);
+  cells->y1 = floorf(y / ZMS_VIEW_GRID_CELL_SIZE);
+  cells->x2 = floorf((x + zms_view_get_width(view)) / ZMS_VIEW_GRID_CELL_SIZE);
+  cells->y2 = floorf((y + zms_view_get_height(view)) / ZMS_VIEW_GRID_CELL_SIZE);
+  cells->x2++;
+  cells->y2++;
+
+  cells->x1 = MIN(MAX(cells->x1, 0), grid->columns);
+  cells->y1 = MIN(MAX(cells->y1, 0), grid->rows);
+  cells->x2 = MIN(MAX(cells->x2, 0), grid->columns);
+  cells->y2 = MIN(MAX(cells->y2, 0), grid->rows);
+}
+
+static struct wl_array*
+zms_view_grid_get_cell(struct zms_view_grid* grid, int32_t column, int32_t row)
+{
+  return &grid->cells[grid->columns * row + column];
+}
+
+static void
+zms_view_grid_cell_remove(struct wl_array* cell, struct zms_view* view)
+{
+  struct zms_view** views = cell->data;
+  size_t count = cell->size / sizeof *views;
+
+  for (size_t i = 0; i < count; i++) {
+    if (views[i] != view) continue;
+    // the order within a cell does not matter
+    views[i] = views[count - 1];
+    cell->size -= sizeof *views;
+    return;
+  }
+}
+
+ZMS_EXPORT struct zms_view_grid*
+zms_view_grid_create(struct zms_screen_size size)
+{
+  struct zms_view_grid* grid;
+  struct wl_array* cells;
+  int32_t columns, rows;
+
+  columns =
+      (size.width + ZMS_VIEW_GRID_CELL_SIZE - 1) / ZMS_VIEW_GRID_CELL_SIZE;
+  rows = (size.height + ZMS_VIEW_GRID_CELL_SIZE - 1) / ZMS_VIEW_GRID_CELL_SIZE;
+
+  grid = zalloc(sizeof *grid);
+  if (grid == NULL) {
+    zms_log("failed to allocate memory\n");
+    goto err;
+  }
+
+  cells = zalloc(sizeof(*cells) * columns * rows);
+  if (cells == NULL) {
+    zms_log("failed to allocate memory\n");
+    goto err_cells;
+  }
+
+  for (int32_t i = 0; i < columns * rows; i++) wl_array_init(&cells[i]);
+
+  grid->columns = columns;
+  grid->rows = rows;
+  grid->cells = cells;
+
+  return grid;
+
+err_cells:
+  free(grid);
+
+err:
+  return NULL;
+}
+
+ZMS_EXPORT void
+zms_view_grid_destroy(struct zms_view_grid* grid)
+{
+  for (int32_t i = 0; i < grid->columns * grid->rows; i++)
+    wl_array_release(&grid->cells[i]);
+
+  free(grid->cells);
+  free(grid);
+}
+
+ZMS_EXPORT void
+zms_view_grid_insert(struct zms_view_grid* grid, struct zms_view* view)
+{
+  pixman_box32_t* cells = &view->priv->grid_cells;
+  struct zms_view** entry;
+
+  zms_view_grid_get_cells(grid, view, cells);
+
+  for (int32_t row = cells->y1; row < cells->y2; row++) {
+    for (int32_t column = cells->x1; column < cells->x2; column++) {
+      entry = wl_array_add(
+          zms_view_grid_get_cell(grid, column, row), sizeof *entry);
+      if (entry == NULL) {
+        zms_log("failed to allocate memory\n");
+        continue;
+      }
+      *entry = view;
+    }
+  }
+}
+
+ZMS_EXPORT void
+zms_view_grid_remove(struct zms_view_grid* grid, struct zms_view* view)
+{
+  pixman_box32_t* cells = &view->priv->grid_cells;
+
+  for (int32_t row = cells->y1; row < cells->y2; row++) {
+    for (int32_t column = cells->x1; column < cells->x2; column++) {
+      zms_view_grid_cell_remove(
+          zms_view_grid_get_cell(grid, column, row), view);
+    }
+  }
+
+  cells->x1 = cells->y1 = cells->x2 = cells->y2 = 0;
+}
+
+ZMS_EXPORT void
+zms_view_grid_update(struct zms_view_grid* grid, struct zms_view* view)
+{
+  pixman_box32_t cells;
+
+  zms_view_grid_get_cells(grid, view, &cells);
+
+  if (cells.x1 == view->priv->grid_cells.x1 &&
+      cells.y1 == view->priv->grid_cells.y1 &&
+      cells.x2 == view->priv->grid_cells.x2 &&
+      cells.y2 == view->priv->grid_cells.y2)
+    return;
+
+  zms_view_grid_remove(grid, view);
+  zms_view_grid_insert(grid, view);
+}
+
+ZMS_EXPORT bool
+zms_view_grid_contains(struct zms_view_grid* grid, float x, float y)
+{
+  return 0 <= x && 0 <= y && x < grid->columns * ZMS_VIEW_GRID_CELL_SIZE &&
+         y < grid->rows * ZMS_VIEW_GRID_CELL_SIZE;
+}
+
+ZMS_EXPORT struct zms_view*
+zms_view_grid_pick(
+    struct zms_view_grid* grid, float x, float y, float* vx, float* vy)
+{
+  struct wl_array* cell;
+  struct zms_view **view, *top_view = NULL;
+  float top_vx = 0, top_vy = 0, view_x, view_y;
+
+  cell = zms_view_grid_get_cell(grid, x / ZMS_VIEW_GRID_CELL_SIZE,
+      y / ZMS_VIEW_GRID_CELL_SIZE);
+
+  wl_array_for_each(view, cell)
+  {
+    if (top_view &&
+        top_view->priv->stacking_order > (*view)->priv->stacking_order)
+      continue;
+    if (zms_view_contains(*view, x, y, &view_x, &view_y) == false) continue;
+
+    top_view = *view;
+    top_vx = view_x;
+    top_vy = view_y;
+  }
+
+  if (top_view) {
+    *vx = top_vx;
+    *vy = top_vy;
+  }
+
+  return top_view;
+}
@@ -0,0 +1,41 @@
+#ifndef ZMONITORS_SERVER_VIEW_GRID_H
+#define ZMONITORS_SERVER_VIEW_GRID_H
+
+#include <pixman-1/pixman.h>
+#include <wayland-server.h>
+#include <zmonitors-server.h>
+
+#define ZMS_VIEW_GRID_CELL_SIZE 256  // in pixels
+
+/* Uniform grid over an output, indexing each view by the cells its
+ * rectangle covers, so that the topmost view at a point is found by looking
+ * only at the views overlapping one cell. */
+struct zms_view_grid {
+  int32_t columns, rows;
+  struct wl_array* cells;  // columns * rows arrays of struct zms_view*
+};
+
+struct zms_view_grid* zms_view_grid_create(struct zms_screen_size size);
+
+void zms_view_grid_destroy(struct zms_view_grid* grid);
+
+void zms_view_grid_insert(struct zms_view_grid* grid, struct zms_view* view);
+
+void zms_view_grid_remove(struct zms_view_grid* grid, struct zms_view* view);
+
+/* Re-index the view after it moved or resized */
+void zms_view_grid_update(struct zms_view_grid* grid, struct zms_view* view);
+
+/**
+ * @return the view with the largest zms_view_private.stacking_order that
+ * contains the point, or NULL. The point must be inside the grid.
+ */
+struct zms_view* zms_view_grid_pick(
+    struct zms_view_grid* grid, float x, float y, float* vx, float* vy);
+
+/**
+ * @return true if the point is covered by the grid
+ */
+bool zms_view_grid_contains(struct zms_view_grid* grid, float x, float y);
+
+#endif  //  ZMONITORS_SERVER_VIEW_GRID_H
@@ -7,6 +7,60 @@
 #include "output.h"
 #include "pixman-helper.h"
 
+/* The image is over the memory of the buffer, which is about to go away;
+ * keep showing a copy of it. */
+static void
+zms_view_buffer_destroy_handler(struct wl_listener* listener, void* data)
+{
+  struct zms_view_private* priv =
+      wl_container_of(listener, priv, buffer_destroy_listener);
+  struct zms_buffer* buffer = data;
+  pixman_image_t *image = priv->image, *shadow = NULL;
+
+  wl_list_remove(&listener->link);
+  wl_list_init(&listener->link);
+
+  if (image == NULL || priv->image_is_shadow) return;
+
+  shadow = pixman_image_create_bits(pixman_image_get_format(image),
+      pixman_image_get_width(image), pixman_image_get_height(image), NULL, 0);
+
+  if (shadow) {
+    // zms_output_composite sets the transform again before using it
+    pixman_image_set_transform(image, NULL);
+
+    wl_shm_buffer_begin_access(buffer->shm_buffer);
+
+    pixman_image_composite32(PIXMAN_OP_SRC, image, NULL, shadow, 0, 0, 0, 0,
+        0, 0, pixman_image_get_width(image), pixman_image_get_height(image));
+
+    wl_shm_buffer_end_access(buffer->shm_buffer);
+  } else {
+    zms_log("failed to allocate memory\n");
+    zms_output_unmap_view(priv->output, priv->pub);
+  }
+
+  pixman_image_unref(image);
+  priv->image = shadow;
+  priv->image_is_shadow = shadow != NULL;
+}
+
+/* Also follows the destruction of the buffer */
+static void
+zms_view_reference_buffer(
+    struct zms_view* view, struct zms_buffer* buffer /* nullable */)
+{
+  struct zms_view_private* priv = view->priv;
+
+  wl_list_remove(&priv->buffer_destroy_listener.link);
+  wl_list_init(&priv->buffer_destroy_listener.link);
+
+  zms_buffer_reference(&priv->buffer_ref, buffer);
+
+  if (buffer)
+    wl_signal_add(&buffer->destroy_signal, &priv->buffer_destroy_listener);
+}
+
 ZMS_EXPORT struct zms_view*
 zms_view_create(struct zms_surface* surface)
 {
@@ -23,8 +77,18 @@ zms_view_create(struct zms_surface* surface)
   priv->surface = surface;
   priv->output = NULL;
   wl_list_init(&priv->link);
+  priv->stacking_order = 0;
+  priv->grid_cells.x1 = priv->grid_cells.y1 = 0;
+  priv->grid_cells.x2 = priv->grid_cells.y2 = 0;
+  priv->buffer_destroy_listener.notify = zms_view_buffer_destroy_handler;
+  wl_list_init(&priv->buffer_destroy_listener.link);
   priv->image = NULL;
+  priv->image_is_shadow = false;
   glm_vec2_zero(priv->origin);
+  pixman_region32_init(&priv->opaque);
+  pixman_region32_init(&priv->clip);
+  priv->clip_opaque = false;
+  pixman_region32_init(&priv->window_damage);
 
   view->priv = priv;
   zms_signal_init(&view->destroy_signal);
@@ -46,49 +110,175 @@ zms_view_destroy(struct zms_view* view)
   zms_signal_emit(&view->destroy_signal, NULL);
   zms_output_unmap_view(view->priv->output, view);
   if (view->priv->image) pixman_image_unref(view->priv->image);
-  zms_buffer_reference(&view->priv->buffer_ref, NULL);
+  zms_view_reference_buffer(view, NULL);
+  pixman_region32_fini(&view->priv->opaque);
+  pixman_region32_fini(&view->priv->clip);
+  pixman_region32_fini(&view->priv->window_damage);
   free(view->priv);
   free(view);
 }
 
+static void
+zms_view_damage_surface(struct zms_view* view, pixman_region32_t* damage)
+{
+  pixman_region32_t global_damage;
+
+  pixman_region32_init(&global_damage);
+  pixman_region32_intersect_rect(&global_damage, damage, 0, 0,
+      zms_view_get_width(view), zms_view_get_height(view));
+  pixman_region32_translate(
+      &global_damage, view->priv->origin[0], view->priv->origin[1]);
+
+  if (pixman_region32_not_empty(&global_damage))
+    zms_output_damage_view(view->priv->output, view, &global_damage, true);
+
+  pixman_region32_fini(&global_damage);
+}
+
+static void
+zms_view_update_opaque(struct zms_view* view)
+{
+  pixman_region32_t* opaque = &view->priv->opaque;
+  uint32_t width = zms_view_get_width(view);
+  uint32_t height = zms_view_get_height(view);
+
+  if (view->priv->image == NULL) {
+    pixman_region32_clear(opaque);
+  } else if (pixman_image_get_format(view->priv->image) == PIXMAN_x8r8g8b8) {
+    pixman_region32_fini(opaque);
+    pixman_region32_init_rect(opaque, 0, 0, width, height);
+  } else {
+    pixman_region32_intersect_rect(
+        opaque, &view->priv->surface->opaque, 0, 0, width, height);
+  }
+}
+
+/* Copies the damaged part of the buffer into an image owned by the view, so
+ * that the buffer can be released right away.
+ * @return a new reference to the image, or NULL */
+static pixman_image_t*
+zms_view_update_shadow(
+    struct zms_view* view, struct zms_buffer* buffer, pixman_region32_t* damage)
+{
+  pixman_image_t* source = zms_buffer_get_image(buffer);
+  pixman_image_t* shadow = view->priv->image;
+  pixman_region32_t copy_region;
+  pixman_format_code_t format;
+  int32_t width, height;
+
+  if (source == NULL) return NULL;
+
+  width = pixman_image_get_width(source);
+  height = pixman_image_get_height(source);
+  format = pixman_image_get_format(source);
+
+  pixman_region32_init_rect(&copy_region, 0, 0, width, height);
+
+  if (shadow && view->priv->image_is_shadow &&
+      pixman_image_get_width(shadow) == width &&
+      pixman_image_get_height(shadow) == height &&
+      pixman_image_get_format(shadow) == format) {
+    pixman_image_ref(shadow);
+    pixman_region32_intersect(&copy_region, &copy_region, damage);
+  } else {
+    shadow = pixman_image_create_bits(format, width, height, NULL, 0);
+    if (shadow == NULL) goto out;
+  }
+
+  if (!pixman_region32_not_empty(&copy_region)) goto out;
+
+  pixman_image_set_clip_region32(shadow, &copy_region);
+
+  // zms_output_composite sets the transform again before using it
+  pixman_image_set_transform(source, NULL);
+
+  wl_shm_buffer_begin_access(buffer->shm_buffer);
+
+  pixman_image_composite32(PIXMAN_OP_SRC, source, NULL, shadow, 0, 0, 0, 0, 0,
+      0, width, height);
+
+  wl_shm_buffer_end_access(buffer->shm_buffer);
+
+  view->priv->surface->compositor->priv->metrics.copied_bytes +=
+      pixman_region32_area(&copy_region) * PIXMAN_FORMAT_BPP(format) / 8;
+
+  pixman_image_set_clip_region32(shadow, NULL);
+
+out:
+  pixman_region32_fini(&copy_region);
+  return shadow;
+}
+
 ZMS_EXPORT int
 zms_view_commit(struct zms_view* view)
 {
-  void* data;
-  int32_t width, height, stride;
-  struct wl_shm_buffer* shm_buffer;
+  int32_t width, height;
+  pixman_image_t* image;
   struct zms_surface* surface = view->priv->surface;
+  struct zms_buffer* buffer = surface->pending.buffer;
+  bool shadowed = surface->compositor->priv->shadow_buffers && buffer;
   pixman_region32_t damage;
 
-  if (surface->pending.newly_attached == false) return -1;
+  if (surface->pending.newly_attached == false) {
+    zms_view_update_opaque(view);
+    // the client may have redrawn the attached buffer in place
+    if (zms_view_is_mapped(view))
+      zms_view_damage_surface(view, &surface->damage);
+    return -1;
+  }
 
-  if (surface->pending.buffer == NULL) {
+  if (buffer == NULL) {
     zms_output_unmap_view(view->priv->output, view);
     glm_vec2_zero(view->priv->origin);
     if (view->priv->image) pixman_image_unref(view->priv->image);
     view->priv->image = NULL;
+    view->priv->image_is_shadow = false;
   } else {
-    shm_buffer = wl_shm_buffer_get(surface->pending.buffer->resource);
-    width = wl_shm_buffer_get_width(shm_buffer);
-    height = wl_shm_buffer_get_height(shm_buffer);
-    data = wl_shm_buffer_get_data(shm_buffer);
-    stride = wl_shm_buffer_get_stride(shm_buffer);
-
-    if (view->priv->image) pixman_image_unref(view->priv->image);
-    view->priv->image =
-        pixman_image_create_bits(PIXMAN_a8r8g8b8, width, height, data, stride);
+    if (shadowed) {
+      image = zms_view_update_shadow(view, buffer, &surface->damage);
+    } else if (buffer->busy_count > 0 &&
+               buffer != view->priv->buffer_ref.buffer) {
+      // also shown by another view; the image transform is per view
+      image = zms_buffer_create_image(buffer);
+    } else {
+      // cached by the buffer; clients cycling a few buffers reuse them
+      image = zms_buffer_get_image(buffer);
+      if (image) pixman_image_ref(image);
+    }
+    if (image == NULL) {
+      zms_log("unsupported buffer type\n");
+      return -1;
+    }
+    width = pixman_image_get_width(image);
+    height = pixman_image_get_height(image);
 
-    if (zms_view_is_mapped(view)) {
-      // FIXME: using damage requests
+    if (zms_view_is_mapped(view) &&
+        (zms_view_get_width(view) != (uint32_t)width ||
+            zms_view_get_height(view) != (uint32_t)height)) {
+      // resized; repaint both the old and the new view area
       pixman_region32_init_view_global(&damage, view);
+      pixman_region32_union_rect(&damage, &damage, view->priv->origin[0],
+          view->priv->origin[1], width, height);
+      zms_output_damage_view(view->priv->output, view, &damage, true);
+      pixman_region32_fini(&damage);
+    }
 
-      zms_output_render(view->priv->output, &damage);
+    if (view->priv->image) pixman_image_unref(view->priv->image);
+    view->priv->image = image;
+    view->priv->image_is_shadow = shadowed;
 
-      pixman_region32_fini(&damage);
+    if (zms_view_is_mapped(view)) {
+      zms_output_update_view_geometry(view->priv->output, view);
+      zms_view_damage_surface(view, &surface->damage);
     }
   }
 
-  zms_buffer_reference(&view->priv->buffer_ref, surface->pending.buffer);
+  zms_view_update_opaque(view);
+
+  zms_view_reference_buffer(view, buffer);
+
+  // the content was copied; let the client draw into the buffer again
+  if (shadowed) zms_view_reference_buffer(view, NULL);
 
   return 0;
 }
@@ -98,6 +288,77 @@ zms_view_set_origin(struct zms_view* view, float x, float y)
 {
   view->priv->origin[0] = x;
   view->priv->origin[1] = y;
+
+  if (zms_view_is_mapped(view))
+    zms_output_update_view_geometry(view->priv->output, view);
+}
+
+ZMS_EXPORT void
+zms_view_get_geometry(struct zms_view* view, int32_t* x, int32_t* y,
+    uint32_t* width, uint32_t* height)
+{
+  *x = view->priv->origin[0];
+  *y = view->priv->origin[1];
+  *width = zms_view_get_width(view);
+  *height = zms_view_get_height(view);
+}
+
+ZMS_EXPORT void
+zms_view_damage_whole_image(struct zms_view* view)
+{
+  pixman_region32_union_rect(&view->priv->window_damage,
+      &view->priv->window_damage, 0, 0, zms_view_get_width(view),
+      zms_view_get_height(view));
+}
+
+ZMS_EXPORT bool
+zms_view_read_damaged_image(struct zms_view* view, void* data, uint32_t stride,
+    uint64_t* copied_pixels)
+{
+  struct zms_buffer* buffer;
+  pixman_region32_t* damage = &view->priv->window_damage;
+  pixman_image_t* image;
+  uint32_t width, height;
+  uint64_t pixels;
+
+  if (copied_pixels) *copied_pixels = 0;
+
+  if (view->priv->image == NULL) return false;
+
+  width = zms_view_get_width(view);
+  height = zms_view_get_height(view);
+
+  pixman_region32_intersect_rect(damage, damage, 0, 0, width, height);
+  if (!pixman_region32_not_empty(damage)) return true;
+
+  image = pixman_image_create_bits(
+      PIXMAN_a8r8g8b8, width, height, (uint32_t*)data, stride);
+  if (image == NULL) return false;
+
+  pixman_image_set_clip_region32(image, damage);
+
+  // no client memory is read for the view's own copy
+  buffer = view->priv->image_is_shadow ? NULL : view->priv->buffer_ref.buffer;
+
+  // zms_output_composite sets the transform again before using it
+  pixman_image_set_transform(view->priv->image, NULL);
+
+  if (buffer) wl_shm_buffer_begin_access(buffer->shm_buffer);
+
+  pixman_image_composite32(PIXMAN_OP_SRC, view->priv->image, NULL, image, 0, 0,
+      0, 0, 0, 0, width, height);
+
+  if (buffer) wl_shm_buffer_end_access(buffer->shm_buffer);
+
+  pixels = pixman_region32_area(damage);
+  view->priv->surface->compositor->priv->metrics.copied_bytes +=
+      pixels * sizeof(struct zms_bgra);
+  if (copied_pixels) *copied_pixels = pixels;
+
+  pixman_image_unref(image);
+  pixman_region32_clear(damage);
+
+  return true;
 }
 
 ZMS_EXPORT bool
@@ -14,6 +14,8 @@ struct zms_view_private {
 
   struct zms_surface* surface; /* nonnull */
   struct zms_buffer_ref buffer_ref;
+  // -> buffer_ref.buffer->destroy_signal; self-pointed link without a buffer
+  struct wl_listener buffer_destroy_listener;
 
   /* The output that this view is mapped.
    * Be careful of its data consistency with zms_view_private.link.
@@ -23,9 +25,37 @@ struct zms_view_private {
    * self-pointed link when self->output is null.
    * managed by zms_output. */
   struct wl_list link;
-
-  pixman_image_t* image; /* nullable */
+  /* valid only when self->output is not null. managed by zms_output. */
+  int layer_index;  // enum zms_output_view_layer_index
+  /* larger is closer to the top of the layer. valid only when self->output
+   * is not null. managed by zms_output. */
+  uint64_t stacking_order;
+  /* cells of the output view grid covering this view; x2 and y2 are
+   * exclusive. managed by zms_view_grid. */
+  pixman_box32_t grid_cells;
+
+  /* A reference to the image cached by buffer_ref.buffer, or an image of its
+   * own if another view showed the buffer first. Either is over the memory
+   * of buffer_ref.buffer. A copy of the committed content instead when
+   * image_is_shadow is true. nullable */
+  pixman_image_t* image;
+  /* true when the image is the view's own copy, taken with shadow buffers
+   * or when the buffer was destroyed while shown */
+  bool image_is_shadow;
   vec2 origin;
+
+  pixman_region32_t opaque;  // view local coordinates
+
+  /* The part of the view to be repainted in the current render pass.
+   * managed by zms_output. output global coordinates */
+  pixman_region32_t clip;
+  /* true when the clip is fully covered by the opaque region, so that the
+   * view can be copied without blending. managed by zms_output. */
+  bool clip_opaque;
+
+  /* The part of the view image changed since the window overlay last read
+   * it. managed by zms_output. view local coordinates */
+  pixman_region32_t window_damage;
 };
 
 struct zms_view* zms_view_create(struct zms_surface* surface);
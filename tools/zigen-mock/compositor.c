@@ -0,0 +1,240 @@
+#include <time.h>
+#include <zigen-server-protocol.h>
+
+#include "mock.h"
+
+static void
+zms_mock_frame_callback_handle_destroy(struct wl_resource* resource)
+{
+  wl_list_remove(wl_resource_get_link(resource));
+}
+
+static void
+zms_mock_virtual_object_handle_destroy(struct wl_resource* resource)
+{
+  struct zms_mock_virtual_object* virtual_object;
+  struct wl_resource *callback, *tmp;
+
+  virtual_object = wl_resource_get_user_data(resource);
+
+  wl_resource_for_each_safe(
+      callback, tmp, &virtual_object->pending_frame_callback_list)
+      wl_resource_destroy(callback);
+
+  wl_resource_for_each_safe(callback, tmp, &virtual_object->frame_callback_list)
+      wl_resource_destroy(callback);
+
+  if (virtual_object->mock->ray_focus == virtual_object)
+    virtual_object->mock->ray_focus = NULL;
+  if (virtual_object->mock->keyboard_focus == virtual_object)
+    virtual_object->mock->keyboard_focus = NULL;
+
+  wl_list_remove(&virtual_object->link);
+  free(virtual_object);
+}
+
+static void
+zms_mock_virtual_object_protocol_destroy(
+    struct wl_client* client, struct wl_resource* resource)
+{
+  Z_UNUSED(client);
+  wl_resource_destroy(resource);
+}
+
+static void
+zms_mock_virtual_object_protocol_commit(
+    struct wl_client* client, struct wl_resource* resource)
+{
+  Z_UNUSED(client);
+  struct zms_mock_virtual_object* virtual_object;
+
+  virtual_object = wl_resource_get_user_data(resource);
+
+  virtual_object->mock->total_stats.commits++;
+  virtual_object->mock->report_stats.commits++;
+  zms_mock_trace(virtual_object->mock, "commit", 0);
+
+  wl_list_insert_list(&virtual_object->frame_callback_list,
+      &virtual_object->pending_frame_callback_list);
+  wl_list_init(&virtual_object->pending_frame_callback_list);
+}
+
+static void
+zms_mock_virtual_object_protocol_frame(
+    struct wl_client* client, struct wl_resource* resource, uint32_t id)
+{
+  struct zms_mock_virtual_object* virtual_object;
+  struct wl_resource* callback;
+
+  virtual_object = wl_resource_get_user_data(resource);
+
+  callback = wl_resource_create(client, &wl_callback_interface, 1, id);
+  if (callback == NULL) {
+    wl_client_post_no_memory(client);
+    return;
+  }
+
+  wl_resource_set_implementation(
+      callback, NULL, NULL, zms_mock_frame_callback_handle_destroy);
+  wl_list_insert(virtual_object->pending_frame_callback_list.prev,
+      wl_resource_get_link(callback));
+}
+
+static const struct zgn_virtual_object_interface virtual_object_interface = {
+    .destroy = zms_mock_virtual_object_protocol_destroy,
+    .commit = zms_mock_virtual_object_protocol_commit,
+    .frame = zms_mock_virtual_object_protocol_frame,
+};
+
+ZMS_EXPORT void
+zms_mock_virtual_object_frame(
+    struct zms_mock_virtual_object* virtual_object, uint32_t time)
+{
+  struct zms_mock* mock = virtual_object->mock;
+  struct wl_resource *callback, *tmp;
+
+  wl_resource_for_each_safe(callback, tmp, &virtual_object->frame_callback_list)
+  {
+    wl_callback_send_done(callback, time);
+    wl_resource_destroy(callback);
+    mock->total_stats.frame_callbacks++;
+    mock->report_stats.frame_callbacks++;
+  }
+}
+
+static void
+zms_mock_compositor_protocol_create_virtual_object(
+    struct wl_client* client, struct wl_resource* resource, uint32_t id)
+{
+  struct zms_mock* mock = wl_resource_get_user_data(resource);
+  struct zms_mock_virtual_object* virtual_object;
+  struct wl_resource* virtual_object_resource;
+
+  virtual_object = zalloc(sizeof *virtual_object);
+  if (virtual_object == NULL) {
+    wl_client_post_no_memory(client);
+    return;
+  }
+
+  virtual_object_resource =
+      wl_resource_create(client, &zgn_virtual_object_interface, 1, id);
+  if (virtual_object_resource == NULL) {
+    free(virtual_object);
+    wl_client_post_no_memory(client);
+    return;
+  }
+
+  wl_resource_set_implementation(virtual_object_resource,
+      &virtual_object_interface, virtual_object,
+      zms_mock_virtual_object_handle_destroy);
+
+  virtual_object->resource = virtual_object_resource;
+  virtual_object->mock = mock;
+  virtual_object->has_cuboid_window = false;
+  wl_list_init(&virtual_object->pending_frame_callback_list);
+  wl_list_init(&virtual_object->frame_callback_list);
+  wl_list_insert(&mock->virtual_object_list, &virtual_object->link);
+}
+
+static const struct zgn_compositor_interface compositor_interface = {
+    .create_virtual_object = zms_mock_compositor_protocol_create_virtual_object,
+};
+
+static void
+zms_mock_compositor_bind(
+    struct wl_client* client, void* data, uint32_t version, uint32_t id)
+{
+  struct wl_resource* resource;
+
+  resource = wl_resource_create(client, &zgn_compositor_interface, version, id);
+  if (resource == NULL) {
+    wl_client_post_no_memory(client);
+    return;
+  }
+
+  wl_resource_set_implementation(resource, &compositor_interface, data, NULL);
+}
+
+static void
+zms_mock_buffer_release_destroy(struct zms_mock_buffer_release* release)
+{
+  wl_list_remove(&release->buffer_destroy_listener.link);
+  wl_list_remove(&release->link);
+  free(release);
+}
+
+static void
+zms_mock_buffer_release_handle_buffer_destroy(
+    struct wl_listener* listener, void* data)
+{
+  Z_UNUSED(data);
+  struct zms_mock_buffer_release* release;
+
+  release = wl_container_of(listener, release, buffer_destroy_listener);
+
+  zms_mock_buffer_release_destroy(release);
+}
+
+ZMS_EXPORT size_t
+zms_mock_release_buffer_later(struct zms_mock* mock, struct wl_resource* buffer)
+{
+  struct wl_shm_buffer* shm_buffer = wl_shm_buffer_get(buffer);
+  struct zms_mock_buffer_release* release;
+
+  release = zalloc(sizeof *release);
+  if (release == NULL) {
+    zms_log("failed to allocate memory\n");
+    wl_buffer_send_release(buffer);
+  } else {
+    release->buffer = buffer;
+    release->buffer_destroy_listener.notify =
+        zms_mock_buffer_release_handle_buffer_destroy;
+    wl_resource_add_destroy_listener(
+        buffer, &release->buffer_destroy_listener);
+    wl_list_insert(mock->buffer_release_list.prev, &release->link);
+  }
+
+  if (shm_buffer == NULL) return 0;
+
+  return (size_t)wl_shm_buffer_get_stride(shm_buffer) *
+         wl_shm_buffer_get_height(shm_buffer);
+}
+
+ZMS_EXPORT void
+zms_mock_release_buffers(struct zms_mock* mock)
+{
+  struct zms_mock_buffer_release *release, *tmp;
+
+  wl_list_for_each_safe(release, tmp, &mock->buffer_release_list, link)
+  {
+    wl_buffer_send_release(release->buffer);
+    zms_mock_buffer_release_destroy(release);
+  }
+}
+
+ZMS_EXPORT uint32_t
+zms_mock_get_time(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  return now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+ZMS_EXPORT bool
+zms_mock_compositor_init(struct zms_mock* mock)
+{
+  if (wl_global_create(mock->display, &zgn_compositor_interface, 1, mock,
+          zms_mock_compositor_bind) == NULL) {
+    zms_log("failed to create a zgn_compositor global\n");
+    return false;
+  }
+
+  if (wl_display_init_shm(mock->display) == -1) {
+    zms_log("failed to initialize shm\n");
+    return false;
+  }
+
+  return true;
+}
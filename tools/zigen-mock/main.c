@@ -0,0 +1,301 @@
+#include <getopt.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "mock.h"
+
+#define DEFAULT_SOCKET "zigen-mock-0"
+#define DEFAULT_REFRESH 60
+#define REPORT_INTERVAL_MSEC 1000
+
+static void
+print_usage(const char* program)
+{
+  fprintf(stderr,
+      "usage: %s [options]\n"
+      "\n"
+      "A zigen compositor which draws nothing. Run zmonitors with\n"
+      "--zigen-socket=NAME to connect it here. Stats are printed to stdout\n"
+      "every second, and seat events are read from stdin:\n"
+      "\n"
+      "  ray enter | ray leave\n"
+      "  ray motion OX OY OZ DX DY DZ\n"
+      "  ray button CODE pressed|released\n"
+      "  keyboard enter | keyboard leave\n"
+      "  key CODE pressed|released\n"
+      "  stats\n"
+      "\n"
+      "  -S, --socket=NAME   listen on NAME (default: " DEFAULT_SOCKET ")\n"
+      "  -r, --refresh=HZ    send frame callbacks at HZ (default: 60)\n"
+      "  -T, --trace         print each commit and texture attach\n"
+      "  -h, --help          show this help\n",
+      program);
+}
+
+static void
+print_stats(const char* label, struct zms_mock_stats* stats)
+{
+  printf("%s frames=%" PRIu64 " commits=%" PRIu64 " frame_callbacks=%" PRIu64
+         " texture_attaches=%" PRIu64 " texture_bytes=%" PRIu64
+         " vertex_buffer_attaches=%" PRIu64 " uniform_updates=%" PRIu64 "\n",
+      label, stats->frames, stats->commits, stats->frame_callbacks,
+      stats->texture_attaches, stats->texture_bytes,
+      stats->vertex_buffer_attaches, stats->uniform_updates);
+  fflush(stdout);
+}
+
+ZMS_EXPORT void
+zms_mock_trace(struct zms_mock* mock, const char* event, uint64_t value)
+{
+  struct timespec now;
+
+  if (mock->trace == false) return;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  printf("%s %" PRIu64 " %" PRIu64 "\n", event,
+      (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec, value);
+}
+
+static int
+handle_frame_timer(int fd, uint32_t mask, void* data)
+{
+  Z_UNUSED(mask);
+  struct zms_mock* mock = data;
+  struct zms_mock_virtual_object *virtual_object, *tmp;
+  uint64_t expirations;
+  uint32_t time;
+
+  if (read(fd, &expirations, sizeof expirations) != sizeof expirations)
+    return 0;
+
+  time = zms_mock_get_time();
+
+  // zigen has uploaded everything attached until the previous frame
+  zms_mock_release_buffers(mock);
+
+  wl_list_for_each_safe(virtual_object, tmp, &mock->virtual_object_list, link)
+      zms_mock_virtual_object_frame(virtual_object, time);
+
+  mock->total_stats.frames++;
+  mock->report_stats.frames++;
+
+  // traced lines are read while the benchmark runs
+  if (mock->trace) fflush(stdout);
+
+  return 0;
+}
+
+static int
+handle_report_timer(void* data)
+{
+  struct zms_mock* mock = data;
+
+  print_stats("second", &mock->report_stats);
+  memset(&mock->report_stats, 0, sizeof mock->report_stats);
+
+  wl_event_source_timer_update(mock->report_timer, REPORT_INTERVAL_MSEC);
+
+  return 0;
+}
+
+static void
+run_command(struct zms_mock* mock, char* command)
+{
+  if (command[0] == '\0') return;
+
+  if (strcmp(command, "stats") == 0)
+    print_stats("total", &mock->total_stats);
+  else
+    zms_mock_seat_run_command(mock, command);
+}
+
+static int
+handle_stdin(int fd, uint32_t mask, void* data)
+{
+  struct zms_mock* mock = data;
+  char* newline;
+  ssize_t size;
+
+  if (mask & (WL_EVENT_HANGUP | WL_EVENT_ERROR)) goto eof;
+
+  size = read(fd, mock->line + mock->line_length,
+      sizeof mock->line - mock->line_length - 1);
+  if (size <= 0) goto eof;
+
+  mock->line_length += size;
+  mock->line[mock->line_length] = '\0';
+
+  while ((newline = strchr(mock->line, '\n'))) {
+    *newline = '\0';
+    run_command(mock, mock->line);
+    mock->line_length -= newline + 1 - mock->line;
+    memmove(mock->line, newline + 1, mock->line_length + 1);
+  }
+
+  if (mock->line_length == sizeof mock->line - 1) {
+    zms_log("too long command\n");
+    mock->line_length = 0;
+  }
+
+  return 0;
+
+eof:
+  // keep serving clients; commands are optional
+  wl_event_source_remove(mock->stdin_source);
+  mock->stdin_source = NULL;
+  return 0;
+}
+
+static int
+on_term_signal(int signal_number, void* data)
+{
+  Z_UNUSED(signal_number);
+  struct wl_display* display = data;
+
+  wl_display_terminate(display);
+
+  return 0;
+}
+
+static bool
+parse_options(
+    int argc, char* argv[], const char** socket, struct zms_mock* mock)
+{
+  static const struct option long_options[] = {
+      {"socket", required_argument, NULL, 'S'},
+      {"refresh", required_argument, NULL, 'r'},
+      {"trace", no_argument, NULL, 'T'},
+      {"help", no_argument, NULL, 'h'},
+      {NULL, 0, NULL, 0},
+  };
+  int opt;
+  long value;
+  char* end;
+
+  while ((opt = getopt_long(argc, argv, "S:r:Th", long_options, NULL)) != -1) {
+    switch (opt) {
+      case 'S':
+        *socket = optarg;
+        break;
+
+      case 'r':
+        value = strtol(optarg, &end, 10);
+        if (*end != '\0' || value < 1 || value > 1000) {
+          zms_log("invalid refresh rate: %s\n", optarg);
+          return false;
+        }
+        mock->refresh = value;
+        break;
+
+      case 'T':
+        mock->trace = true;
+        break;
+
+      case 'h':
+      default:
+        print_usage(argv[0]);
+        return false;
+    }
+  }
+
+  return true;
+}
+
+int
+main(int argc, char* argv[])
+{
+  struct zms_mock mock = {0};
+  const char* socket = DEFAULT_SOCKET;
+  struct wl_event_loop* loop;
+  struct wl_event_source* signals[3] = {NULL};
+  struct itimerspec interval;
+  int timer_fd = -1;
+  int exit_code = EXIT_FAILURE;
+
+  mock.refresh = DEFAULT_REFRESH;
+  if (parse_options(argc, argv, &socket, &mock) == false) goto out;
+
+  wl_list_init(&mock.virtual_object_list);
+  wl_list_init(&mock.buffer_release_list);
+
+  mock.display = wl_display_create();
+  if (mock.display == NULL) {
+    zms_log("failed to create a display\n");
+    goto out;
+  }
+
+  if (wl_display_add_socket(mock.display, socket) != 0) {
+    zms_log("failed to add socket %s\n", socket);
+    goto out_display;
+  }
+
+  if (zms_mock_compositor_init(&mock) == false ||
+      zms_mock_shell_init(&mock) == false ||
+      zms_mock_opengl_init(&mock) == false ||
+      zms_mock_seat_init(&mock) == false)
+    goto out_display;
+
+  loop = wl_display_get_event_loop(mock.display);
+
+  timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+  if (timer_fd == -1) {
+    zms_log("failed to create a timer\n");
+    goto out_display;
+  }
+
+  interval.it_interval.tv_sec = 1 / mock.refresh;
+  interval.it_interval.tv_nsec = 1000000000L / mock.refresh % 1000000000L;
+  interval.it_value = interval.it_interval;
+  timerfd_settime(timer_fd, 0, &interval, NULL);
+
+  mock.frame_timer = wl_event_loop_add_fd(
+      loop, timer_fd, WL_EVENT_READABLE, handle_frame_timer, &mock);
+  mock.report_timer = wl_event_loop_add_timer(loop, handle_report_timer, &mock);
+  mock.stdin_source = wl_event_loop_add_fd(
+      loop, STDIN_FILENO, WL_EVENT_READABLE, handle_stdin, &mock);
+  if (!mock.frame_timer || !mock.report_timer || !mock.stdin_source) {
+    zms_log("failed to create event sources\n");
+    goto out_sources;
+  }
+  wl_event_source_timer_update(mock.report_timer, REPORT_INTERVAL_MSEC);
+
+  signals[0] =
+      wl_event_loop_add_signal(loop, SIGTERM, on_term_signal, mock.display);
+  signals[1] =
+      wl_event_loop_add_signal(loop, SIGINT, on_term_signal, mock.display);
+  signals[2] =
+      wl_event_loop_add_signal(loop, SIGQUIT, on_term_signal, mock.display);
+  if (!signals[0] || !signals[1] || !signals[2]) {
+    zms_log("failed to create signal event sources\n");
+    goto out_sources;
+  }
+
+  zms_log("zigen-mock listening on %s at %u Hz\n", socket, mock.refresh);
+
+  wl_display_run(mock.display);
+
+  print_stats("total", &mock.total_stats);
+  exit_code = EXIT_SUCCESS;
+
+out_sources:
+  for (int i = 0; i < 3; i++)
+    if (signals[i]) wl_event_source_remove(signals[i]);
+  if (mock.stdin_source) wl_event_source_remove(mock.stdin_source);
+  if (mock.report_timer) wl_event_source_remove(mock.report_timer);
+  if (mock.frame_timer) wl_event_source_remove(mock.frame_timer);
+  close(timer_fd);
+
+out_display:
+  wl_display_destroy_clients(mock.display);
+  wl_display_destroy(mock.display);
+
+out:
+  return exit_code;
+}
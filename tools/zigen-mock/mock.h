@@ -0,0 +1,92 @@
+#ifndef ZMONITORS_TOOLS_ZIGEN_MOCK_MOCK_H
+#define ZMONITORS_TOOLS_ZIGEN_MOCK_MOCK_H
+
+#include <stdint.h>
+#include <wayland-server.h>
+#include <zmonitors-util.h>
+
+/* A zigen compositor which draws nothing. It implements the globals used by
+ * backend/ so that a whole zmonitors process can be benchmarked, records
+ * what the client sends, and injects seat events read from stdin. */
+
+struct zms_mock_stats {
+  uint64_t frames;
+  uint64_t commits;
+  uint64_t frame_callbacks;
+  uint64_t texture_attaches;
+  uint64_t texture_bytes;  // referenced by the attached buffers
+  uint64_t vertex_buffer_attaches;
+  uint64_t uniform_updates;
+};
+
+struct zms_mock {
+  struct wl_display* display;
+  uint32_t refresh;  // in Hz
+  bool trace;        // write each event to stdout, see zms_mock_trace
+
+  struct wl_event_source* frame_timer;
+  struct wl_event_source* report_timer;
+  struct wl_event_source* stdin_source;
+  char line[256];  // stdin, not terminated yet
+  size_t line_length;
+
+  struct zms_mock_stats total_stats;
+  struct zms_mock_stats report_stats;  // since the last report
+
+  struct wl_list virtual_object_list;  // -> zms_mock_virtual_object.link
+  // wl_buffer resources to be released on the next frame
+  struct wl_list buffer_release_list;  // -> zms_mock_buffer_release.link
+
+  struct wl_list ray_list;       // -> resource link of zgn_ray
+  struct wl_list keyboard_list;  // -> resource link of zgn_keyboard
+  vec3 ray_origin, ray_direction;
+  struct zms_mock_virtual_object* ray_focus;       // nullable
+  struct zms_mock_virtual_object* keyboard_focus;  // nullable
+};
+
+struct zms_mock_virtual_object {
+  struct wl_resource* resource;
+  struct zms_mock* mock;
+  bool has_cuboid_window;
+
+  struct wl_list pending_frame_callback_list;  // -> resource link
+  struct wl_list frame_callback_list;          // -> resource link
+
+  struct wl_list link;  // -> zms_mock.virtual_object_list
+};
+
+struct zms_mock_buffer_release {
+  struct wl_resource* buffer;
+  struct wl_listener buffer_destroy_listener;
+  struct wl_list link;  // -> zms_mock.buffer_release_list
+};
+
+bool zms_mock_compositor_init(struct zms_mock* mock);
+
+bool zms_mock_shell_init(struct zms_mock* mock);
+
+bool zms_mock_opengl_init(struct zms_mock* mock);
+
+bool zms_mock_seat_init(struct zms_mock* mock);
+
+/* Send frame done to the frame callbacks committed so far */
+void zms_mock_virtual_object_frame(
+    struct zms_mock_virtual_object* virtual_object, uint32_t time);
+
+/* Release the buffer on the next frame, as zigen does after uploading it.
+ * @return bytes referenced by the buffer */
+size_t zms_mock_release_buffer_later(
+    struct zms_mock* mock, struct wl_resource* buffer);
+
+void zms_mock_release_buffers(struct zms_mock* mock);
+
+/* Handle a command line such as "ray motion 0 0 1 0 0 -1". See usage. */
+void zms_mock_seat_run_command(struct zms_mock* mock, char* command);
+
+uint32_t zms_mock_get_time(void);
+
+/* With --trace, write "EVENT NSEC VALUE" to stdout, NSEC being
+ * CLOCK_MONOTONIC so that other processes can compare it with their own. */
+void zms_mock_trace(struct zms_mock* mock, const char* event, uint64_t value);
+
+#endif  //  ZMONITORS_TOOLS_ZIGEN_MOCK_MOCK_H
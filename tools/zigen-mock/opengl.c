@@ -0,0 +1,294 @@
+#include <unistd.h>
+#include <zigen-opengl-server-protocol.h>
+
+#include "mock.h"
+
+static void
+zms_mock_opengl_protocol_destroy(
+    struct wl_client* client, struct wl_resource* resource)
+{
+  Z_UNUSED(client);
+  wl_resource_destroy(resource);
+}
+
+static void
+zms_mock_opengl_component_protocol_attach_vertex_buffer(
+    struct wl_client* client, struct wl_resource* resource,
+    struct wl_resource* vertex_buffer)
+{
+  Z_UNUSED(client);
+  Z_UNUSED(resource);
+  Z_UNUSED(vertex_buffer);
+}
+
+static void
+zms_mock_opengl_component_protocol_attach_shader_program(
+    struct wl_client* client, struct wl_resource* resource,
+    struct wl_resource* shader_program)
+{
+  Z_UNUSED(client);
+  Z_UNUSED(resource);
+  Z_UNUSED(shader_program);
+}
+
+static void
+zms_mock_opengl_component_protocol_attach_texture(struct wl_client* client,
+    struct wl_resource* resource, struct wl_resource* texture)
+{
+  Z_UNUSED(client);
+  Z_UNUSED(resource);
+  Z_UNUSED(texture);
+}
+
+static void
+zms_mock_opengl_component_protocol_set_count(
+    struct wl_client* client, struct wl_resource* resource, uint32_t count)
+{
+  Z_UNUSED(client);
+  Z_UNUSED(resource);
+  Z_UNUSED(count);
+}
+
+static void
+zms_mock_opengl_component_protocol_set_topology(
+    struct wl_client* client, struct wl_resource* resource, uint32_t topology)
+{
+  Z_UNUSED(client);
+  Z_UNUSED(resource);
+  Z_UNUSED(topology);
+}
+
+static void
+zms_mock_opengl_component_protocol_add_vertex_attribute(
+    struct wl_client* client, struct wl_resource* resource, uint32_t index,
+    uint32_t size, uint32_t type, uint32_t normalized, int32_t stride,
+    uint32_t pointer)
+{
+  Z_UNUSED(client);
+  Z_UNUSED(resource);
+  Z_UNUSED(index);
+  Z_UNUSED(size);
+  Z_UNUSED(type);
+  Z_UNUSED(normalized);
+  Z_UNUSED(stride);
+  Z_UNUSED(pointer);
+}
+
+static void
+zms_mock_opengl_component_protocol_set_min(
+    struct wl_client* client, struct wl_resource* resource, uint32_t min)
+{
+  Z_UNUSED(client);
+  Z_UNUSED(resource);
+  Z_UNUSED(min);
+}
+
+static const struct zgn_opengl_component_interface component_interface = {
+    .destroy = zms_mock_opengl_protocol_destroy,
+    .attach_vertex_buffer =
+        zms_mock_opengl_component_protocol_attach_vertex_buffer,
+    .attach_shader_program =
+        zms_mock_opengl_component_protocol_attach_shader_program,
+    .attach_texture = zms_mock_opengl_component_protocol_attach_texture,
+    .set_count = zms_mock_opengl_component_protocol_set_count,
+    .set_topology = zms_mock_opengl_component_protocol_set_topology,
+    .add_vertex_attribute =
+        zms_mock_opengl_component_protocol_add_vertex_attribute,
+    .set_min = zms_mock_opengl_component_protocol_set_min,
+};
+
+static void
+zms_mock_opengl_vertex_buffer_protocol_attach(struct wl_client* client,
+    struct wl_resource* resource, struct wl_resource* buffer)
+{
+  Z_UNUSED(client);
+  struct zms_mock* mock = wl_resource_get_user_data(resource);
+
+  zms_mock_release_buffer_later(mock, buffer);
+
+  mock->total_stats.vertex_buffer_attaches++;
+  mock->report_stats.vertex_buffer_attaches++;
+}
+
+static const struct zgn_opengl_vertex_buffer_interface vertex_buffer_interface =
+    {
+        .destroy = zms_mock_opengl_protocol_destroy,
+        .attach = zms_mock_opengl_vertex_buffer_protocol_attach,
+};
+
+static void
+zms_mock_opengl_shader_program_count_uniform(struct wl_resource* resource)
+{
+  struct zms_mock* mock = wl_resource_get_user_data(resource);
+
+  mock->total_stats.uniform_updates++;
+  mock->report_stats.uniform_updates++;
+}
+
+static void
+zms_mock_opengl_shader_program_protocol_set_uniform_float_vector(
+    struct wl_client* client, struct wl_resource* resource,
+    const char* location, uint32_t size, uint32_t count, struct wl_array* value)
+{
+  Z_UNUSED(client);
+  Z_UNUSED(location);
+  Z_UNUSED(size);
+  Z_UNUSED(count);
+  Z_UNUSED(value);
+  zms_mock_opengl_shader_program_count_uniform(resource);
+}
+
+static void
+zms_mock_opengl_shader_program_protocol_set_uniform_float_matrix(
+    struct wl_client* client, struct wl_resource* resource,
+    const char* location, uint32_t col, uint32_t row, uint32_t transpose,
+    uint32_t count, struct wl_array* value)
+{
+  Z_UNUSED(client);
+  Z_UNUSED(location);
+  Z_UNUSED(col);
+  Z_UNUSED(row);
+  Z_UNUSED(transpose);
+  Z_UNUSED(count);
+  Z_UNUSED(value);
+  zms_mock_opengl_shader_program_count_uniform(resource);
+}
+
+static void
+zms_mock_opengl_shader_program_protocol_set_shader(struct wl_client* client,
+    struct wl_resource* resource, int32_t fd, uint32_t size)
+{
+  Z_UNUSED(client);
+  Z_UNUSED(resource);
+  Z_UNUSED(size);
+  close(fd);
+}
+
+static void
+zms_mock_opengl_shader_program_protocol_link(
+    struct wl_client* client, struct wl_resource* resource)
+{
+  Z_UNUSED(client);
+  Z_UNUSED(resource);
+}
+
+static const struct zgn_opengl_shader_program_interface
+    shader_program_interface = {
+        .destroy = zms_mock_opengl_protocol_destroy,
+        .set_uniform_float_vector =
+            zms_mock_opengl_shader_program_protocol_set_uniform_float_vector,
+        .set_uniform_float_matrix =
+            zms_mock_opengl_shader_program_protocol_set_uniform_float_matrix,
+        .set_vertex_shader = zms_mock_opengl_shader_program_protocol_set_shader,
+        .set_fragment_shader =
+            zms_mock_opengl_shader_program_protocol_set_shader,
+        .link = zms_mock_opengl_shader_program_protocol_link,
+};
+
+static void
+zms_mock_opengl_texture_protocol_attach_2d(struct wl_client* client,
+    struct wl_resource* resource, struct wl_resource* buffer)
+{
+  Z_UNUSED(client);
+  struct zms_mock* mock = wl_resource_get_user_data(resource);
+  size_t bytes;
+
+  bytes = zms_mock_release_buffer_later(mock, buffer);
+
+  mock->total_stats.texture_attaches++;
+  mock->total_stats.texture_bytes += bytes;
+  mock->report_stats.texture_attaches++;
+  mock->report_stats.texture_bytes += bytes;
+  zms_mock_trace(mock, "attach", bytes);
+}
+
+static const struct zgn_opengl_texture_interface texture_interface = {
+    .destroy = zms_mock_opengl_protocol_destroy,
+    .attach_2d = zms_mock_opengl_texture_protocol_attach_2d,
+};
+
+static void
+zms_mock_opengl_create_resource(struct wl_client* client,
+    struct wl_resource* resource, uint32_t id,
+    const struct wl_interface* interface, const void* implementation)
+{
+  struct zms_mock* mock = wl_resource_get_user_data(resource);
+  struct wl_resource* new_resource;
+
+  new_resource = wl_resource_create(client, interface, 1, id);
+  if (new_resource == NULL) {
+    wl_client_post_no_memory(client);
+    return;
+  }
+
+  wl_resource_set_implementation(new_resource, implementation, mock, NULL);
+}
+
+static void
+zms_mock_opengl_protocol_create_opengl_component(struct wl_client* client,
+    struct wl_resource* resource, uint32_t id,
+    struct wl_resource* virtual_object)
+{
+  Z_UNUSED(virtual_object);
+  zms_mock_opengl_create_resource(client, resource, id,
+      &zgn_opengl_component_interface, &component_interface);
+}
+
+static void
+zms_mock_opengl_protocol_create_vertex_buffer(
+    struct wl_client* client, struct wl_resource* resource, uint32_t id)
+{
+  zms_mock_opengl_create_resource(client, resource, id,
+      &zgn_opengl_vertex_buffer_interface, &vertex_buffer_interface);
+}
+
+static void
+zms_mock_opengl_protocol_create_shader_program(
+    struct wl_client* client, struct wl_resource* resource, uint32_t id)
+{
+  zms_mock_opengl_create_resource(client, resource, id,
+      &zgn_opengl_shader_program_interface, &shader_program_interface);
+}
+
+static void
+zms_mock_opengl_protocol_create_texture(
+    struct wl_client* client, struct wl_resource* resource, uint32_t id)
+{
+  zms_mock_opengl_create_resource(
+      client, resource, id, &zgn_opengl_texture_interface, &texture_interface);
+}
+
+static const struct zgn_opengl_interface opengl_interface = {
+    .destroy = zms_mock_opengl_protocol_destroy,
+    .create_opengl_component = zms_mock_opengl_protocol_create_opengl_component,
+    .create_vertex_buffer = zms_mock_opengl_protocol_create_vertex_buffer,
+    .create_shader_program = zms_mock_opengl_protocol_create_shader_program,
+    .create_texture = zms_mock_opengl_protocol_create_texture,
+};
+
+static void
+zms_mock_opengl_bind(
+    struct wl_client* client, void* data, uint32_t version, uint32_t id)
+{
+  struct wl_resource* resource;
+
+  resource = wl_resource_create(client, &zgn_opengl_interface, version, id);
+  if (resource == NULL) {
+    wl_client_post_no_memory(client);
+    return;
+  }
+
+  wl_resource_set_implementation(resource, &opengl_interface, data, NULL);
+}
+
+ZMS_EXPORT bool
+zms_mock_opengl_init(struct zms_mock* mock)
+{
+  if (wl_global_create(mock->display, &zgn_opengl_interface, 1, mock,
+          zms_mock_opengl_bind) == NULL) {
+    zms_log("failed to create a zgn_opengl global\n");
+    return false;
+  }
+
+  return true;
+}
@@ -0,0 +1,352 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <zigen-server-protocol.h>
+
+#include "mock.h"
+
+static struct zms_mock_virtual_object*
+zms_mock_seat_pick_virtual_object(struct zms_mock* mock)
+{
+  struct zms_mock_virtual_object* virtual_object;
+
+  // the newest one, as it would be in front of the others
+  wl_list_for_each(virtual_object, &mock->virtual_object_list, link)
+  {
+    if (virtual_object->has_cuboid_window) return virtual_object;
+  }
+
+  return NULL;
+}
+
+static uint32_t
+zms_mock_seat_next_serial(struct zms_mock* mock)
+{
+  return wl_display_next_serial(mock->display);
+}
+
+static void
+zms_mock_seat_ray_enter(struct zms_mock* mock)
+{
+  struct zms_mock_virtual_object* virtual_object;
+  struct wl_client* client;
+  struct wl_resource* ray;
+  struct wl_array origin, direction;
+
+  if (mock->ray_focus) return;
+
+  virtual_object = zms_mock_seat_pick_virtual_object(mock);
+  if (virtual_object == NULL) {
+    zms_log("no virtual object to enter\n");
+    return;
+  }
+
+  client = wl_resource_get_client(virtual_object->resource);
+  mock->ray_focus = virtual_object;
+
+  wl_array_init(&origin);
+  wl_array_init(&direction);
+  glm_vec3_to_wl_array(mock->ray_origin, &origin);
+  glm_vec3_to_wl_array(mock->ray_direction, &direction);
+
+  wl_resource_for_each(ray, &mock->ray_list)
+  {
+    if (wl_resource_get_client(ray) != client) continue;
+    zgn_ray_send_enter(ray, zms_mock_seat_next_serial(mock),
+        virtual_object->resource, &origin, &direction);
+  }
+
+  wl_array_release(&origin);
+  wl_array_release(&direction);
+}
+
+static void
+zms_mock_seat_ray_leave(struct zms_mock* mock)
+{
+  struct zms_mock_virtual_object* virtual_object = mock->ray_focus;
+  struct wl_client* client;
+  struct wl_resource* ray;
+
+  if (virtual_object == NULL) return;
+
+  client = wl_resource_get_client(virtual_object->resource);
+  mock->ray_focus = NULL;
+
+  wl_resource_for_each(ray, &mock->ray_list)
+  {
+    if (wl_resource_get_client(ray) != client) continue;
+    zgn_ray_send_leave(
+        ray, zms_mock_seat_next_serial(mock), virtual_object->resource);
+  }
+}
+
+static void
+zms_mock_seat_ray_motion(struct zms_mock* mock, vec3 origin, vec3 direction)
+{
+  struct wl_client* client;
+  struct wl_resource* ray;
+  struct wl_array origin_array, direction_array;
+
+  glm_vec3_copy(origin, mock->ray_origin);
+  glm_vec3_copy(direction, mock->ray_direction);
+
+  if (mock->ray_focus == NULL) return;
+
+  client = wl_resource_get_client(mock->ray_focus->resource);
+
+  wl_array_init(&origin_array);
+  wl_array_init(&direction_array);
+  glm_vec3_to_wl_array(origin, &origin_array);
+  glm_vec3_to_wl_array(direction, &direction_array);
+
+  wl_resource_for_each(ray, &mock->ray_list)
+  {
+    if (wl_resource_get_client(ray) != client) continue;
+    zgn_ray_send_motion(
+        ray, zms_mock_get_time(), &origin_array, &direction_array);
+  }
+
+  wl_array_release(&origin_array);
+  wl_array_release(&direction_array);
+}
+
+static void
+zms_mock_seat_ray_button(struct zms_mock* mock, uint32_t button, bool pressed)
+{
+  struct wl_client* client;
+  struct wl_resource* ray;
+
+  if (mock->ray_focus == NULL) return;
+
+  client = wl_resource_get_client(mock->ray_focus->resource);
+
+  wl_resource_for_each(ray, &mock->ray_list)
+  {
+    if (wl_resource_get_client(ray) != client) continue;
+    zgn_ray_send_button(ray, zms_mock_seat_next_serial(mock),
+        zms_mock_get_time(), button,
+        pressed ? ZGN_RAY_BUTTON_STATE_PRESSED
+                : ZGN_RAY_BUTTON_STATE_RELEASED);
+  }
+}
+
+static void
+zms_mock_seat_keyboard_enter(struct zms_mock* mock)
+{
+  struct zms_mock_virtual_object* virtual_object;
+  struct wl_client* client;
+  struct wl_resource* keyboard;
+  struct wl_array keys;
+
+  if (mock->keyboard_focus) return;
+
+  virtual_object = zms_mock_seat_pick_virtual_object(mock);
+  if (virtual_object == NULL) {
+    zms_log("no virtual object to enter\n");
+    return;
+  }
+
+  client = wl_resource_get_client(virtual_object->resource);
+  mock->keyboard_focus = virtual_object;
+
+  wl_array_init(&keys);
+
+  wl_resource_for_each(keyboard, &mock->keyboard_list)
+  {
+    if (wl_resource_get_client(keyboard) != client) continue;
+    zgn_keyboard_send_enter(keyboard, zms_mock_seat_next_serial(mock),
+        virtual_object->resource, &keys);
+  }
+
+  wl_array_release(&keys);
+}
+
+static void
+zms_mock_seat_keyboard_leave(struct zms_mock* mock)
+{
+  struct zms_mock_virtual_object* virtual_object = mock->keyboard_focus;
+  struct wl_client* client;
+  struct wl_resource* keyboard;
+
+  if (virtual_object == NULL) return;
+
+  client = wl_resource_get_client(virtual_object->resource);
+  mock->keyboard_focus = NULL;
+
+  wl_resource_for_each(keyboard, &mock->keyboard_list)
+  {
+    if (wl_resource_get_client(keyboard) != client) continue;
+    zgn_keyboard_send_leave(
+        keyboard, zms_mock_seat_next_serial(mock), virtual_object->resource);
+  }
+}
+
+static void
+zms_mock_seat_keyboard_key(struct zms_mock* mock, uint32_t key, bool pressed)
+{
+  struct wl_client* client;
+  struct wl_resource* keyboard;
+
+  if (mock->keyboard_focus == NULL) return;
+
+  client = wl_resource_get_client(mock->keyboard_focus->resource);
+
+  wl_resource_for_each(keyboard, &mock->keyboard_list)
+  {
+    if (wl_resource_get_client(keyboard) != client) continue;
+    zgn_keyboard_send_key(keyboard, zms_mock_seat_next_serial(mock),
+        zms_mock_get_time(), key,
+        pressed ? WL_KEYBOARD_KEY_STATE_PRESSED
+                : WL_KEYBOARD_KEY_STATE_RELEASED);
+  }
+}
+
+static int
+zms_mock_seat_parse_state(const char* state)
+{
+  if (strcmp(state, "pressed") == 0) return 1;
+  if (strcmp(state, "released") == 0) return 0;
+  return -1;
+}
+
+ZMS_EXPORT void
+zms_mock_seat_run_command(struct zms_mock* mock, char* command)
+{
+  char state[16];
+  vec3 origin, direction;
+  uint32_t code;
+  int pressed;
+
+  if (strcmp(command, "ray enter") == 0) {
+    zms_mock_seat_ray_enter(mock);
+  } else if (strcmp(command, "ray leave") == 0) {
+    zms_mock_seat_ray_leave(mock);
+  } else if (sscanf(command, "ray motion %f %f %f %f %f %f", &origin[0],
+                 &origin[1], &origin[2], &direction[0], &direction[1],
+                 &direction[2]) == 6) {
+    zms_mock_seat_ray_motion(mock, origin, direction);
+  } else if (sscanf(command, "ray button %u %15s", &code, state) == 2 &&
+             (pressed = zms_mock_seat_parse_state(state)) != -1) {
+    zms_mock_seat_ray_button(mock, code, pressed);
+  } else if (strcmp(command, "keyboard enter") == 0) {
+    zms_mock_seat_keyboard_enter(mock);
+  } else if (strcmp(command, "keyboard leave") == 0) {
+    zms_mock_seat_keyboard_leave(mock);
+  } else if (sscanf(command, "key %u %15s", &code, state) == 2 &&
+             (pressed = zms_mock_seat_parse_state(state)) != -1) {
+    zms_mock_seat_keyboard_key(mock, code, pressed);
+  } else {
+    zms_log("unknown command: %s\n", command);
+  }
+}
+
+static void
+zms_mock_seat_device_handle_destroy(struct wl_resource* resource)
+{
+  wl_list_remove(wl_resource_get_link(resource));
+}
+
+static void
+zms_mock_seat_device_protocol_release(
+    struct wl_client* client, struct wl_resource* resource)
+{
+  Z_UNUSED(client);
+  wl_resource_destroy(resource);
+}
+
+static const struct zgn_ray_interface ray_interface = {
+    .release = zms_mock_seat_device_protocol_release,
+};
+
+static const struct zgn_keyboard_interface keyboard_interface = {
+    .release = zms_mock_seat_device_protocol_release,
+};
+
+static void
+zms_mock_seat_protocol_get_ray(
+    struct wl_client* client, struct wl_resource* resource, uint32_t id)
+{
+  struct zms_mock* mock = wl_resource_get_user_data(resource);
+  struct wl_resource* ray;
+
+  ray = wl_resource_create(client, &zgn_ray_interface, 1, id);
+  if (ray == NULL) {
+    wl_client_post_no_memory(client);
+    return;
+  }
+
+  wl_resource_set_implementation(
+      ray, &ray_interface, mock, zms_mock_seat_device_handle_destroy);
+  wl_list_insert(&mock->ray_list, wl_resource_get_link(ray));
+}
+
+static void
+zms_mock_seat_protocol_get_keyboard(
+    struct wl_client* client, struct wl_resource* resource, uint32_t id)
+{
+  struct zms_mock* mock = wl_resource_get_user_data(resource);
+  struct wl_resource* keyboard;
+  int fd;
+
+  keyboard = wl_resource_create(client, &zgn_keyboard_interface, 1, id);
+  if (keyboard == NULL) {
+    wl_client_post_no_memory(client);
+    return;
+  }
+
+  wl_resource_set_implementation(keyboard, &keyboard_interface, mock,
+      zms_mock_seat_device_handle_destroy);
+  wl_list_insert(&mock->keyboard_list, wl_resource_get_link(keyboard));
+
+  // keys are sent as raw evdev codes
+  fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
+    zms_log("failed to open /dev/null\n");
+    return;
+  }
+  zgn_keyboard_send_keymap(
+      keyboard, ZGN_KEYBOARD_KEYMAP_FORMAT_NO_KEYMAP, fd, 0);
+  close(fd);
+}
+
+static const struct zgn_seat_interface seat_interface = {
+    .get_ray = zms_mock_seat_protocol_get_ray,
+    .get_keyboard = zms_mock_seat_protocol_get_keyboard,
+};
+
+static void
+zms_mock_seat_bind(
+    struct wl_client* client, void* data, uint32_t version, uint32_t id)
+{
+  struct wl_resource* resource;
+
+  resource = wl_resource_create(client, &zgn_seat_interface, version, id);
+  if (resource == NULL) {
+    wl_client_post_no_memory(client);
+    return;
+  }
+
+  wl_resource_set_implementation(resource, &seat_interface, data, NULL);
+
+  zgn_seat_send_capabilities(
+      resource, ZGN_SEAT_CAPABILITY_RAY | ZGN_SEAT_CAPABILITY_KEYBOARD);
+}
+
+ZMS_EXPORT bool
+zms_mock_seat_init(struct zms_mock* mock)
+{
+  if (wl_global_create(mock->display, &zgn_seat_interface, 1, mock,
+          zms_mock_seat_bind) == NULL) {
+    zms_log("failed to create a zgn_seat global\n");
+    return false;
+  }
+
+  wl_list_init(&mock->ray_list);
+  wl_list_init(&mock->keyboard_list);
+  glm_vec3_zero(mock->ray_origin);
+  glm_vec3_zero(mock->ray_direction);
+  mock->ray_direction[2] = -1;
+
+  return true;
+}
@@ -0,0 +1,172 @@
+#include <zigen-shell-server-protocol.h>
+
+#include "mock.h"
+
+struct zms_mock_cuboid_window {
+  struct wl_resource* resource;
+  vec3 half_size;
+  versor quaternion;
+};
+
+static void
+zms_mock_cuboid_window_configure(struct zms_mock_cuboid_window* cuboid_window)
+{
+  struct wl_client* client = wl_resource_get_client(cuboid_window->resource);
+  struct wl_display* display = wl_client_get_display(client);
+  struct wl_array half_size, quaternion;
+
+  wl_array_init(&half_size);
+  wl_array_init(&quaternion);
+  glm_vec3_to_wl_array(cuboid_window->half_size, &half_size);
+  glm_versor_to_wl_array(cuboid_window->quaternion, &quaternion);
+
+  // whatever requested is granted
+  zgn_cuboid_window_send_configure(cuboid_window->resource,
+      wl_display_next_serial(display), &half_size, &quaternion);
+
+  wl_array_release(&half_size);
+  wl_array_release(&quaternion);
+}
+
+static void
+zms_mock_cuboid_window_handle_destroy(struct wl_resource* resource)
+{
+  struct zms_mock_cuboid_window* cuboid_window;
+
+  cuboid_window = wl_resource_get_user_data(resource);
+
+  free(cuboid_window);
+}
+
+static void
+zms_mock_cuboid_window_protocol_destroy(
+    struct wl_client* client, struct wl_resource* resource)
+{
+  Z_UNUSED(client);
+  wl_resource_destroy(resource);
+}
+
+static void
+zms_mock_cuboid_window_protocol_ack_configure(
+    struct wl_client* client, struct wl_resource* resource, uint32_t serial)
+{
+  Z_UNUSED(client);
+  Z_UNUSED(resource);
+  Z_UNUSED(serial);
+}
+
+static void
+zms_mock_cuboid_window_protocol_move(struct wl_client* client,
+    struct wl_resource* resource, struct wl_resource* seat, uint32_t serial)
+{
+  Z_UNUSED(client);
+  Z_UNUSED(resource);
+  Z_UNUSED(seat);
+  Z_UNUSED(serial);
+}
+
+static void
+zms_mock_cuboid_window_protocol_rotate(struct wl_client* client,
+    struct wl_resource* resource, struct wl_array* quaternion)
+{
+  Z_UNUSED(client);
+  struct zms_mock_cuboid_window* cuboid_window;
+
+  cuboid_window = wl_resource_get_user_data(resource);
+
+  if (glm_versor_from_wl_array(cuboid_window->quaternion, quaternion) != 0)
+    return;
+
+  zms_mock_cuboid_window_configure(cuboid_window);
+}
+
+static const struct zgn_cuboid_window_interface cuboid_window_interface = {
+    .destroy = zms_mock_cuboid_window_protocol_destroy,
+    .ack_configure = zms_mock_cuboid_window_protocol_ack_configure,
+    .move = zms_mock_cuboid_window_protocol_move,
+    .rotate = zms_mock_cuboid_window_protocol_rotate,
+};
+
+static void
+zms_mock_shell_protocol_destroy(
+    struct wl_client* client, struct wl_resource* resource)
+{
+  Z_UNUSED(client);
+  wl_resource_destroy(resource);
+}
+
+static void
+zms_mock_shell_protocol_get_cuboid_window(struct wl_client* client,
+    struct wl_resource* resource, uint32_t id,
+    struct wl_resource* virtual_object_resource, struct wl_array* half_size,
+    struct wl_array* quaternion)
+{
+  Z_UNUSED(resource);
+  struct zms_mock_virtual_object* virtual_object;
+  struct zms_mock_cuboid_window* cuboid_window;
+  struct wl_resource* cuboid_window_resource;
+
+  virtual_object = wl_resource_get_user_data(virtual_object_resource);
+
+  cuboid_window = zalloc(sizeof *cuboid_window);
+  if (cuboid_window == NULL) {
+    wl_client_post_no_memory(client);
+    return;
+  }
+
+  if (glm_vec3_from_wl_array(cuboid_window->half_size, half_size) != 0 ||
+      glm_versor_from_wl_array(cuboid_window->quaternion, quaternion) != 0) {
+    zms_log("invalid cuboid window size or quaternion\n");
+    glm_vec3_zero(cuboid_window->half_size);
+    glm_quat_identity(cuboid_window->quaternion);
+  }
+
+  cuboid_window_resource =
+      wl_resource_create(client, &zgn_cuboid_window_interface, 1, id);
+  if (cuboid_window_resource == NULL) {
+    free(cuboid_window);
+    wl_client_post_no_memory(client);
+    return;
+  }
+
+  wl_resource_set_implementation(cuboid_window_resource,
+      &cuboid_window_interface, cuboid_window,
+      zms_mock_cuboid_window_handle_destroy);
+
+  cuboid_window->resource = cuboid_window_resource;
+  virtual_object->has_cuboid_window = true;
+
+  zms_mock_cuboid_window_configure(cuboid_window);
+}
+
+static const struct zgn_shell_interface shell_interface = {
+    .destroy = zms_mock_shell_protocol_destroy,
+    .get_cuboid_window = zms_mock_shell_protocol_get_cuboid_window,
+};
+
+static void
+zms_mock_shell_bind(
+    struct wl_client* client, void* data, uint32_t version, uint32_t id)
+{
+  struct wl_resource* resource;
+
+  resource = wl_resource_create(client, &zgn_shell_interface, version, id);
+  if (resource == NULL) {
+    wl_client_post_no_memory(client);
+    return;
+  }
+
+  wl_resource_set_implementation(resource, &shell_interface, data, NULL);
+}
+
+ZMS_EXPORT bool
+zms_mock_shell_init(struct zms_mock* mock)
+{
+  if (wl_global_create(mock->display, &zgn_shell_interface, 1, mock,
+          zms_mock_shell_bind) == NULL) {
+    zms_log("failed to create a zgn_shell global\n");
+    return false;
+  }
+
+  return true;
+}
@@ -0,0 +1,497 @@
+#include <errno.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+#include <zmonitors-util.h>
+
+#define DEFAULT_INTERVAL_MSEC 1000
+// same as zms_metrics_histogram of the server library
+#define HISTOGRAM_BUCKET_COUNT 24
+
+struct options {
+  const char* display;
+  int interval_msec;
+  int count;  // 0 to repeat forever
+  bool batch;
+};
+
+/* A line of the snapshot "kind id key=value ..." has one of these per key */
+struct metric {
+  char kind[16];
+  char id[32];
+  char key[32];
+  uint64_t value;
+};
+
+struct snapshot {
+  struct wl_array metrics;  // struct metric
+};
+
+struct client_row {
+  int pid;
+  uint64_t commits;
+  double commit_rate;
+};
+
+static void
+print_usage(const char* program)
+{
+  fprintf(stderr,
+      "usage: %s [options]\n"
+      "\n"
+      "Show the metrics of a running zmonitors: frames of each monitor,\n"
+      "composited pixels, bytes copied, texture uploads, commits of each\n"
+      "client, frame callback latency and the time taken by each event\n"
+      "source.\n"
+      "\n"
+      "  -d, --display=NAME   the wayland display of zmonitors\n"
+      "                       (default: $WAYLAND_DISPLAY or wayland-0)\n"
+      "  -i, --interval=MSEC  refresh every MSEC (default: 1000)\n"
+      "  -n, --count=N        exit after N refreshes\n"
+      "  -b, --batch          append each refresh instead of clearing the\n"
+      "                       screen, e.g. to log to a file\n"
+      "  -h, --help           show this help\n",
+      program);
+}
+
+static bool
+parse_options(int argc, char* argv[], struct options* options)
+{
+  static const struct option long_options[] = {
+      {"display", required_argument, NULL, 'd'},
+      {"interval", required_argument, NULL, 'i'},
+      {"count", required_argument, NULL, 'n'},
+      {"batch", no_argument, NULL, 'b'},
+      {"help", no_argument, NULL, 'h'},
+      {NULL, 0, NULL, 0},
+  };
+  int opt, value;
+
+  while ((opt = getopt_long(argc, argv, "d:i:n:bh", long_options, NULL)) !=
+         -1) {
+    if ((opt == 'i' || opt == 'n') &&
+        (sscanf(optarg, "%d", &value) != 1 || value < 1)) {
+      zms_log("invalid argument: %s\n", optarg);
+      return false;
+    }
+
+    switch (opt) {
+      case 'd':
+        options->display = optarg;
+        break;
+
+      case 'i':
+        options->interval_msec = value;
+        break;
+
+      case 'n':
+        options->count = value;
+        break;
+
+      case 'b':
+        options->batch = true;
+        break;
+
+      case 'h':
+      default:
+        print_usage(argv[0]);
+        return false;
+    }
+  }
+
+  return true;
+}
+
+static void
+snapshot_parse_line(struct snapshot* snapshot, char* line)
+{
+  struct metric* metric;
+  char *kind, *id, *token, *value, *saveptr;
+
+  kind = strtok_r(line, " \n", &saveptr);
+  id = strtok_r(NULL, " \n", &saveptr);
+  if (kind == NULL || id == NULL) return;
+
+  while ((token = strtok_r(NULL, " \n", &saveptr))) {
+    value = strchr(token, '=');
+    if (value == NULL) continue;
+    *value++ = '\0';
+
+    metric = wl_array_add(&snapshot->metrics, sizeof *metric);
+    if (metric == NULL) return;
+
+    snprintf(metric->kind, sizeof metric->kind, "%s", kind);
+    snprintf(metric->id, sizeof metric->id, "%s", id);
+    snprintf(metric->key, sizeof metric->key, "%s", token);
+    metric->value = strtoull(value, NULL, 10);
+  }
+}
+
+static bool
+snapshot_read(struct snapshot* snapshot, const char* path)
+{
+  struct sockaddr_un addr = {.sun_family = AF_UNIX};
+  char *data = NULL, *line, *saveptr;
+  size_t size = 0, capacity = 0;
+  ssize_t length;
+  int fd;
+
+  wl_array_init(&snapshot->metrics);
+
+  if (strlen(path) >= sizeof addr.sun_path) {
+    zms_log("metrics socket path too long: %s\n", path);
+    return false;
+  }
+  strcpy(addr.sun_path, path);
+
+  fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) return false;
+
+  if (connect(fd, (struct sockaddr*)&addr, sizeof addr) < 0) {
+    zms_log("failed to connect to %s: %s\n", path, strerror(errno));
+    goto err;
+  }
+
+  // the server sends a snapshot and closes the connection
+  do {
+    if (capacity - size < 4096) {
+      capacity = capacity * 2 + 4096;
+      char* new_data = realloc(data, capacity + 1);
+      if (new_data == NULL) goto err;
+      data = new_data;
+    }
+    length = read(fd, data + size, capacity - size);
+    if (length < 0 && errno == EINTR) continue;
+    if (length < 0) goto err;
+    size += length;
+  } while (length > 0);
+
+  close(fd);
+
+  if (data == NULL) return false;
+  data[size] = '\0';
+
+  for (line = strtok_r(data, "\n", &saveptr); line;
+       line = strtok_r(NULL, "\n", &saveptr))
+    snapshot_parse_line(snapshot, line);
+
+  free(data);
+
+  return true;
+
+err:
+  free(data);
+  close(fd);
+  return false;
+}
+
+static void
+snapshot_fini(struct snapshot* snapshot)
+{
+  wl_array_release(&snapshot->metrics);
+}
+
+/* @return 0 if not found, e.g. for an object which did not exist yet */
+static uint64_t
+snapshot_get(struct snapshot* snapshot, const char* kind, const char* id,
+    const char* key)
+{
+  struct metric* metric;
+
+  wl_array_for_each(metric, &snapshot->metrics)
+  {
+    if (strcmp(metric->kind, kind) == 0 && strcmp(metric->id, id) == 0 &&
+        strcmp(metric->key, key) == 0)
+      return metric->value;
+  }
+
+  return 0;
+}
+
+struct rate_context {
+  struct snapshot* now;
+  struct snapshot* prev;
+  double seconds;
+};
+
+static double
+get_rate(struct rate_context* context, const char* kind, const char* id,
+    const char* key)
+{
+  uint64_t now = snapshot_get(context->now, kind, id, key);
+  uint64_t prev = snapshot_get(context->prev, kind, id, key);
+
+  if (now < prev || context->seconds <= 0) return 0;
+
+  return (now - prev) / context->seconds;
+}
+
+/* Upper bound of the histogram bucket where the given fraction is reached */
+static uint64_t
+get_percentile(uint64_t* buckets, uint64_t count, double fraction)
+{
+  uint64_t sum = 0;
+
+  for (int i = 0; i < HISTOGRAM_BUCKET_COUNT; i++) {
+    sum += buckets[i];
+    if (sum >= count * fraction) return (uint64_t)2 << i;
+  }
+
+  return (uint64_t)2 << (HISTOGRAM_BUCKET_COUNT - 1);
+}
+
+static void
+print_compositor(struct rate_context* context)
+{
+  static const char* rows[][2] = {
+      {"composited_pixels", "composited pixels"},
+      {"copied_bytes", "copied bytes"},
+      {"texture_uploads", "texture uploads"},
+      {"texture_upload_bytes", "texture upload bytes"},
+  };
+
+  printf("%-24s %16s %16s\n", "COMPOSITOR", "TOTAL", "PER SEC");
+  for (size_t i = 0; i < sizeof rows / sizeof rows[0]; i++) {
+    printf("%-24s %16" PRIu64 " %16.0f\n", rows[i][1],
+        snapshot_get(context->now, "compositor", "main", rows[i][0]),
+        get_rate(context, "compositor", "main", rows[i][0]));
+  }
+}
+
+static void
+print_frame_latency(struct rate_context* context)
+{
+  const char* name = "frame_latency_usec";
+  uint64_t buckets[HISTOGRAM_BUCKET_COUNT];
+  uint64_t count, sum;
+  char key[8];
+
+  count = snapshot_get(context->now, "histogram", name, "count") -
+          snapshot_get(context->prev, "histogram", name, "count");
+  sum = snapshot_get(context->now, "histogram", name, "sum") -
+        snapshot_get(context->prev, "histogram", name, "sum");
+
+  for (int i = 0; i < HISTOGRAM_BUCKET_COUNT; i++) {
+    snprintf(key, sizeof key, "b%d", i);
+    buckets[i] = snapshot_get(context->now, "histogram", name, key) -
+                 snapshot_get(context->prev, "histogram", name, key);
+  }
+
+  printf("\n%-24s %10s %10s %10s %10s %10s\n", "FRAME CALLBACK LATENCY",
+      "PER SEC", "AVG USEC", "P50 <=", "P90 <=", "P99 <=");
+  if (count == 0) {
+    printf("%-24s %10.1f %10s %10s %10s %10s\n", "", 0.0, "-", "-", "-", "-");
+    return;
+  }
+
+  printf("%-24s %10.1f %10" PRIu64 " %10" PRIu64 " %10" PRIu64 " %10" PRIu64
+         "\n",
+      "", count / context->seconds, sum / count,
+      get_percentile(buckets, count, 0.5), get_percentile(buckets, count, 0.9),
+      get_percentile(buckets, count, 0.99));
+}
+
+static void
+print_outputs(struct rate_context* context)
+{
+  struct metric* metric;
+
+  printf("\n%-8s %12s %10s %10s %12s\n", "OUTPUT", "SIZE", "FRAMES/S",
+      "REPAINTS/S", "MPIXELS/S");
+
+  wl_array_for_each(metric, &context->now->metrics)
+  {
+    char size[24];
+    if (strcmp(metric->kind, "output") != 0 || strcmp(metric->key, "frames"))
+      continue;
+
+    snprintf(size, sizeof size, "%" PRIu64 "x%" PRIu64,
+        snapshot_get(context->now, "output", metric->id, "width"),
+        snapshot_get(context->now, "output", metric->id, "height"));
+
+    printf("%-8s %12s %10.1f %10.1f %12.2f\n", metric->id, size,
+        get_rate(context, "output", metric->id, "frames"),
+        get_rate(context, "output", metric->id, "repaints"),
+        get_rate(context, "output", metric->id, "composited_pixels") / 1e6);
+  }
+}
+
+static void
+print_sources(struct rate_context* context)
+{
+  struct metric* metric;
+
+  printf("\n%-24s %10s %10s\n", "EVENT SOURCE", "CALLS/S", "BUSY %");
+
+  wl_array_for_each(metric, &context->now->metrics)
+  {
+    if (strcmp(metric->kind, "source") != 0 || strcmp(metric->key, "count"))
+      continue;
+
+    printf("%-24s %10.1f %10.2f\n", metric->id,
+        get_rate(context, "source", metric->id, "count"),
+        get_rate(context, "source", metric->id, "nsec") / 1e7);
+  }
+}
+
+static void
+read_command(int pid, char* command, size_t size)
+{
+  char path[64];
+  FILE* file;
+
+  snprintf(command, size, "?");
+
+  snprintf(path, sizeof path, "/proc/%d/comm", pid);
+  file = fopen(path, "r");
+  if (file == NULL) return;
+
+  if (fgets(command, size, file)) command[strcspn(command, "\n")] = '\0';
+
+  fclose(file);
+}
+
+static int
+compare_client_rows(const void* a, const void* b)
+{
+  const struct client_row *x = a, *y = b;
+
+  if (x->commit_rate != y->commit_rate)
+    return x->commit_rate < y->commit_rate ? 1 : -1;
+
+  return (x->commits < y->commits) - (x->commits > y->commits);
+}
+
+/* The busiest clients first */
+static void
+print_clients(struct rate_context* context)
+{
+  struct metric* metric;
+  struct client_row* row;
+  struct wl_array rows;
+  char command[32];
+  size_t count;
+
+  wl_array_init(&rows);
+
+  wl_array_for_each(metric, &context->now->metrics)
+  {
+    if (strcmp(metric->kind, "client") != 0 || strcmp(metric->key, "commits"))
+      continue;
+
+    row = wl_array_add(&rows, sizeof *row);
+    if (row == NULL) break;
+    row->pid = atoi(metric->id);
+    row->commits = metric->value;
+    row->commit_rate = get_rate(context, "client", metric->id, "commits");
+  }
+
+  count = rows.size / sizeof *row;
+  qsort(rows.data, count, sizeof *row, compare_client_rows);
+
+  printf("\n%-8s %-16s %10s %12s\n", "PID", "CLIENT", "COMMITS/S", "COMMITS");
+
+  wl_array_for_each(row, &rows)
+  {
+    read_command(row->pid, command, sizeof command);
+    printf("%-8d %-16s %10.1f %12" PRIu64 "\n", row->pid, command,
+        row->commit_rate, row->commits);
+  }
+
+  wl_array_release(&rows);
+}
+
+static void
+print_snapshots(struct options* options, struct snapshot* now,
+    struct snapshot* prev)
+{
+  struct rate_context context;
+
+  context.now = now;
+  context.prev = prev;
+  context.seconds = (snapshot_get(now, "time", "now", "nsec") -
+                        snapshot_get(prev, "time", "now", "nsec")) /
+                    1e9;
+
+  // clear the screen and move to the top left
+  if (options->batch == false) printf("\033[H\033[2J");
+
+  printf("zmonitors-top: %s, over %.2f s\n\n", options->display,
+      context.seconds);
+
+  print_compositor(&context);
+  print_frame_latency(&context);
+  print_outputs(&context);
+  print_sources(&context);
+  print_clients(&context);
+
+  if (options->batch) printf("\n");
+  fflush(stdout);
+}
+
+static void
+sleep_msec(int msec)
+{
+  struct timespec duration = {msec / 1000, (msec % 1000) * 1000000};
+
+  while (nanosleep(&duration, &duration) < 0 && errno == EINTR)
+    ;
+}
+
+int
+main(int argc, char* argv[])
+{
+  struct options options = {
+      .display = getenv("WAYLAND_DISPLAY"),
+      .interval_msec = DEFAULT_INTERVAL_MSEC,
+      .count = 0,
+      .batch = false,
+  };
+  struct snapshot snapshots[2];
+  const char* runtime_dir = getenv("XDG_RUNTIME_DIR");
+  char path[256];
+  int current = 0, exit_code = EXIT_FAILURE;
+
+  if (options.display == NULL) options.display = "wayland-0";
+
+  if (parse_options(argc, argv, &options) == false) goto out;
+
+  if (runtime_dir == NULL) {
+    zms_log("XDG_RUNTIME_DIR is not set\n");
+    goto out;
+  }
+
+  // the same path as zms_compositor_listen_metrics
+  snprintf(path, sizeof path, "%s/%s.metrics", runtime_dir, options.display);
+
+  if (snapshot_read(&snapshots[current], path) == false) goto out;
+
+  // rates need two snapshots
+  for (int i = 0; options.count == 0 || i < options.count; i++) {
+    sleep_msec(options.interval_msec);
+
+    current = !current;
+    if (snapshot_read(&snapshots[current], path) == false) {
+      snapshot_fini(&snapshots[current]);
+      current = !current;
+      goto out_snapshot;
+    }
+
+    print_snapshots(&options, &snapshots[current], &snapshots[!current]);
+    snapshot_fini(&snapshots[!current]);
+  }
+
+  exit_code = EXIT_SUCCESS;
+
+out_snapshot:
+  snapshot_fini(&snapshots[current]);
+
+out:
+  return exit_code;
+}
@@ -0,0 +1,299 @@
+#include <fcntl.h>
+#include <limits.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#include <zmonitors-util.h>
+
+/* Events kept per thread; 2 MiB each */
+#define ZMS_TRACE_RING_SIZE (1 << 16)
+
+#define ZMS_TRACE_WRITE_BUFFER_SIZE 4096
+
+struct zms_trace_event {
+  uint64_t nsec;  // CLOCK_MONOTONIC
+  const char *name;
+  int64_t value;
+  enum zms_trace_event_type type;
+};
+
+struct zms_trace_ring {
+  struct zms_trace_ring *next;
+  pid_t tid;
+  // events written so far; events[count % ZMS_TRACE_RING_SIZE] is the next
+  uint64_t count;
+  struct zms_trace_event events[ZMS_TRACE_RING_SIZE];
+};
+
+/* Text written to a fd without stdio, so that a crash can be dumped */
+struct zms_trace_writer {
+  int fd;
+  size_t length;
+  bool failed;
+  char data[ZMS_TRACE_WRITE_BUFFER_SIZE];
+};
+
+static const int crash_signals[] = {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT};
+
+#define CRASH_SIGNAL_COUNT (sizeof crash_signals / sizeof crash_signals[0])
+
+ZMS_EXPORT bool zms_trace_enabled = false;
+
+static char trace_path[PATH_MAX];
+
+// rings are only pushed while tracing, and freed by zms_trace_stop
+static struct zms_trace_ring *ring_list = NULL;
+static uint32_t ring_generation = 0;
+
+static __thread struct zms_trace_ring *thread_ring = NULL;
+static __thread uint32_t thread_ring_generation = 0;
+
+static struct sigaction previous_crash_actions[CRASH_SIGNAL_COUNT];
+
+static struct zms_trace_ring *
+zms_trace_get_thread_ring(void)
+{
+  struct zms_trace_ring *ring;
+  uint32_t generation = __atomic_load_n(&ring_generation, __ATOMIC_ACQUIRE);
+
+  if (thread_ring && thread_ring_generation == generation) return thread_ring;
+
+  ring = zalloc(sizeof *ring);
+  if (ring == NULL) return NULL;
+
+  ring->tid = syscall(SYS_gettid);
+
+  // lock free, since the list is also read by a crash handler
+  ring->next = __atomic_load_n(&ring_list, __ATOMIC_RELAXED);
+  while (!__atomic_compare_exchange_n(&ring_list, &ring->next, ring, false,
+      __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+    ;
+
+  thread_ring = ring;
+  thread_ring_generation = generation;
+
+  return ring;
+}
+
+ZMS_EXPORT void
+zms_trace_record(
+    enum zms_trace_event_type type, const char *name, int64_t value)
+{
+  struct zms_trace_ring *ring = zms_trace_get_thread_ring();
+  struct zms_trace_event *event;
+  struct timespec now;
+
+  if (ring == NULL) return;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  event = &ring->events[ring->count % ZMS_TRACE_RING_SIZE];
+  event->nsec = (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+  event->name = name;
+  event->value = value;
+  event->type = type;
+
+  __atomic_store_n(&ring->count, ring->count + 1, __ATOMIC_RELEASE);
+}
+
+static void
+zms_trace_writer_flush(struct zms_trace_writer *writer)
+{
+  size_t offset = 0;
+  ssize_t size;
+
+  while (offset < writer->length && writer->failed == false) {
+    size = write(writer->fd, writer->data + offset, writer->length - offset);
+    if (size < 0)
+      writer->failed = true;
+    else
+      offset += size;
+  }
+
+  writer->length = 0;
+}
+
+static void
+zms_trace_writer_write(struct zms_trace_writer *writer, const char *text)
+{
+  for (; *text; text++) {
+    if (writer->length == sizeof writer->data) zms_trace_writer_flush(writer);
+    writer->data[writer->length++] = *text;
+  }
+}
+
+static void
+zms_trace_writer_write_uint(
+    struct zms_trace_writer *writer, uint64_t value, int min_digits)
+{
+  char text[24];
+  int i = sizeof text - 1;
+
+  text[i] = '\0';
+  do {
+    text[--i] = '0' + value % 10;
+    value /= 10;
+    min_digits--;
+  } while (value > 0 || min_digits > 0);
+
+  zms_trace_writer_write(writer, &text[i]);
+}
+
+static void
+zms_trace_writer_write_int(struct zms_trace_writer *writer, int64_t value)
+{
+  if (value < 0) {
+    zms_trace_writer_write(writer, "-");
+    zms_trace_writer_write_uint(writer, -(uint64_t)value, 1);
+  } else {
+    zms_trace_writer_write_uint(writer, value, 1);
+  }
+}
+
+static void
+zms_trace_write_event(struct zms_trace_writer *writer,
+    struct zms_trace_event *event, pid_t pid, pid_t tid, bool first)
+{
+  static const char *phases[] = {
+      [ZMS_TRACE_EVENT_BEGIN] = "B",
+      [ZMS_TRACE_EVENT_END] = "E",
+      [ZMS_TRACE_EVENT_COUNTER] = "C",
+  };
+
+  zms_trace_writer_write(writer, first ? "\n{\"name\":\"" : ",\n{\"name\":\"");
+  zms_trace_writer_write(writer, event->name);
+  zms_trace_writer_write(writer, "\",\"ph\":\"");
+  zms_trace_writer_write(writer, phases[event->type]);
+  // in microseconds
+  zms_trace_writer_write(writer, "\",\"ts\":");
+  zms_trace_writer_write_uint(writer, event->nsec / 1000, 1);
+  zms_trace_writer_write(writer, ".");
+  zms_trace_writer_write_uint(writer, event->nsec % 1000, 3);
+  zms_trace_writer_write(writer, ",\"pid\":");
+  zms_trace_writer_write_uint(writer, pid, 1);
+  zms_trace_writer_write(writer, ",\"tid\":");
+  zms_trace_writer_write_uint(writer, tid, 1);
+  if (event->type == ZMS_TRACE_EVENT_COUNTER) {
+    zms_trace_writer_write(writer, ",\"args\":{\"value\":");
+    zms_trace_writer_write_int(writer, event->value);
+    zms_trace_writer_write(writer, "}");
+  }
+  zms_trace_writer_write(writer, "}");
+}
+
+/* The oldest events may have been overwritten by the ring; an end whose
+ * begin is gone would close an unrelated slice, so it is skipped. */
+static void
+zms_trace_write_ring(struct zms_trace_writer *writer,
+    struct zms_trace_ring *ring, pid_t pid, bool *first)
+{
+  uint64_t count = __atomic_load_n(&ring->count, __ATOMIC_ACQUIRE);
+  uint64_t start =
+      count > ZMS_TRACE_RING_SIZE ? count - ZMS_TRACE_RING_SIZE : 0;
+  struct zms_trace_event *event;
+  int depth = 0;
+
+  for (uint64_t i = start; i < count; i++) {
+    event = &ring->events[i % ZMS_TRACE_RING_SIZE];
+    if (event->type == ZMS_TRACE_EVENT_BEGIN) {
+      depth++;
+    } else if (event->type == ZMS_TRACE_EVENT_END) {
+      if (depth == 0) continue;
+      depth--;
+    }
+
+    zms_trace_write_event(writer, event, pid, ring->tid, *first);
+    *first = false;
+  }
+}
+
+ZMS_EXPORT bool
+zms_trace_dump(void)
+{
+  struct zms_trace_writer writer;
+  struct zms_trace_ring *ring;
+  pid_t pid = getpid();
+  bool first = true;
+
+  if (trace_path[0] == '\0') return false;
+
+  writer.fd = open(trace_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (writer.fd < 0) return false;
+  writer.length = 0;
+  writer.failed = false;
+
+  zms_trace_writer_write(&writer, "{\"traceEvents\":[");
+
+  for (ring = __atomic_load_n(&ring_list, __ATOMIC_ACQUIRE); ring;
+       ring = ring->next)
+    zms_trace_write_ring(&writer, ring, pid, &first);
+
+  zms_trace_writer_write(&writer, "\n]}\n");
+  zms_trace_writer_flush(&writer);
+
+  close(writer.fd);
+
+  return writer.failed == false;
+}
+
+static void
+zms_trace_handle_crash(int signal_number)
+{
+  // SA_RESETHAND restored the default action, so this ends the process
+  zms_trace_dump();
+  raise(signal_number);
+}
+
+ZMS_EXPORT bool
+zms_trace_start(const char *path)
+{
+  struct sigaction action;
+
+  if (zms_trace_enabled) return false;
+
+  if (strlen(path) >= sizeof trace_path) {
+    zms_log("trace file path too long: %s\n", path);
+    return false;
+  }
+  strcpy(trace_path, path);
+
+  memset(&action, 0, sizeof action);
+  action.sa_handler = zms_trace_handle_crash;
+  action.sa_flags = SA_RESETHAND | SA_NODEFER;
+  sigemptyset(&action.sa_mask);
+
+  for (size_t i = 0; i < CRASH_SIGNAL_COUNT; i++)
+    sigaction(crash_signals[i], &action, &previous_crash_actions[i]);
+
+  zms_trace_enabled = true;
+
+  return true;
+}
+
+ZMS_EXPORT void
+zms_trace_stop(void)
+{
+  struct zms_trace_ring *ring, *next;
+
+  if (zms_trace_enabled == false) return;
+
+  zms_trace_enabled = false;
+
+  if (zms_trace_dump() == false)
+    zms_log("failed to write the trace to %s\n", trace_path);
+
+  for (size_t i = 0; i < CRASH_SIGNAL_COUNT; i++)
+    sigaction(crash_signals[i], &previous_crash_actions[i], NULL);
+
+  trace_path[0] = '\0';
+
+  // the other threads are expected to have stopped recording by now
+  ring = __atomic_exchange_n(&ring_list, NULL, __ATOMIC_ACQ_REL);
+  __atomic_add_fetch(&ring_generation, 1, __ATOMIC_RELEASE);
+  for (; ring; ring = next) {
+    next = ring->next;
+    free(ring);
+  }
+}
@@ -1,6 +1,9 @@
 #include "app.h"
 
+#include <errno.h>
+#include <poll.h>
 #include <signal.h>
+#include <time.h>
 
 #include "monitor.h"
 
@@ -52,15 +55,30 @@ static const struct zms_backend_interface backend_interface = {
     .keyboard_keymap = zms_app_keyboard_keymap,
 };
 
+static uint64_t
+zms_app_get_time(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+static void
+zms_app_terminate(struct zms_app* app)
+{
+  app->running = false;
+  wl_display_terminate(app->compositor->display);
+}
+
 static int
-handle_backend_event(int fd, uint32_t mask, void* data)
+zms_app_dispatch_backend(struct zms_app* app, uint32_t mask)
 {
-  Z_UNUSED(fd);
-  struct zms_app* app = data;
   int count = 0;
 
   if ((mask & WL_EVENT_HANGUP) || (mask & WL_EVENT_ERROR)) {
-    wl_display_terminate(app->compositor->display);
+    zms_app_terminate(app);
     return 0;
   }
 
@@ -72,24 +90,65 @@ handle_backend_event(int fd, uint32_t mask, void* data)
   }
 
   if (count < 0) {
-    wl_display_terminate(app->compositor->display);
+    zms_app_terminate(app);
     return 0;
   }
 
   return count;
 }
 
+static int
+handle_backend_event(int fd, uint32_t mask, void* data)
+{
+  Z_UNUSED(fd);
+  struct zms_app* app = data;
+  uint64_t begin = zms_app_get_time();
+  int count;
+
+  count = zms_app_dispatch_backend(app, mask);
+
+  zms_compositor_record_source_time(app->compositor,
+      ZMS_METRICS_SOURCE_BACKEND, zms_app_get_time() - begin);
+
+  return count;
+}
+
 static int
 on_term_signal(int signal_number, void* data)
 {
   struct zms_app* app = data;
   zms_log("\ncaught signal %d\n", signal_number);
-  wl_display_terminate(app->compositor->display);
+  zms_app_terminate(app);
   return 0;
 }
 
+static int
+on_trace_signal(int signal_number, void* data)
+{
+  Z_UNUSED(signal_number);
+  struct zms_app* app = data;
+  uint64_t begin = zms_app_get_time();
+
+  if (zms_trace_dump() == false) zms_log("failed to write the trace\n");
+
+  zms_compositor_record_source_time(app->compositor,
+      ZMS_METRICS_SOURCE_SIGNALS, zms_app_get_time() - begin);
+
+  return 0;
+}
+
+ZMS_EXPORT void
+zms_app_options_init_default(struct zms_app_options* options)
+{
+  options->render_thread_count = 1;
+  options->shadow_buffers = false;
+  options->zigen_socket = "zigen-0";
+  options->trace_path = NULL;
+  zms_monitor_options_init_default(&options->monitor);
+}
+
 ZMS_EXPORT struct zms_app*
-zms_app_create()
+zms_app_create(struct zms_app_options* options)
 {
   struct zms_app* app;
   struct zms_compositor* compositor;
@@ -99,7 +158,7 @@ zms_app_create()
   struct wl_event_loop* loop;
   int backend_fd;
   struct wl_event_source* backend_event_source;
-  struct wl_event_source* signals[3];
+  struct wl_event_source* signals[4];
 
   app = zalloc(sizeof *app);
   if (app == NULL) {
@@ -107,12 +166,21 @@ zms_app_create()
     goto err;
   }
 
+  if (options->trace_path && zms_trace_start(options->trace_path) == false) {
+    zms_log("failed to start tracing\n");
+    goto err_trace;
+  }
+
   compositor = zms_compositor_create();
   if (compositor == NULL) {
     zms_log("failed to create a zms_compositor\n");
     goto err_compositor;
   }
 
+  zms_compositor_set_render_thread_count(
+      compositor, options->render_thread_count);
+  zms_compositor_set_shadow_buffers(compositor, options->shadow_buffers);
+
   backend = zms_backend_create(app, &backend_interface);
   if (backend == NULL) {
     zms_log("failed to create a zms_backend\n");
@@ -122,12 +190,13 @@ zms_app_create()
   app->compositor = compositor;
   app->backend = backend;
 
-  if (zms_backend_connect(backend, "zigen-0") == false) {
+  if (zms_backend_connect(backend, options->zigen_socket) == false) {
     zms_log("failed to connect zigen server\n");
     goto err_connect;
   }
 
-  primary_monitor = zms_monitor_create(backend, compositor, screen_size);
+  primary_monitor =
+      zms_monitor_create(backend, compositor, screen_size, &options->monitor);
   if (primary_monitor == NULL) {
     zms_log("failed to create a primary monitor\n");
     goto err_monitor;
@@ -148,12 +217,18 @@ zms_app_create()
   signals[0] = wl_event_loop_add_signal(loop, SIGTERM, on_term_signal, app);
   signals[1] = wl_event_loop_add_signal(loop, SIGINT, on_term_signal, app);
   signals[2] = wl_event_loop_add_signal(loop, SIGQUIT, on_term_signal, app);
+  // dumps the trace so far, e.g. right after a stutter
+  signals[3] = wl_event_loop_add_signal(loop, SIGUSR1, on_trace_signal, app);
 
-  if (!signals[0] || !signals[1] || !signals[2]) {
+  if (!signals[0] || !signals[1] || !signals[2] || !signals[3]) {
     zms_log("failed to create singal event sources\n");
     goto err_signal;
   }
 
+  // zmonitors-top still has something to show without it
+  if (zms_compositor_listen_metrics(compositor) == false)
+    zms_log("failed to serve metrics\n");
+
   return app;
 
 err_signal:
@@ -168,6 +243,9 @@ err_backend:
   zms_compositor_destroy(compositor);
 
 err_compositor:
+  zms_trace_stop();
+
+err_trace:
   free(app);
 
 err:
@@ -180,12 +258,39 @@ zms_app_destroy(struct zms_app* app)
   zms_monitor_destroy(app->primary_monitor);
   zms_backend_destroy(app->backend);
   zms_compositor_destroy(app->compositor);
+  zms_trace_stop();
   free(app);
 }
 
+/* Same as wl_display_run, except that the time taken by each dispatch is
+ * measured apart from the wait for events */
 ZMS_EXPORT void
 zms_app_run(struct zms_app* app)
 {
+  struct wl_display* display = app->compositor->display;
+  struct wl_event_loop* loop = wl_display_get_event_loop(display);
+  struct pollfd pfd = {wl_event_loop_get_fd(loop), POLLIN, 0};
+  uint64_t begin, idle_nsec;
+
   zms_backend_flush(app->backend);
-  wl_display_run(app->compositor->display);
+
+  app->running = true;
+  while (app->running) {
+    wl_display_flush_clients(display);
+
+    // wl_event_loop_dispatch does this before waiting
+    begin = zms_app_get_time();
+    wl_event_loop_dispatch_idle(loop);
+    idle_nsec = zms_app_get_time() - begin;
+
+    if (poll(&pfd, 1, -1) < 0 && errno != EINTR) {
+      zms_log("failed to poll the event loop\n");
+      break;
+    }
+
+    begin = zms_app_get_time();
+    wl_event_loop_dispatch(loop, 0);
+    zms_compositor_record_dispatch_time(
+        app->compositor, zms_app_get_time() - begin + idle_nsec);
+  }
 }
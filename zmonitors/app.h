@@ -6,14 +6,25 @@
 
 #include "monitor.h"
 
+struct zms_app_options {
+  int render_thread_count;   // <= 1 renders on the main thread
+  bool shadow_buffers;       // copy client content and release buffers early
+  const char* zigen_socket;  // the zigen compositor to connect to
+  const char* trace_path;    // nullable; see zms_trace_start
+  struct zms_monitor_options monitor;
+};
+
+void zms_app_options_init_default(struct zms_app_options* options);
+
 struct zms_app {
   struct zms_compositor* compositor;
   struct zms_backend* backend;
   struct wl_event_source* backend_event_source;
   struct zms_monitor* primary_monitor;
+  bool running;  // zms_app_run returns when cleared
 };
 
-struct zms_app* zms_app_create();
+struct zms_app* zms_app_create(struct zms_app_options* options);
 
 void zms_app_destroy(struct zms_app* app);
 
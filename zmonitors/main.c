@@ -1,12 +1,140 @@
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
 #include "app.h"
 
+// per dimension; the screen also clamps them to its size in pixels
+#define MAX_SCREEN_TILES 64
+
+static void
+print_usage(const char* program)
+{
+  fprintf(stderr,
+      "usage: %s [options]\n"
+      "\n"
+      "  -j, --render-threads=N  composite outputs on N threads, up to 4 per\n"
+      "                          online CPU\n"
+      "  -s, --shadow-buffers    copy client content, release buffers early\n"
+      "  -t, --screen-tiles=CxR  upload the screen in C columns x R rows,\n"
+      "                          each 1-64\n"
+      "  -b, --screen-buffers=N  render the screen into a ring of N (2-4)\n"
+      "  -g, --gpu-windows       draw each window as its own textured quad\n"
+      "  -z, --zigen-socket=NAME connect to NAME instead of zigen-0\n"
+      "  -T, --trace=FILE        record a trace, written to FILE as Chrome\n"
+      "                          trace JSON on exit, crash and SIGUSR1\n"
+      "  -h, --help              show this help\n",
+      program);
+}
+
+static bool
+parse_screen_tiles(const char* arg, uint32_t* columns, uint32_t* rows)
+{
+  long column_value, row_value;
+  char* end;
+
+  column_value = strtol(arg, &end, 10);
+  if (*end != 'x') return false;
+  row_value = strtol(end + 1, &end, 10);
+  if (*end != '\0') return false;
+
+  if (column_value < 1 || column_value > MAX_SCREEN_TILES || row_value < 1 ||
+      row_value > MAX_SCREEN_TILES)
+    return false;
+
+  *columns = column_value;
+  *rows = row_value;
+  return true;
+}
+
+static bool
+parse_options(int argc, char* argv[], struct zms_app_options* options)
+{
+  static const struct option long_options[] = {
+      {"render-threads", required_argument, NULL, 'j'},
+      {"shadow-buffers", no_argument, NULL, 's'},
+      {"screen-tiles", required_argument, NULL, 't'},
+      {"screen-buffers", required_argument, NULL, 'b'},
+      {"gpu-windows", no_argument, NULL, 'g'},
+      {"zigen-socket", required_argument, NULL, 'z'},
+      {"trace", required_argument, NULL, 'T'},
+      {"help", no_argument, NULL, 'h'},
+      {NULL, 0, NULL, 0},
+  };
+  // more threads than this only add contention
+  long max_render_thread_count = sysconf(_SC_NPROCESSORS_ONLN) * 4;
+  long value;
+  int opt;
+  char* end;
+
+  while ((opt = getopt_long(
+              argc, argv, "j:st:b:gz:T:h", long_options, NULL)) != -1) {
+    switch (opt) {
+      case 'j':
+        value = strtol(optarg, &end, 10);
+        if (*end != '\0' || value < 1 ||
+            value > MAX(max_render_thread_count, 4)) {
+          zms_log("invalid render thread count: %s\n", optarg);
+          return false;
+        }
+        options->render_thread_count = value;
+        break;
+
+      case 's':
+        options->shadow_buffers = true;
+        break;
+
+      case 't':
+        if (parse_screen_tiles(optarg, &options->monitor.screen_tile_columns,
+                &options->monitor.screen_tile_rows) == false) {
+          zms_log("invalid screen tiles: %s\n", optarg);
+          return false;
+        }
+        break;
+
+      case 'b':
+        value = strtol(optarg, &end, 10);
+        if (*end != '\0' || value < 2 || value > 4) {
+          zms_log("invalid screen buffer count: %s\n", optarg);
+          return false;
+        }
+        options->monitor.screen_buffer_count = value;
+        break;
+
+      case 'g':
+        options->monitor.gpu_windows = true;
+        break;
+
+      case 'z':
+        options->zigen_socket = optarg;
+        break;
+
+      case 'T':
+        options->trace_path = optarg;
+        break;
+
+      case 'h':
+      default:
+        print_usage(argv[0]);
+        return false;
+    }
+  }
+
+  return true;
+}
+
 int
-main()
+main(int argc, char* argv[])
 {
   struct zms_app *app;
+  struct zms_app_options options;
   int exit_code = EXIT_FAILURE;
 
-  app = zms_app_create();
+  zms_app_options_init_default(&options);
+  if (parse_options(argc, argv, &options) == false) goto out;
+
+  app = zms_app_create(&options);
   if (app == NULL) goto out;
 
   zms_app_run(app);
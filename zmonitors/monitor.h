@@ -8,8 +8,23 @@
 
 struct zms_monitor;
 
+struct zms_monitor_options {
+  // the screen is uploaded to zigen in this many tiles
+  uint32_t screen_tile_columns;
+  uint32_t screen_tile_rows;
+
+  // the screen is rendered into a ring of this many buffers, 2 to 4
+  int screen_buffer_count;
+
+  // draw each window as its own textured quad instead of into the screen
+  bool gpu_windows;
+};
+
+void zms_monitor_options_init_default(struct zms_monitor_options* options);
+
 struct zms_monitor* zms_monitor_create(struct zms_backend* backend,
-    struct zms_compositor* compositor, struct zms_screen_size size);
+    struct zms_compositor* compositor, struct zms_screen_size size,
+    const struct zms_monitor_options* options);
 
 void zms_monitor_destroy(struct zms_monitor* monitor);
 
@@ -110,7 +110,7 @@ ray_leave(struct zms_ui_base *ui_base, uint32_t serial)
   return true;
 }
 
-static void
+static bool
 ui_setup(struct zms_ui_base *ui_base)
 {
   struct zms_control_bar *control_bar = ui_base->user_data;
@@ -222,6 +222,8 @@ ui_setup(struct zms_ui_base *ui_base)
   control_bar->shader = shader;
   control_bar->vertex_buffer = vertex_buffer;
   control_bar->texture = texture;
+
+  return true;
 }
 
 static void
@@ -0,0 +1,359 @@
+#include "cursor.h"
+
+#include <string.h>
+#include <sys/mman.h>
+#include <zigen-opengl-client-protocol.h>
+#include <zmonitors-util.h>
+
+#include "monitor-internal.h"
+#include "screen-frag.h"
+#include "screen-vert.h"
+
+// how far in front of the screen the cursor is drawn, in meters
+#define CURSOR_Z_OFFSET 0.0005
+
+struct uv {
+  float u, v;
+};
+
+struct vertex {
+  vec3 p;
+  struct uv uv;
+};
+
+struct vertex_buffer {
+  struct vertex vertices[4];
+};
+
+static void
+zms_cursor_texture_clear(struct zms_cursor_texture* entry)
+{
+  if (entry->texture == NULL) return;
+
+  munmap(entry->data, sizeof(struct zms_bgra) * entry->size.width *
+                          entry->size.height);
+  zms_opengl_texture_destroy(entry->texture);
+  entry->texture = NULL;
+  entry->data = NULL;
+}
+
+static struct zms_cursor_texture*
+zms_cursor_find_texture(struct zms_cursor* cursor, struct zms_screen_size size,
+    uint64_t buffer_id)
+{
+  struct zms_cursor_texture* entry;
+
+  if (buffer_id == 0) return NULL;
+
+  for (int i = 0; i < ZMS_CURSOR_TEXTURE_CACHE_SIZE; i++) {
+    entry = &cursor->textures[i];
+    if (entry->texture && entry->buffer_id == buffer_id &&
+        entry->size.width == size.width && entry->size.height == size.height)
+      return entry;
+  }
+
+  return NULL;
+}
+
+/* The client may have redrawn the buffer since it was cached */
+static bool
+zms_cursor_texture_is_current(
+    struct zms_cursor* cursor, struct zms_cursor_texture* entry)
+{
+  struct zms_output* output = cursor->monitor->screen->output;
+  uint32_t stride = sizeof(struct zms_bgra) * entry->size.width;
+  size_t image_size = stride * entry->size.height;
+
+  if (cursor->image_size < image_size) {
+    void* image = realloc(cursor->image, image_size);
+    if (image == NULL) {
+      zms_log("failed to allocate memory\n");
+      return false;
+    }
+    cursor->image = image;
+    cursor->image_size = image_size;
+  }
+
+  if (zms_output_read_cursor_image(output, cursor->image, stride) == false)
+    return false;
+
+  return memcmp(cursor->image, entry->data, image_size) == 0;
+}
+
+static struct zms_cursor_texture*
+zms_cursor_create_texture(struct zms_cursor* cursor,
+    struct zms_screen_size size, uint64_t buffer_id,
+    struct zms_cursor_texture* entry /* nullable; a slot to reuse */)
+{
+  struct zms_output* output = cursor->monitor->screen->output;
+  uint32_t stride = sizeof(struct zms_bgra) * size.width;
+  size_t image_size = stride * size.height;
+
+  // take an unused slot, or the least recently used one
+  for (int i = 0; entry == NULL && i < ZMS_CURSOR_TEXTURE_CACHE_SIZE; i++) {
+    if (cursor->textures[i].texture == NULL) entry = &cursor->textures[i];
+  }
+  for (int i = 0; entry == NULL && i < ZMS_CURSOR_TEXTURE_CACHE_SIZE; i++) {
+    if (i == 0 || cursor->textures[i].last_used < entry->last_used)
+      entry = &cursor->textures[i];
+  }
+
+  zms_cursor_texture_clear(entry);
+
+  entry->texture = zms_opengl_texture_create(cursor->monitor->backend, size);
+  if (entry->texture == NULL) return NULL;
+
+  entry->data = mmap(NULL, image_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+      zms_opengl_texture_get_fd(entry->texture), 0);
+  if (entry->data == MAP_FAILED) {
+    zms_opengl_texture_destroy(entry->texture);
+    entry->texture = NULL;
+    entry->data = NULL;
+    return NULL;
+  }
+
+  entry->size = size;
+  entry->buffer_id = buffer_id;
+
+  // straight into the texture, not attached to the component yet
+  if (zms_output_read_cursor_image(output, entry->data, stride) == false) {
+    zms_cursor_texture_clear(entry);
+    return NULL;
+  }
+
+  return entry;
+}
+
+static struct zms_cursor_texture*
+zms_cursor_get_texture(struct zms_cursor* cursor, struct zms_screen_size size)
+{
+  struct zms_output* output = cursor->monitor->screen->output;
+  uint64_t buffer_id = zms_output_get_cursor_buffer_id(output);
+  struct zms_cursor_texture* entry;
+
+  entry = zms_cursor_find_texture(cursor, size, buffer_id);
+  if (entry && zms_cursor_texture_is_current(cursor, entry)) return entry;
+
+  // the texture shown must not change under zigen; make a new one instead
+  if (entry && entry == cursor->current_texture) {
+    entry->buffer_id = 0;
+    entry = NULL;
+  }
+
+  return zms_cursor_create_texture(cursor, size, buffer_id, entry);
+}
+
+static void
+zms_cursor_update_transform(struct zms_cursor* cursor, int32_t x, int32_t y,
+    uint32_t width, uint32_t height)
+{
+  struct zms_ui_base* screen_base = cursor->monitor->screen->base;
+  struct zms_screen_size screen_size = cursor->monitor->screen_size;
+  float meter_per_pixel_x = screen_base->half_size[0] * 2 / screen_size.width;
+  float meter_per_pixel_y = screen_base->half_size[1] * 2 / screen_size.height;
+  vec3 position, scale;
+  mat4 transform;
+
+  // the top left corner of the cursor image
+  position[0] = screen_base->position[0] - screen_base->half_size[0] +
+                x * meter_per_pixel_x;
+  position[1] = screen_base->position[1] + screen_base->half_size[1] -
+                y * meter_per_pixel_y;
+  position[2] = screen_base->position[2] + CURSOR_Z_OFFSET;
+
+  scale[0] = width * meter_per_pixel_x;
+  scale[1] = height * meter_per_pixel_y;
+  scale[2] = 1;
+
+  glm_quat_mat4(cursor->base->root->cuboid_window->quaternion, transform);
+  glm_translate(transform, position);
+  glm_scale(transform, scale);
+
+  zms_opengl_shader_program_set_uniform_variable_mat4(
+      cursor->shader, "transform", transform);
+  zms_opengl_component_attach_shader_program(
+      cursor->component, cursor->shader);
+}
+
+static bool
+ui_setup(struct zms_ui_base* ui_base)
+{
+  struct zms_cursor* cursor = ui_base->user_data;
+  struct zms_backend* backend = cursor->monitor->backend;
+  struct zms_opengl_component* component;
+  struct zms_opengl_shader_program* shader;
+  struct zms_opengl_vertex_buffer* vertex_buffer;
+
+  component =
+      zms_opengl_component_create(ui_base->root->cuboid_window->virtual_object);
+
+  zms_opengl_component_set_topology(
+      component, ZGN_OPENGL_TOPOLOGY_TRIANGLE_STRIP);
+  zms_opengl_component_set_count(component, 0);  // hidden
+
+  shader = zms_opengl_shader_program_create(backend, screen_vertex_shader,
+      sizeof(screen_vertex_shader), screen_fragment_shader,
+      sizeof(screen_fragment_shader));
+
+  vertex_buffer =
+      zms_opengl_vertex_buffer_create(backend, sizeof(struct vertex_buffer));
+
+  {
+    // unit square hanging from the origin; scaled to the cursor size
+    int fd = zms_opengl_vertex_buffer_get_fd(vertex_buffer);
+    struct vertex_buffer* data =
+        mmap(NULL, sizeof(struct vertex_buffer), PROT_WRITE, MAP_SHARED, fd, 0);
+    for (int i = 0; i < 4; i++) {
+      data->vertices[i].p[0] = (i < 2 ? 0 : 1);
+      data->vertices[i].p[1] = (i % 2 == 1 ? -1 : 0);
+      data->vertices[i].p[2] = 0;
+      data->vertices[i].uv.u = (i < 2 ? 0 : 1);
+      data->vertices[i].uv.v = (i % 2 == 1 ? 1 : 0);
+    }
+    munmap(data, sizeof(struct vertex_buffer));
+  }
+
+  zms_opengl_component_attach_vertex_buffer(component, vertex_buffer);
+  zms_opengl_component_attach_shader_program(component, shader);
+
+  zms_opengl_component_add_vertex_attribute(component, 0, 3,
+      ZGN_OPENGL_VERTEX_ATTRIBUTE_TYPE_FLOAT, false, sizeof(struct vertex), 0);
+  zms_opengl_component_add_vertex_attribute(component, 1, 2,
+      ZGN_OPENGL_VERTEX_ATTRIBUTE_TYPE_FLOAT, false, sizeof(struct vertex),
+      offsetof(struct vertex, uv));
+
+  cursor->component = component;
+  cursor->shader = shader;
+  cursor->vertex_buffer = vertex_buffer;
+  cursor->visible = false;
+  cursor->current_texture = NULL;
+
+  // reflect what happened before the setup
+  cursor->needs_update = true;
+  cursor->image_changed = true;
+
+  return true;
+}
+
+static void
+ui_teardown(struct zms_ui_base* ui_base)
+{
+  struct zms_cursor* cursor = ui_base->user_data;
+
+  for (int i = 0; i < ZMS_CURSOR_TEXTURE_CACHE_SIZE; i++)
+    zms_cursor_texture_clear(&cursor->textures[i]);
+  cursor->current_texture = NULL;
+
+  zms_opengl_vertex_buffer_destroy(cursor->vertex_buffer);
+  zms_opengl_shader_program_destroy(cursor->shader);
+  zms_opengl_component_destroy(cursor->component);
+}
+
+static void
+ui_reconfigure(struct zms_ui_base* ui_base)
+{
+  struct zms_cursor* cursor = ui_base->user_data;
+
+  cursor->needs_update = true;
+  zms_ui_base_schedule_repaint(ui_base);
+}
+
+static void
+ui_repaint(struct zms_ui_base* ui_base)
+{
+  struct zms_cursor* cursor = ui_base->user_data;
+  struct zms_cursor_texture* texture = cursor->current_texture;
+  struct zms_screen_size size;
+  int32_t x, y;
+  uint32_t width, height;
+  bool visible;
+
+  if (ui_base->setup == false || cursor->needs_update == false) return;
+
+  visible = zms_output_get_cursor(
+      cursor->monitor->screen->output, &x, &y, &width, &height);
+  visible = visible && width > 0 && height > 0;
+
+  if (visible && (cursor->image_changed || texture == NULL)) {
+    size.width = width;
+    size.height = height;
+    texture = zms_cursor_get_texture(cursor, size);
+  }
+
+  cursor->needs_update = false;
+  cursor->image_changed = false;
+
+  if (visible == false || texture == NULL) {
+    if (cursor->visible) zms_opengl_component_set_count(cursor->component, 0);
+    cursor->visible = false;
+    return;
+  }
+
+  texture->last_used = ++cursor->use_count;
+
+  if (texture != cursor->current_texture) {
+    zms_opengl_component_attach_texture(cursor->component, texture->texture);
+    cursor->current_texture = texture;
+  }
+
+  zms_cursor_update_transform(cursor, x, y, width, height);
+
+  if (cursor->visible == false)
+    zms_opengl_component_set_count(cursor->component, 4);
+  cursor->visible = true;
+}
+
+static const struct zms_ui_base_interface ui_base_interface = {
+    .setup = ui_setup,
+    .teardown = ui_teardown,
+    .reconfigure = ui_reconfigure,
+    .repaint = ui_repaint,
+};
+
+ZMS_EXPORT struct zms_cursor*
+zms_cursor_create(struct zms_monitor* monitor)
+{
+  struct zms_cursor* cursor;
+  struct zms_ui_base* base;
+  struct zms_ui_base* parent = monitor->ui_root->base;
+
+  cursor = zalloc(sizeof *cursor);
+  if (cursor == NULL) goto err;
+
+  base = zms_ui_base_create(cursor, &ui_base_interface, parent);
+  if (base == NULL) goto err_base;
+
+  cursor->base = base;
+  cursor->monitor = monitor;
+  cursor->current_texture = NULL;
+  cursor->use_count = 0;
+  cursor->visible = false;
+  cursor->needs_update = false;
+  cursor->image_changed = false;
+  cursor->image = NULL;
+  cursor->image_size = 0;
+
+  return cursor;
+
+err_base:
+  free(cursor);
+
+err:
+  return NULL;
+}
+
+ZMS_EXPORT void
+zms_cursor_destroy(struct zms_cursor* cursor)
+{
+  zms_ui_base_destroy(cursor->base);
+  free(cursor->image);
+  free(cursor);
+}
+
+ZMS_EXPORT void
+zms_cursor_update(struct zms_cursor* cursor, bool image_changed)
+{
+  cursor->needs_update = true;
+  cursor->image_changed |= image_changed;
+  zms_ui_base_schedule_repaint(cursor->base);
+}
@@ -0,0 +1,47 @@
+#ifndef ZMONITORS_MONITOR_CURSOR_H
+#define ZMONITORS_MONITOR_CURSOR_H
+
+#include "monitor.h"
+#include "ui.h"
+
+#define ZMS_CURSOR_TEXTURE_CACHE_SIZE 8
+
+struct zms_cursor_texture {
+  struct zms_opengl_texture *texture; /* nullable; null for an unused slot */
+  void *data;                         // the texture memory, kept mapped
+  struct zms_screen_size size;
+  uint64_t buffer_id;  // see zms_output_get_cursor_buffer_id; 0 if unknown
+  uint32_t last_used;
+};
+
+/* The pointer cursor of the screen, drawn as its own textured quad in front
+ * of the screen so that moving it does not touch the screen texture. */
+struct zms_cursor {
+  struct zms_ui_base *base;
+  struct zms_monitor *monitor;
+
+  struct zms_opengl_component *component;
+  struct zms_opengl_shader_program *shader;
+  struct zms_opengl_vertex_buffer *vertex_buffer;
+
+  // textures are cached by the buffer shown, checked against its content
+  struct zms_cursor_texture textures[ZMS_CURSOR_TEXTURE_CACHE_SIZE];
+  struct zms_cursor_texture *current_texture; /* nullable */
+  uint32_t use_count;
+
+  // the image read to check a cached texture; reused across updates
+  void *image;
+  size_t image_size;
+
+  bool visible;
+  bool needs_update;
+  bool image_changed;
+};
+
+struct zms_cursor *zms_cursor_create(struct zms_monitor *monitor);
+
+void zms_cursor_destroy(struct zms_cursor *cursor);
+
+void zms_cursor_update(struct zms_cursor *cursor, bool image_changed);
+
+#endif  //  ZMONITORS_MONITOR_CURSOR_H
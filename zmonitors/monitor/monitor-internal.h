@@ -5,8 +5,10 @@
 #include <zmonitors-server.h>
 
 #include "control-bar.h"
+#include "cursor.h"
 #include "screen.h"
 #include "ui.h"
+#include "window-layer.h"
 
 struct zms_monitor {
   struct zms_backend* backend;
@@ -14,10 +16,13 @@ struct zms_monitor {
 
   struct zms_screen_size screen_size;
   float ppm;  // pixels per meter
+  struct zms_monitor_options options;
 
   struct zms_ui_root* ui_root;
   struct zms_screen* screen;
   struct zms_control_bar* control_bar;
+  struct zms_cursor* cursor;
+  struct zms_window_layer* window_layer; /* nullable */
 };
 
 #endif  //  ZMONITORS_MONITOR_MONITOR_INTERNAL_H
@@ -15,6 +15,9 @@
 #define CONTROL_BAR_PADDING 0.02
 #define CONTROL_BAR_HEIGHT 0.02
 #define CONTROL_BAR_WIDTH 0.4
+#define DEFAULT_SCREEN_TILE_COLUMNS 4
+#define DEFAULT_SCREEN_TILE_ROWS 4
+#define DEFAULT_SCREEN_BUFFER_COUNT 3
 
 static void
 ui_setup_geometry(struct zms_ui_base* ui_base)
@@ -34,10 +37,12 @@ ui_setup_geometry(struct zms_ui_base* ui_base)
       -ui_base->half_size[1] + CUBOID_PADDING + CONTROL_BAR_HEIGHT / 2;
 }
 
-static void
+static bool
 ui_setup(struct zms_ui_base* ui_base)
 {
   ui_setup_geometry(ui_base);
+
+  return true;
 }
 
 static void
@@ -73,14 +78,26 @@ static const struct zms_ui_base_interface ui_base_interface = {
     .cuboid_window_moved = cuboid_window_moved,
 };
 
+ZMS_EXPORT void
+zms_monitor_options_init_default(struct zms_monitor_options* options)
+{
+  options->screen_tile_columns = DEFAULT_SCREEN_TILE_COLUMNS;
+  options->screen_tile_rows = DEFAULT_SCREEN_TILE_ROWS;
+  options->screen_buffer_count = DEFAULT_SCREEN_BUFFER_COUNT;
+  options->gpu_windows = false;
+}
+
 ZMS_EXPORT struct zms_monitor*
 zms_monitor_create(struct zms_backend* backend,
-    struct zms_compositor* compositor, struct zms_screen_size size)
+    struct zms_compositor* compositor, struct zms_screen_size size,
+    const struct zms_monitor_options* options)
 {
   struct zms_monitor* monitor;
   struct zms_ui_root* ui_root;
   struct zms_screen* screen;
   struct zms_control_bar* control_bar;
+  struct zms_cursor* cursor;
+  struct zms_window_layer* window_layer = NULL;
   float ppm = DEFAULT_PPM;
   vec3 half_size;
   versor quaternion = GLM_QUAT_IDENTITY_INIT;
@@ -104,7 +121,9 @@ zms_monitor_create(struct zms_backend* backend,
   monitor->compositor = compositor;
   monitor->screen_size = size;
   monitor->ppm = ppm;
+  monitor->options = *options;
   monitor->ui_root = ui_root;
+  monitor->window_layer = NULL;
 
   screen = zms_screen_create(monitor);
   if (screen == NULL) goto err_screen;
@@ -114,8 +133,24 @@ zms_monitor_create(struct zms_backend* backend,
   if (control_bar == NULL) goto err_control_bar;
   monitor->control_bar = control_bar;
 
+  cursor = zms_cursor_create(monitor);
+  if (cursor == NULL) goto err_cursor;
+  monitor->cursor = cursor;
+
+  if (options->gpu_windows) {
+    window_layer = zms_window_layer_create(monitor);
+    if (window_layer == NULL) goto err_window_layer;
+    monitor->window_layer = window_layer;
+  }
+
   return monitor;
 
+err_window_layer:
+  zms_cursor_destroy(cursor);
+
+err_cursor:
+  zms_control_bar_destroy(control_bar);
+
 err_control_bar:
   zms_screen_destroy(screen);
 
@@ -132,6 +167,9 @@ err:
 ZMS_EXPORT void
 zms_monitor_destroy(struct zms_monitor* monitor)
 {
+  if (monitor->window_layer) zms_window_layer_destroy(monitor->window_layer);
+  monitor->window_layer = NULL;
+  zms_cursor_destroy(monitor->cursor);
   zms_control_bar_destroy(monitor->control_bar);
   zms_screen_destroy(monitor->screen);
   zms_ui_root_destroy(monitor->ui_root);
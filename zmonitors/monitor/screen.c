@@ -142,65 +142,63 @@ keyboard_modifiers(struct zms_ui_base* ui_base, uint32_t serial,
   return true;
 }
 
-static void
-ui_setup(struct zms_ui_base* ui_base)
+/* @param pools one per output pixel buffer */
+static bool
+zms_screen_tile_setup(struct zms_screen* screen, struct zms_screen_tile* tile,
+    struct zms_opengl_texture_pool** pools)
 {
-  struct zms_screen* screen = ui_base->user_data;
+  struct zms_ui_base* ui_base = screen->base;
   struct zms_screen_size screen_size = screen->monitor->screen_size;
   struct zms_backend* backend = screen->monitor->backend;
+  struct zms_output* output = screen->output;
   struct zms_opengl_component* component;
-  struct zms_opengl_shader_program* shader;
   struct zms_opengl_vertex_buffer* vertex_buffer;
-  struct zms_pixel_buffer* pixel_buffer;
-  mat4 transform;
-
-  zms_screen_calculate_corner_points(screen);
-
-  glm_quat_mat4(ui_base->root->cuboid_window->quaternion, transform);
-  glm_translate(transform, ui_base->position);
+  float x0, x1, y0, y1;
+  int i;
 
   component =
       zms_opengl_component_create(ui_base->root->cuboid_window->virtual_object);
+  if (component == NULL) goto err;
 
   zms_opengl_component_set_topology(
       component, ZGN_OPENGL_TOPOLOGY_TRIANGLE_STRIP);
   zms_opengl_component_set_count(component, 4);
 
-  shader = zms_opengl_shader_program_create(backend, screen_vertex_shader,
-      sizeof(screen_vertex_shader), screen_fragment_shader,
-      sizeof(screen_fragment_shader));
-
   vertex_buffer =
       zms_opengl_vertex_buffer_create(backend, sizeof(struct vertex_buffer));
-
-  for (int i = 0; i < screen->output->pixel_buffer_count; i++) {
-    struct zms_pixel_buffer* pb = screen->output->pixel_buffers[i];
-    screen->textures[i] =
-        zms_opengl_texture_create_by_fd(backend, pb->fd, screen_size);
-    pb->user_data = screen->textures[i];
+  if (vertex_buffer == NULL) goto err_vertex_buffer;
+
+  for (i = 0; i < output->pixel_buffer_count; i++) {
+    struct zms_pixel_buffer* pb = output->pixel_buffers[i];
+    int32_t offset = pb->stride * tile->y + sizeof(struct zms_bgra) * tile->x;
+    tile->textures[i] = zms_opengl_texture_create_by_pool(
+        pools[i], offset, pb->stride, tile->size);
+    if (tile->textures[i] == NULL) goto err_texture;
   }
 
+  x0 = ui_base->half_size[0] * (2.0f * tile->x / screen_size.width - 1);
+  x1 = ui_base->half_size[0] *
+       (2.0f * (tile->x + tile->size.width) / screen_size.width - 1);
+  y0 = ui_base->half_size[1] * (1 - 2.0f * tile->y / screen_size.height);
+  y1 = ui_base->half_size[1] *
+       (1 - 2.0f * (tile->y + tile->size.height) / screen_size.height);
+
   {
     int fd = zms_opengl_vertex_buffer_get_fd(vertex_buffer);
     struct vertex_buffer* data =
         mmap(NULL, sizeof(struct vertex_buffer), PROT_WRITE, MAP_SHARED, fd, 0);
-    for (int i = 0; i < 4; i++) {
-      glm_vec3_copy(ui_base->half_size, data->vertices[i].p);
-      data->vertices[i].p[0] *= (i < 2 ? -1 : 1);
-      data->vertices[i].p[1] *= (i % 2 == 1 ? 1 : -1);
-      data->vertices[i].uv.u = (i < 2 ? 0 : 1);
-      data->vertices[i].uv.v = (i % 2 == 1 ? 0 : 1);
+    for (int j = 0; j < 4; j++) {
+      data->vertices[j].p[0] = (j < 2 ? x0 : x1);
+      data->vertices[j].p[1] = (j % 2 == 1 ? y0 : y1);
+      data->vertices[j].p[2] = 0;
+      data->vertices[j].uv.u = (j < 2 ? 0 : 1);
+      data->vertices[j].uv.v = (j % 2 == 1 ? 0 : 1);
     }
     munmap(data, sizeof(struct vertex_buffer));
   }
 
-  zms_opengl_shader_program_set_uniform_variable_mat4(
-      shader, "transform", transform);
-
   zms_opengl_component_attach_vertex_buffer(component, vertex_buffer);
-  zms_opengl_component_attach_shader_program(component, shader);
-  pixel_buffer = zms_output_buffer_ring_rotate(screen->output);
-  zms_opengl_component_attach_texture(component, pixel_buffer->user_data);
+  zms_opengl_component_attach_shader_program(component, screen->shader);
 
   zms_opengl_component_add_vertex_attribute(component, 0, 3,
       ZGN_OPENGL_VERTEX_ATTRIBUTE_TYPE_FLOAT, false, sizeof(struct vertex), 0);
@@ -208,9 +206,130 @@ ui_setup(struct zms_ui_base* ui_base)
       ZGN_OPENGL_VERTEX_ATTRIBUTE_TYPE_FLOAT, false, sizeof(struct vertex),
       offsetof(struct vertex, uv));
 
-  screen->component = component;
-  screen->shader = shader;
-  screen->vertex_buffer = vertex_buffer;
+  tile->component = component;
+  tile->vertex_buffer = vertex_buffer;
+
+  return true;
+
+err_texture:
+  while (i-- > 0) zms_opengl_texture_destroy(tile->textures[i]);
+  zms_opengl_vertex_buffer_destroy(vertex_buffer);
+
+err_vertex_buffer:
+  zms_opengl_component_destroy(component);
+
+err:
+  return false;
+}
+
+static void
+zms_screen_tile_teardown(
+    struct zms_screen* screen, struct zms_screen_tile* tile)
+{
+  if (tile->component == NULL) return;
+
+  for (int i = 0; i < screen->output->pixel_buffer_count; i++)
+    zms_opengl_texture_destroy(tile->textures[i]);
+
+  zms_opengl_vertex_buffer_destroy(tile->vertex_buffer);
+  zms_opengl_component_destroy(tile->component);
+  tile->component = NULL;
+}
+
+static int
+zms_screen_get_pixel_buffer_index(
+    struct zms_screen* screen, struct zms_pixel_buffer* pixel_buffer)
+{
+  for (int i = 0; i < screen->output->pixel_buffer_count; i++)
+    if (screen->output->pixel_buffers[i] == pixel_buffer) return i;
+
+  assert(false && "not reached");
+  return 0;
+}
+
+static void
+zms_screen_destroy_texture_pools(
+    struct zms_screen* screen, struct zms_opengl_texture_pool** pools)
+{
+  for (int i = 0; i < screen->output->pixel_buffer_count; i++)
+    if (pools[i]) zms_opengl_texture_pool_destroy(pools[i]);
+  free(pools);
+}
+
+static bool
+ui_setup(struct zms_ui_base* ui_base)
+{
+  struct zms_screen* screen = ui_base->user_data;
+  struct zms_backend* backend = screen->monitor->backend;
+  struct zms_output* output = screen->output;
+  struct zms_opengl_texture_pool** pools;
+  struct zms_pixel_buffer* pixel_buffer;
+  int buffer_index;
+  mat4 transform;
+  uint32_t i;
+
+  zms_screen_calculate_corner_points(screen);
+
+  glm_quat_mat4(ui_base->root->cuboid_window->quaternion, transform);
+  glm_translate(transform, ui_base->position);
+
+  screen->shader = zms_opengl_shader_program_create(backend,
+      screen_vertex_shader, sizeof(screen_vertex_shader),
+      screen_fragment_shader, sizeof(screen_fragment_shader));
+  if (screen->shader == NULL) {
+    zms_log("failed to create a shader program\n");
+    goto err;
+  }
+
+  zms_opengl_shader_program_set_uniform_variable_mat4(
+      screen->shader, "transform", transform);
+
+  // no texture is busy before the tiles are set up
+  zms_output_repaint(output);
+  pixel_buffer = zms_output_get_front_buffer(output);
+  buffer_index = zms_screen_get_pixel_buffer_index(screen, pixel_buffer);
+
+  // zigen maps each pixel buffer once, however many tiles show a part of it
+  pools = zalloc(sizeof(*pools) * output->pixel_buffer_count);
+  if (pools == NULL) {
+    zms_log("failed to allocate memory\n");
+    goto err_pools;
+  }
+  for (int j = 0; j < output->pixel_buffer_count; j++) {
+    pools[j] = zms_opengl_texture_pool_create(backend,
+        output->pixel_buffers[j]->fd, output->pixel_buffers[j]->size);
+    if (pools[j] == NULL) {
+      zms_log("failed to share a pixel buffer\n");
+      goto err_pool;
+    }
+  }
+
+  for (i = 0; i < screen->tile_columns * screen->tile_rows; i++) {
+    struct zms_screen_tile* tile = &screen->tiles[i];
+    if (zms_screen_tile_setup(screen, tile, pools) == false) {
+      zms_log("failed to set up a screen tile\n");
+      goto err_tile;
+    }
+    zms_opengl_component_attach_texture(
+        tile->component, tile->textures[buffer_index]);
+  }
+
+  // the textures keep the memory shared
+  zms_screen_destroy_texture_pools(screen, pools);
+
+  return true;
+
+err_tile:
+  while (i-- > 0) zms_screen_tile_teardown(screen, &screen->tiles[i]);
+
+err_pool:
+  zms_screen_destroy_texture_pools(screen, pools);
+
+err_pools:
+  zms_opengl_shader_program_destroy(screen->shader);
+
+err:
+  return false;
 }
 
 static void
@@ -218,12 +337,10 @@ ui_teardown(struct zms_ui_base* ui_base)
 {
   struct zms_screen* screen = ui_base->user_data;
 
-  for (int i = 0; i < screen->output->pixel_buffer_count; i++)
-    zms_opengl_texture_destroy(screen->textures[i]);
+  for (uint32_t i = 0; i < screen->tile_columns * screen->tile_rows; i++)
+    zms_screen_tile_teardown(screen, &screen->tiles[i]);
 
-  zms_opengl_vertex_buffer_destroy(screen->vertex_buffer);
   zms_opengl_shader_program_destroy(screen->shader);
-  zms_opengl_component_destroy(screen->component);
 }
 
 static void
@@ -239,7 +356,11 @@ ui_reconfigure(struct zms_ui_base* ui_base)
 
   zms_opengl_shader_program_set_uniform_variable_mat4(
       screen->shader, "transform", transform);
-  zms_opengl_component_attach_shader_program(screen->component, screen->shader);
+  for (uint32_t i = 0; i < screen->tile_columns * screen->tile_rows; i++) {
+    struct zms_screen_tile* tile = &screen->tiles[i];
+    if (tile->component == NULL) continue;
+    zms_opengl_component_attach_shader_program(tile->component, screen->shader);
+  }
   zms_ui_base_schedule_repaint(ui_base);
 }
 
@@ -248,14 +369,31 @@ ui_repaint(struct zms_ui_base* ui_base)
 {
   struct zms_screen* screen = ui_base->user_data;
   struct zms_pixel_buffer* pixel_buffer;
-  struct zms_opengl_texture* texture;
+  int buffer_index;
 
   if (screen->texture_changed) {
-    pixel_buffer = zms_output_buffer_ring_rotate(screen->output);
-    texture = pixel_buffer->user_data;
-
-    zms_opengl_component_attach_texture(screen->component, texture);
-    zms_opengl_component_texture_updated(screen->component);
+    // all buffers are still read by zigen; retried on the next frame
+    if (zms_output_repaint(screen->output) == false) return;
+
+    pixel_buffer = zms_output_get_front_buffer(screen->output);
+    buffer_index = zms_screen_get_pixel_buffer_index(screen, pixel_buffer);
+
+    // tiles out of the damage keep showing an older buffer with same pixels
+    for (uint32_t i = 0; i < screen->tile_columns * screen->tile_rows; i++) {
+      struct zms_screen_tile* tile = &screen->tiles[i];
+      if (tile->component == NULL) continue;
+      if (!zms_output_frame_damage_intersects(screen->output, tile->x, tile->y,
+              tile->size.width, tile->size.height))
+        continue;
+
+      zms_opengl_component_attach_texture(
+          tile->component, tile->textures[buffer_index]);
+      zms_opengl_component_texture_updated(tile->component);
+      zms_compositor_record_texture_upload(screen->monitor->compositor,
+          sizeof(struct zms_bgra) *
+              zms_output_get_frame_damage_area(screen->output, tile->x,
+                  tile->y, tile->size.width, tile->size.height));
+    }
     screen->texture_changed = false;
   }
 }
@@ -264,7 +402,15 @@ static void
 ui_frame(struct zms_ui_base* ui_base, uint32_t time)
 {
   struct zms_screen* screen = ui_base->user_data;
-  zms_output_frame(screen->output, time);
+  zms_output_frame(
+      screen->output, time, ui_base->root->frame_consecutive);
+
+  // keep frames coming only until the refresh is known again
+  if (zms_output_needs_frame_timing(screen->output))
+    zms_ui_base_request_idle_frame(ui_base);
+
+  // a repaint deferred by busy buffers; zigen may have released one by now
+  if (screen->texture_changed) zms_ui_base_schedule_repaint(ui_base);
 }
 
 static const struct zms_ui_base_interface ui_base_interface = {
@@ -291,8 +437,80 @@ schedule_output_repainting(void* data, struct zms_output* output)
   zms_ui_base_schedule_repaint(screen->base);
 }
 
+static void
+update_output_cursor(void* data, struct zms_output* output, bool image_changed)
+{
+  Z_UNUSED(output);
+  struct zms_screen* screen = data;
+  if (screen->monitor->cursor)
+    zms_cursor_update(screen->monitor->cursor, image_changed);
+}
+
+static void
+map_output_window(void* data, struct zms_output* output, struct zms_view* view)
+{
+  Z_UNUSED(output);
+  struct zms_screen* screen = data;
+  if (screen->monitor->window_layer)
+    zms_window_layer_map(screen->monitor->window_layer, view);
+}
+
+static void
+update_output_window(void* data, struct zms_output* output,
+    struct zms_view* view, bool content_changed)
+{
+  Z_UNUSED(output);
+  struct zms_screen* screen = data;
+  if (screen->monitor->window_layer) {
+    zms_window_layer_update(
+        screen->monitor->window_layer, view, content_changed);
+  }
+}
+
+static void
+unmap_output_window(
+    void* data, struct zms_output* output, struct zms_view* view)
+{
+  Z_UNUSED(output);
+  struct zms_screen* screen = data;
+  if (screen->monitor->window_layer)
+    zms_window_layer_unmap(screen->monitor->window_layer, view);
+}
+
+static bool
+is_output_pixel_buffer_busy(void* data, struct zms_output* output,
+    struct zms_pixel_buffer* pixel_buffer, int32_t x, int32_t y,
+    uint32_t width, uint32_t height)
+{
+  Z_UNUSED(output);
+  struct zms_screen* screen = data;
+  int buffer_index = zms_screen_get_pixel_buffer_index(screen, pixel_buffer);
+
+  for (uint32_t i = 0; i < screen->tile_columns * screen->tile_rows; i++) {
+    struct zms_screen_tile* tile = &screen->tiles[i];
+    if (tile->component == NULL) continue;
+    if (tile->x >= x + (int32_t)width || x >= tile->x + tile->size.width ||
+        tile->y >= y + (int32_t)height || y >= tile->y + tile->size.height)
+      continue;
+    if (zms_opengl_texture_is_busy(tile->textures[buffer_index])) return true;
+  }
+
+  return false;
+}
+
 static const struct zms_output_interface output_interface = {
     .schedule_repaint = schedule_output_repainting,
+    .update_cursor = update_output_cursor,
+    .is_pixel_buffer_busy = is_output_pixel_buffer_busy,
+};
+
+static const struct zms_output_interface gpu_windows_output_interface = {
+    .schedule_repaint = schedule_output_repainting,
+    .update_cursor = update_output_cursor,
+    .is_pixel_buffer_busy = is_output_pixel_buffer_busy,
+    .map_window = map_output_window,
+    .update_window = update_output_window,
+    .unmap_window = unmap_output_window,
 };
 
 ZMS_EXPORT struct zms_screen*
@@ -302,8 +520,12 @@ zms_screen_create(struct zms_monitor* monitor)
   struct zms_ui_base* base;
   struct zms_output* output;
   struct zms_ui_base* parent = monitor->ui_root->base;
-  struct zms_opengl_texture** textures;
+  struct zms_screen_tile* tiles;
+  uint32_t columns = monitor->options.screen_tile_columns;
+  uint32_t rows = monitor->options.screen_tile_rows;
+  struct zms_screen_size size = monitor->screen_size;
   vec2 physical_size;
+  uint32_t i;
 
   screen = zalloc(sizeof *screen);
   if (screen == NULL) goto err;
@@ -314,24 +536,54 @@ zms_screen_create(struct zms_monitor* monitor)
   physical_size[0] = (float)monitor->screen_size.width / 2 / monitor->ppm;
   physical_size[1] = (float)monitor->screen_size.height / 2 / monitor->ppm;
   output = zms_output_create(monitor->compositor, monitor->screen_size,
-      physical_size, "zmonitors", "virtual monitor");
+      physical_size, "zmonitors", "virtual monitor",
+      monitor->options.screen_buffer_count);
   if (output == NULL) goto err_output;
-  zms_output_set_implementation(output, screen, &output_interface);
 
-  textures = zalloc(sizeof(*textures) * output->pixel_buffer_count);
-  if (textures == NULL) goto err_textures;
+  columns = MIN(MAX(columns, 1), (uint32_t)size.width);
+  rows = MIN(MAX(rows, 1), (uint32_t)size.height);
+
+  tiles = zalloc(sizeof(*tiles) * columns * rows);
+  if (tiles == NULL) goto err_tiles;
+
+  for (i = 0; i < columns * rows; i++) {
+    struct zms_screen_tile* tile = &tiles[i];
+    uint32_t column = i % columns;
+    uint32_t row = i / columns;
+
+    tile->x = size.width * column / columns;
+    tile->y = size.height * row / rows;
+    tile->size.width = size.width * (column + 1) / columns - tile->x;
+    tile->size.height = size.height * (row + 1) / rows - tile->y;
+    tile->component = NULL;
+
+    tile->textures =
+        zalloc(sizeof(*tile->textures) * output->pixel_buffer_count);
+    if (tile->textures == NULL) goto err_textures;
+  }
 
   screen->base = base;
   screen->monitor = monitor;
   screen->output = output;
-  screen->textures = textures;
+  screen->tile_columns = columns;
+  screen->tile_rows = rows;
+  screen->tiles = tiles;
 
   screen->texture_changed = false;
   screen->ray_focus = false;
 
+  // the output calls back into the screen from here on
+  zms_output_set_implementation(output, screen,
+      monitor->options.gpu_windows ? &gpu_windows_output_interface
+                                   : &output_interface);
+
   return screen;
 
 err_textures:
+  while (i-- > 0) free(tiles[i].textures);
+  free(tiles);
+
+err_tiles:
   zms_output_destroy(output);
 
 err_output:
@@ -347,8 +599,10 @@ err:
 ZMS_EXPORT void
 zms_screen_destroy(struct zms_screen* screen)
 {
-  zms_output_destroy(screen->output);
   zms_ui_base_destroy(screen->base);
-  free(screen->textures);
+  zms_output_destroy(screen->output);
+  for (uint32_t i = 0; i < screen->tile_columns * screen->tile_rows; i++)
+    free(screen->tiles[i].textures);
+  free(screen->tiles);
   free(screen);
 }
@@ -4,15 +4,27 @@
 #include "monitor.h"
 #include "ui.h"
 
+/* A rectangle of the screen drawn by its own component, so that only the
+ * tiles overlapping the damage are uploaded again. */
+struct zms_screen_tile {
+  int32_t x, y;  // in pixels
+  struct zms_screen_size size;
+
+  struct zms_opengl_component *component;
+  struct zms_opengl_vertex_buffer *vertex_buffer;
+  // one for each pixel buffer of the output, sharing its memory
+  struct zms_opengl_texture **textures;
+};
+
 struct zms_screen {
   struct zms_ui_base *base;
   struct zms_monitor *monitor;
   struct zms_output *output;
 
-  struct zms_opengl_component *component;
   struct zms_opengl_shader_program *shader;
-  struct zms_opengl_vertex_buffer *vertex_buffer;
-  struct zms_opengl_texture **textures;
+
+  uint32_t tile_columns, tile_rows;
+  struct zms_screen_tile *tiles;  // tile_columns * tile_rows
 
   bool texture_changed;
   bool ray_focus;
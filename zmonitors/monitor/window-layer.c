@@ -0,0 +1,410 @@
+#include "window-layer.h"
+
+#include <string.h>
+#include <sys/mman.h>
+#include <zigen-opengl-client-protocol.h>
+#include <zmonitors-util.h>
+
+#include "monitor-internal.h"
+#include "screen-frag.h"
+#include "screen-vert.h"
+
+/* How far in front of the screen the topmost window is drawn, in meters.
+ * Windows below it are spread evenly toward the screen, and the cursor is
+ * drawn in front of all of them. */
+#define WINDOW_Z_OFFSET_MAX 0.0004
+
+struct uv {
+  float u, v;
+};
+
+struct vertex {
+  vec3 p;
+  struct uv uv;
+};
+
+struct vertex_buffer {
+  struct vertex vertices[4];
+};
+
+static bool
+zms_window_quad_setup(struct zms_window_quad* quad)
+{
+  struct zms_ui_base* ui_base = quad->layer->base;
+  struct zms_backend* backend = quad->layer->monitor->backend;
+  struct zms_opengl_component* component;
+  struct zms_opengl_shader_program* shader;
+  struct zms_opengl_vertex_buffer* vertex_buffer;
+
+  component =
+      zms_opengl_component_create(ui_base->root->cuboid_window->virtual_object);
+  if (component == NULL) goto err;
+
+  zms_opengl_component_set_topology(
+      component, ZGN_OPENGL_TOPOLOGY_TRIANGLE_STRIP);
+  zms_opengl_component_set_count(component, 0);  // hidden
+
+  // each window has its own transform uniform
+  shader = zms_opengl_shader_program_create(backend, screen_vertex_shader,
+      sizeof(screen_vertex_shader), screen_fragment_shader,
+      sizeof(screen_fragment_shader));
+  if (shader == NULL) goto err_shader;
+
+  vertex_buffer =
+      zms_opengl_vertex_buffer_create(backend, sizeof(struct vertex_buffer));
+  if (vertex_buffer == NULL) goto err_vertex_buffer;
+
+  {
+    // unit square hanging from the origin; scaled to the window size
+    int fd = zms_opengl_vertex_buffer_get_fd(vertex_buffer);
+    struct vertex_buffer* data =
+        mmap(NULL, sizeof(struct vertex_buffer), PROT_WRITE, MAP_SHARED, fd, 0);
+    for (int i = 0; i < 4; i++) {
+      data->vertices[i].p[0] = (i < 2 ? 0 : 1);
+      data->vertices[i].p[1] = (i % 2 == 1 ? -1 : 0);
+      data->vertices[i].p[2] = 0;
+      data->vertices[i].uv.u = (i < 2 ? 0 : 1);
+      data->vertices[i].uv.v = (i % 2 == 1 ? 1 : 0);
+    }
+    munmap(data, sizeof(struct vertex_buffer));
+  }
+
+  zms_opengl_component_attach_vertex_buffer(component, vertex_buffer);
+  zms_opengl_component_attach_shader_program(component, shader);
+
+  zms_opengl_component_add_vertex_attribute(component, 0, 3,
+      ZGN_OPENGL_VERTEX_ATTRIBUTE_TYPE_FLOAT, false, sizeof(struct vertex), 0);
+  zms_opengl_component_add_vertex_attribute(component, 1, 2,
+      ZGN_OPENGL_VERTEX_ATTRIBUTE_TYPE_FLOAT, false, sizeof(struct vertex),
+      offsetof(struct vertex, uv));
+
+  quad->component = component;
+  quad->shader = shader;
+  quad->vertex_buffer = vertex_buffer;
+  quad->texture = NULL;
+  quad->visible = false;
+
+  return true;
+
+err_vertex_buffer:
+  zms_opengl_shader_program_destroy(shader);
+
+err_shader:
+  zms_opengl_component_destroy(component);
+
+err:
+  return false;
+}
+
+static void
+zms_window_quad_destroy_texture(struct zms_window_quad* quad)
+{
+  struct zms_screen_size size = quad->texture_size;
+
+  if (quad->texture == NULL) return;
+
+  munmap(quad->texture_data,
+      sizeof(struct zms_bgra) * size.width * size.height);
+  zms_opengl_texture_destroy(quad->texture);
+  quad->texture = NULL;
+}
+
+static void
+zms_window_quad_teardown(struct zms_window_quad* quad)
+{
+  if (quad->component == NULL) return;
+
+  zms_window_quad_destroy_texture(quad);
+  zms_opengl_vertex_buffer_destroy(quad->vertex_buffer);
+  zms_opengl_shader_program_destroy(quad->shader);
+  zms_opengl_component_destroy(quad->component);
+  quad->component = NULL;
+}
+
+static bool
+zms_window_quad_create_texture(
+    struct zms_window_quad* quad, struct zms_screen_size size)
+{
+  struct zms_backend* backend = quad->layer->monitor->backend;
+  size_t image_size = sizeof(struct zms_bgra) * size.width * size.height;
+  void* data;
+
+  zms_window_quad_destroy_texture(quad);
+
+  quad->texture = zms_opengl_texture_create(backend, size);
+  if (quad->texture == NULL) return false;
+
+  data = mmap(NULL, image_size, PROT_WRITE, MAP_SHARED,
+      zms_opengl_texture_get_fd(quad->texture), 0);
+  if (data == MAP_FAILED) {
+    zms_opengl_texture_destroy(quad->texture);
+    quad->texture = NULL;
+    return false;
+  }
+
+  quad->texture_size = size;
+  quad->texture_data = data;
+
+  return true;
+}
+
+static void
+zms_window_quad_update_transform(struct zms_window_quad* quad, int32_t x,
+    int32_t y, uint32_t width, uint32_t height, float z)
+{
+  struct zms_ui_base* screen_base = quad->layer->monitor->screen->base;
+  struct zms_screen_size screen_size = quad->layer->monitor->screen_size;
+  float meter_per_pixel_x = screen_base->half_size[0] * 2 / screen_size.width;
+  float meter_per_pixel_y = screen_base->half_size[1] * 2 / screen_size.height;
+  vec3 position, scale;
+  mat4 transform;
+
+  // the top left corner of the window
+  position[0] = screen_base->position[0] - screen_base->half_size[0] +
+                x * meter_per_pixel_x;
+  position[1] = screen_base->position[1] + screen_base->half_size[1] -
+                y * meter_per_pixel_y;
+  position[2] = screen_base->position[2] + z;
+
+  scale[0] = width * meter_per_pixel_x;
+  scale[1] = height * meter_per_pixel_y;
+  scale[2] = 1;
+
+  glm_quat_mat4(quad->layer->base->root->cuboid_window->quaternion, transform);
+  glm_translate(transform, position);
+  glm_scale(transform, scale);
+
+  zms_opengl_shader_program_set_uniform_variable_mat4(
+      quad->shader, "transform", transform);
+  zms_opengl_component_attach_shader_program(quad->component, quad->shader);
+}
+
+static void
+zms_window_quad_repaint(struct zms_window_quad* quad, float z)
+{
+  struct zms_screen_size size;
+  int32_t x, y;
+  uint32_t width, height;
+  uint64_t copied_pixels;
+
+  if (quad->needs_update == false) return;
+  if (quad->component == NULL && zms_window_quad_setup(quad) == false) return;
+
+  quad->needs_update = false;
+
+  zms_view_get_geometry(quad->view, &x, &y, &width, &height);
+
+  if (width == 0 || height == 0) {
+    if (quad->visible) zms_opengl_component_set_count(quad->component, 0);
+    quad->visible = false;
+    return;
+  }
+
+  if (quad->texture == NULL || (uint32_t)quad->texture_size.width != width ||
+      (uint32_t)quad->texture_size.height != height) {
+    size.width = width;
+    size.height = height;
+    if (zms_window_quad_create_texture(quad, size) == false) {
+      zms_log("failed to create a window texture\n");
+      return;
+    }
+    // a new texture starts zero filled; earlier damage was already read
+    zms_view_damage_whole_image(quad->view);
+    quad->content_changed = true;
+  }
+
+  if (quad->content_changed && zms_opengl_texture_is_busy(quad->texture)) {
+    // zigen still reads the texture; the damage is kept for the next frame
+    quad->needs_update = true;
+    quad->layer->update_deferred = true;
+  } else if (quad->content_changed) {
+    // only the damaged part of the window is copied
+    zms_view_read_damaged_image(quad->view, quad->texture_data,
+        sizeof(struct zms_bgra) * width, &copied_pixels);
+    zms_opengl_component_attach_texture(quad->component, quad->texture);
+    zms_opengl_component_texture_updated(quad->component);
+    zms_compositor_record_texture_upload(quad->layer->monitor->compositor,
+        sizeof(struct zms_bgra) * copied_pixels);
+    quad->content_changed = false;
+  }
+
+  zms_window_quad_update_transform(quad, x, y, width, height, z);
+
+  if (quad->visible == false)
+    zms_opengl_component_set_count(quad->component, 4);
+  quad->visible = true;
+}
+
+static void
+zms_window_layer_update_all(struct zms_window_layer* layer)
+{
+  struct zms_window_quad* quad;
+
+  wl_list_for_each(quad, &layer->quad_list, link) quad->needs_update = true;
+
+  zms_ui_base_schedule_repaint(layer->base);
+}
+
+static bool
+ui_setup(struct zms_ui_base* ui_base)
+{
+  struct zms_window_layer* layer = ui_base->user_data;
+
+  // reflect what happened before the setup
+  zms_window_layer_update_all(layer);
+
+  return true;
+}
+
+static void
+ui_teardown(struct zms_ui_base* ui_base)
+{
+  struct zms_window_layer* layer = ui_base->user_data;
+  struct zms_window_quad* quad;
+
+  wl_list_for_each(quad, &layer->quad_list, link)
+      zms_window_quad_teardown(quad);
+}
+
+static void
+ui_reconfigure(struct zms_ui_base* ui_base)
+{
+  struct zms_window_layer* layer = ui_base->user_data;
+
+  zms_window_layer_update_all(layer);
+}
+
+static void
+ui_repaint(struct zms_ui_base* ui_base)
+{
+  struct zms_window_layer* layer = ui_base->user_data;
+  struct zms_window_quad* quad;
+  int count = wl_list_length(&layer->quad_list);
+  int index = 0;
+
+  if (ui_base->setup == false) return;
+
+  layer->update_deferred = false;
+
+  // a moved or restacked window only gets a new transform
+  wl_list_for_each(quad, &layer->quad_list, link)
+  {
+    index++;
+    zms_window_quad_repaint(quad, WINDOW_Z_OFFSET_MAX * index / count);
+  }
+}
+
+static void
+ui_frame(struct zms_ui_base* ui_base, uint32_t time)
+{
+  Z_UNUSED(time);
+  struct zms_window_layer* layer = ui_base->user_data;
+
+  // zigen may have released the busy textures by now
+  if (layer->update_deferred) zms_ui_base_schedule_repaint(ui_base);
+}
+
+static const struct zms_ui_base_interface ui_base_interface = {
+    .setup = ui_setup,
+    .teardown = ui_teardown,
+    .reconfigure = ui_reconfigure,
+    .repaint = ui_repaint,
+    .frame = ui_frame,
+};
+
+ZMS_EXPORT struct zms_window_layer*
+zms_window_layer_create(struct zms_monitor* monitor)
+{
+  struct zms_window_layer* layer;
+  struct zms_ui_base* base;
+  struct zms_ui_base* parent = monitor->ui_root->base;
+
+  layer = zalloc(sizeof *layer);
+  if (layer == NULL) goto err;
+
+  base = zms_ui_base_create(layer, &ui_base_interface, parent);
+  if (base == NULL) goto err_base;
+
+  layer->base = base;
+  layer->monitor = monitor;
+  wl_list_init(&layer->quad_list);
+  layer->update_deferred = false;
+
+  return layer;
+
+err_base:
+  free(layer);
+
+err:
+  return NULL;
+}
+
+ZMS_EXPORT void
+zms_window_layer_destroy(struct zms_window_layer* layer)
+{
+  struct zms_window_quad *quad, *tmp;
+
+  zms_ui_base_destroy(layer->base);
+
+  wl_list_for_each_safe(quad, tmp, &layer->quad_list, link)
+  {
+    quad->view->window_data = NULL;
+    wl_list_remove(&quad->link);
+    free(quad);
+  }
+
+  free(layer);
+}
+
+ZMS_EXPORT void
+zms_window_layer_map(struct zms_window_layer* layer, struct zms_view* view)
+{
+  struct zms_window_quad* quad;
+
+  quad = zalloc(sizeof *quad);
+  if (quad == NULL) {
+    zms_log("failed to allocate memory\n");
+    return;
+  }
+
+  quad->layer = layer;
+  quad->view = view;
+  quad->component = NULL;
+  quad->texture = NULL;
+  quad->visible = false;
+  quad->content_changed = true;
+  view->window_data = quad;
+
+  // newly mapped windows are put on top
+  wl_list_insert(layer->quad_list.prev, &quad->link);
+
+  zms_window_layer_update_all(layer);
+}
+
+ZMS_EXPORT void
+zms_window_layer_update(struct zms_window_layer* layer, struct zms_view* view,
+    bool content_changed)
+{
+  struct zms_window_quad* quad = view->window_data;
+
+  if (quad == NULL) return;
+
+  quad->needs_update = true;
+  quad->content_changed |= content_changed;
+  zms_ui_base_schedule_repaint(layer->base);
+}
+
+ZMS_EXPORT void
+zms_window_layer_unmap(struct zms_window_layer* layer, struct zms_view* view)
+{
+  struct zms_window_quad* quad = view->window_data;
+
+  if (quad == NULL) return;
+
+  view->window_data = NULL;
+  zms_window_quad_teardown(quad);
+  wl_list_remove(&quad->link);
+  free(quad);
+
+  zms_window_layer_update_all(layer);
+}
@@ -0,0 +1,52 @@
+#ifndef ZMONITORS_MONITOR_WINDOW_LAYER_H
+#define ZMONITORS_MONITOR_WINDOW_LAYER_H
+
+#include "monitor.h"
+#include "ui.h"
+
+/* A toplevel window drawn as its own textured quad slightly in front of the
+ * screen, so that moving it only updates its transform. */
+struct zms_window_quad {
+  struct zms_window_layer *layer;
+  struct zms_view *view;
+  struct wl_list link;  // -> zms_window_layer.quad_list, from bottom to top
+
+  struct zms_opengl_component *component; /* nullable; null until set up */
+  struct zms_opengl_shader_program *shader;
+  struct zms_opengl_vertex_buffer *vertex_buffer;
+
+  struct zms_opengl_texture *texture; /* nullable */
+  struct zms_screen_size texture_size;
+  void *texture_data;  // mapped memory of the texture
+
+  bool visible;
+  bool needs_update;
+  bool content_changed;
+};
+
+/* Draws the windows of the screen output on the GPU instead of compositing
+ * them into the screen pixel buffers. */
+struct zms_window_layer {
+  struct zms_ui_base *base;
+  struct zms_monitor *monitor;
+
+  struct wl_list quad_list;  // zms_window_quad.link
+
+  // a quad waits for zigen to release its texture
+  bool update_deferred;
+};
+
+struct zms_window_layer *zms_window_layer_create(struct zms_monitor *monitor);
+
+void zms_window_layer_destroy(struct zms_window_layer *layer);
+
+void zms_window_layer_map(
+    struct zms_window_layer *layer, struct zms_view *view);
+
+void zms_window_layer_update(struct zms_window_layer *layer,
+    struct zms_view *view, bool content_changed);
+
+void zms_window_layer_unmap(
+    struct zms_window_layer *layer, struct zms_view *view);
+
+#endif  //  ZMONITORS_MONITOR_WINDOW_LAYER_H
@@ -8,7 +8,8 @@
 struct zms_ui_base;
 
 struct zms_ui_base_interface {
-  void (*setup)(struct zms_ui_base* ui_base);                /* nonnull */
+  /* nonnull; false if failed, then retried at the next configure */
+  bool (*setup)(struct zms_ui_base* ui_base);
   void (*teardown)(struct zms_ui_base* ui_base);             /* nonnull */
   void (*reconfigure)(struct zms_ui_base* ui_base);          /* nonnull */
   void (*repaint)(struct zms_ui_base* ui_base);              /* nullable */
@@ -56,6 +57,10 @@ void zms_ui_base_destroy(struct zms_ui_base* ui_base);
 
 void zms_ui_base_schedule_repaint(struct zms_ui_base* ui_base);
 
+/* Call in the frame phase to have the next frame come even if nothing is
+ * repainted, for a few frames after the last repaint at most */
+void zms_ui_base_request_idle_frame(struct zms_ui_base* ui_base);
+
 /* root */
 
 struct zms_ui_root {
@@ -63,6 +68,11 @@ struct zms_ui_root {
   struct zms_cuboid_window* cuboid_window;
   struct wl_list frame_callback_list;
   uint32_t frame_state;  // enum zms_ui_frame_state
+  bool in_frame_phase;
+  // the current frame was requested by a commit in the previous frame
+  bool frame_consecutive;
+  bool idle_frame_requested;
+  uint32_t idle_frame_count;
 };
 
 struct zms_ui_root* zms_ui_root_create(void* user_data,
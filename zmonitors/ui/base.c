@@ -70,14 +70,27 @@ zms_ui_base_schedule_repaint(struct zms_ui_base* ui_base)
 }
 
 ZMS_EXPORT void
+zms_ui_base_request_idle_frame(struct zms_ui_base* ui_base)
+{
+  zms_ui_root_request_idle_frame(ui_base->root);
+}
+
+ZMS_EXPORT bool
 zms_ui_base_run_setup_phase(struct zms_ui_base* ui_base)
 {
-  ui_base->interface->setup(ui_base);
-  ui_base->setup = true;
+  // ones set up by an earlier try are kept as they are
+  if (ui_base->setup == false) {
+    if (ui_base->interface->setup(ui_base) == false) return false;
+    ui_base->setup = true;
+  }
 
   struct zms_ui_base* child;
   wl_list_for_each(child, &ui_base->children, link)
-      zms_ui_base_run_setup_phase(child);
+  {
+    if (zms_ui_base_run_setup_phase(child) == false) return false;
+  }
+
+  return true;
 }
 
 ZMS_EXPORT void
@@ -9,7 +9,7 @@
 struct zms_ui_base* zms_ui_base_create_root(struct zms_ui_root* root,
     void* user_data, const struct zms_ui_base_interface* interface);
 
-void zms_ui_base_run_setup_phase(struct zms_ui_base* ui_base);
+bool zms_ui_base_run_setup_phase(struct zms_ui_base* ui_base);
 
 void zms_ui_base_run_repaint_phase(struct zms_ui_base* ui_base);
 
@@ -7,6 +7,10 @@
 #include "monitor.h"
 #include "ui.h"
 
+/* Frames requested without content after the last repaint at most, when
+ * asked for with zms_ui_root_request_idle_frame */
+#define ZMS_UI_ROOT_IDLE_FRAME_COUNT 3
+
 enum zms_ui_frame_state {
   ZMS_UI_FRAME_STATE_REPAINT_SCHEDULED = 0,
   ZMS_UI_FRAME_STATE_WAITING_NEXT_FRAME,
@@ -15,6 +19,8 @@ enum zms_ui_frame_state {
 
 static void zms_ui_root_commit(struct zms_ui_root* root);
 
+static void zms_ui_root_repaint(struct zms_ui_root* root);
+
 static void
 zms_ui_root_ray_enter(void* data, uint32_t serial, vec3 origin, vec3 direction)
 {
@@ -116,7 +122,10 @@ cuboid_window_first_configured_handler(
   struct zms_ui_root* root = data;
 
   glm_vec3_copy(cuboid_window->half_size, root->base->half_size);
-  zms_ui_base_run_setup_phase(root->base);
+  if (zms_ui_base_run_setup_phase(root->base) == false) {
+    zms_log("failed to set up the UI\n");
+    return;
+  }
 
   zms_ui_root_commit(root);
 
@@ -182,32 +191,58 @@ frame_callback_handler(void* data, uint32_t time)
 {
   struct zms_ui_root* root = data;
 
+  zms_trace_begin("ui_frame");
+
+  root->in_frame_phase = true;
+  root->idle_frame_requested = false;
   zms_ui_base_run_frame_phase(root->base, time);
 
   switch (root->frame_state) {
     case ZMS_UI_FRAME_STATE_REPAINT_SCHEDULED:
-      zms_ui_base_run_repaint_phase(root->base);
+      root->idle_frame_count = 0;
+      zms_ui_root_repaint(root);
       root->frame_state = ZMS_UI_FRAME_STATE_WAITING_CONTENT_UPDATE;
       zms_ui_root_commit(root);
       break;
 
     case ZMS_UI_FRAME_STATE_WAITING_NEXT_FRAME:
       root->frame_state = ZMS_UI_FRAME_STATE_WAITING_CONTENT_UPDATE;
+      if (root->idle_frame_requested &&
+          root->idle_frame_count < ZMS_UI_ROOT_IDLE_FRAME_COUNT) {
+        root->idle_frame_count++;
+        zms_ui_root_commit(root);
+      }
       break;
 
     case ZMS_UI_FRAME_STATE_WAITING_CONTENT_UPDATE:
       assert(false && "not reached");
       break;
   }
+  root->in_frame_phase = false;
+
+  zms_trace_end("ui_frame");
+}
+
+static void
+zms_ui_root_repaint(struct zms_ui_root* root)
+{
+  zms_trace_begin("ui_repaint");
+  zms_ui_base_run_repaint_phase(root->base);
+  zms_trace_end("ui_repaint");
 }
 
 static void
 zms_ui_root_commit(struct zms_ui_root* root)
 {
+  zms_trace_begin("ui_root_commit");
+
   if (root->frame_state == ZMS_UI_FRAME_STATE_WAITING_CONTENT_UPDATE) {
     struct zms_frame_callback* frame_callback;
 
     root->frame_state = ZMS_UI_FRAME_STATE_WAITING_NEXT_FRAME;
+    // a commit made outside of a frame may come long after the last frame,
+    // so the interval until the next one is not a refresh interval
+    root->frame_consecutive = root->in_frame_phase;
     frame_callback = zms_frame_callback_create(
         root->cuboid_window->virtual_object, root, frame_callback_handler);
 
@@ -216,6 +251,8 @@ zms_ui_root_commit(struct zms_ui_root* root)
 
   zms_cuboid_window_commit(root->cuboid_window);
   zms_backend_flush(root->cuboid_window->backend);
+
+  zms_trace_end("ui_root_commit");
 }
 
 ZMS_EXPORT void
@@ -229,8 +266,14 @@ zms_ui_root_schedule_repaint(struct zms_ui_root* root)
       break;
 
     case ZMS_UI_FRAME_STATE_WAITING_CONTENT_UPDATE:
-      zms_ui_base_run_repaint_phase(root->base);
+      zms_ui_root_repaint(root);
       zms_ui_root_commit(root);
       break;
   }
 }
+
+ZMS_EXPORT void
+zms_ui_root_request_idle_frame(struct zms_ui_root* root)
+{
+  root->idle_frame_requested = true;
+}
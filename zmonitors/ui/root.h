@@ -5,4 +5,6 @@
 
 void zms_ui_root_schedule_repaint(struct zms_ui_root *root);
 
+void zms_ui_root_request_idle_frame(struct zms_ui_root *root);
+
 #endif  //  ZMONITORS_UI_ROOT_H